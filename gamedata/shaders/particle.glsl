@@ -5,8 +5,9 @@
 // constants
 uniform mat4 view_projection_matrix;
 uniform vec3 camera_position;
+uniform vec2 viewport_size;
 
-// attributes
+// per instance attributes
 in vec4 in_pos0; // position + size
 in vec4 in_color0;
 
@@ -27,8 +28,13 @@ void main()
     float pointScale = 1.0 - (distanceFromCamera / maxDistance);
     pointScale = clamp(pointScale, minPointScale, maxPointScale);
 
-	gl_PointSize = in_pos0.w * pointScale;
+    // billboard corner from vertex index, triangle strip order
+    vec2 corner = vec2(float(gl_VertexID & 1), float((gl_VertexID >> 1) & 1)) - 0.5;
+
+    // billboard size is in pixels, so offset is applied in clip space
+    float pointSize = in_pos0.w * pointScale;
     gl_Position = view_projection_matrix * vec4(in_pos0.xyz, 1.0);
+    gl_Position.xy += corner * (pointSize * 2.0 / viewport_size) * gl_Position.w;
 }
 
 #endif
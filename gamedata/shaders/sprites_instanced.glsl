@@ -0,0 +1,80 @@
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef VERTEX_SHADER
+
+// constants
+uniform mat4 view_projection_matrix;
+uniform int sprites_depth_axis; // 0 for y axis, 1 for z axis
+
+// per instance attributes
+in vec4 in_pos0; // position x, y, height and rotation angle in radians
+in vec2 in_pos1; // sprite size
+in vec4 in_texcoord0; // texture region u0, v0, u1, v1
+in uvec2 in_color0; // palette index and center origin flag
+
+// pass to fragment shader
+out vec2 Texcoord;
+flat out uint PaletteIndex;
+
+// entry point
+void main() 
+{
+    // quad corner from vertex index, triangle strip order
+    vec2 cornerFactor = vec2(float(gl_VertexID & 1), float((gl_VertexID >> 1) & 1));
+    vec2 corner = in_pos1 * cornerFactor;
+    if (in_color0.y > 0u)
+    {
+        corner -= in_pos1 * 0.5;
+    }
+
+    float sinAngle = sin(in_pos0.w);
+    float cosAngle = cos(in_pos0.w);
+    vec2 position = in_pos0.xy + vec2(corner.x * cosAngle - corner.y * sinAngle, corner.x * sinAngle + corner.y * cosAngle);
+
+    vec3 worldPosition = (sprites_depth_axis == 0) ? 
+        vec3(position.x, in_pos0.z, position.y) : 
+        vec3(position.x, position.y, in_pos0.z);
+
+    Texcoord = mix(in_texcoord0.xy, in_texcoord0.zw, cornerFactor);
+    PaletteIndex = in_color0.x;
+
+    gl_Position = view_projection_matrix * vec4(worldPosition, 1.0);
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef FRAGMENT_SHADER
+
+uniform usampler2D tex_0;
+uniform sampler2D tex_3; // palettes table
+
+// passed from vertex shader
+in vec2 Texcoord;
+flat in uint PaletteIndex;
+
+// result
+out vec4 FinalColor;
+
+vec4 fetchSpriteTexel(vec2 tc)
+{
+    // get color index in palette
+    float pal_color = float(texture(tex_0, tc).r);
+
+    if (pal_color < 0.5) // transparent
+        discard;
+
+    // fetch pixel color
+    vec4 texelColor = texelFetch(tex_3, ivec2(int(pal_color), int(PaletteIndex)), 0);
+    texelColor.a = 1.0;
+    return texelColor;
+}
+
+// entry point
+void main()
+{
+    vec4 texelColor = fetchSpriteTexel(Texcoord);
+    FinalColor = clamp(texelColor, 0.0, 1.0);
+}
+
+#endif
\ No newline at end of file
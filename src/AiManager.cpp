@@ -2,6 +2,7 @@
 #include "AiManager.h"
 #include "AiCharacterController.h"
 #include "Pedestrian.h"
+#include "FrameProfiler.h"
 
 AiManager gAiManager;
 
@@ -11,6 +12,7 @@ AiManager::AiManager()
 
 void AiManager::UpdateFrame()
 {
+    PROFILE_SCOPE("Ai");
     // update all character controllers
     bool hasInactiveControllers = false;
     for (size_t iController = 0, Count = mCharacterControllers.size(); iController < Count; ++iController)
@@ -4,6 +4,12 @@
 #include "AudioDevice.h"
 #include "CarnageGame.h"
 #include "cvars.h"
+#include "FrameProfiler.h"
+#include "LevelLoader.h"
+#include "TimeManager.h"
+#include "HumanPlayer.h"
+#include "Pedestrian.h"
+#include "Vehicle.h"
 
 AudioManager gAudioManager;
 
@@ -14,6 +20,7 @@ CvarEnum<eGameMusicMode> gCvarGameMusicMode("g_musicMode", eGameMusicMode_Radio,
 
 CvarInt gCvarMusicVolume("g_musicVolume", 3, "Game music volume in range 0-7", CvarFlags_Archive | CvarFlags_RequiresAppRestart);
 CvarInt gCvarSoundsVolume("g_soundsVolume", 3, "Audio effects volume in range 0-7", CvarFlags_Archive | CvarFlags_RequiresAppRestart);
+CvarInt gCvarAudioSfxMemoryBudget("a_sfxMemoryBudget", 4096, "Memory budget for loaded sound samples, in kilobytes", CvarFlags_Archive);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -25,7 +32,8 @@ bool AudioManager::Initialize()
         gConsole.LogMessage(eLogMessage_Warning, "Cannot allocate audio resources");
         return false;
     }
-    
+
+    StartPrefetchThread();
     return true;
 }
 
@@ -36,13 +44,28 @@ void AudioManager::Deinit()
 
     ReleaseActiveEmitters();
     ReleaseLevelSounds();
+    StopPrefetchThread();
 
     ShutdownAudioResources();
 }
 
 void AudioManager::UpdateFrame()
 {
+    PROFILE_SCOPE("Audio");
+    ++mUpdateFrameIndex;
+
+    UpdateListeners();
     UpdateActiveEmitters();
+    UpdateVoices();
+
+    // level sounds are not touched while level data is loading on background
+    if (!gLevelLoader.IsLoading())
+    {
+        ProcessPrefetchResults();
+        ProcessPendingSounds();
+        UpdatePrefetchHints();
+        EnforceSamplesMemoryBudget();
+    }
 
     UpdateMusic();
 }
@@ -51,6 +74,14 @@ bool AudioManager::PreloadLevelSounds()
 {
     ReleaseLevelSounds();
 
+    return LoadLevelSoundArchives();
+}
+
+bool AudioManager::LoadLevelSoundArchives()
+{
+    debug_assert(mLevelSfxSamples.empty() && mVoiceSfxSamples.empty());
+    debug_assert(mLevelSfxPending.empty() && mVoiceSfxPending.empty());
+
     gConsole.LogMessage(eLogMessage_Debug, "Loading level sounds...");
     if (!mVoiceSounds.LoadArchive("AUDIO/VOCALCOM"))
     {
@@ -65,12 +96,22 @@ bool AudioManager::PreloadLevelSounds()
 
     mLevelSfxSamples.resize(mLevelSounds.GetEntriesCount());
     mVoiceSfxSamples.resize(mVoiceSounds.GetEntriesCount());
+    mLevelSfxPending.assign(mLevelSounds.GetEntriesCount(), false);
+    mVoiceSfxPending.assign(mVoiceSounds.GetEntriesCount(), false);
 
     return true;
 }
 
 void AudioManager::ReleaseLevelSounds()
 {
+    mPendingSounds.clear();
+
+    // virtual voices must not refer samples that are going to be destroyed
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        currEmitter->StopAllSounds();
+    }
+
     // stop all sources and detach buffers
     for (AudioSource* source: mSfxAudioSources)
     {
@@ -78,21 +119,36 @@ void AudioManager::ReleaseLevelSounds()
         source->SetSampleBuffer(nullptr);
     }
 
+    // background reads must be completed before archives get closed
+    {
+        std::unique_lock<std::mutex> prefetchLock (mPrefetchMutex);
+        mPrefetchRequests.clear();
+        mPrefetchCondition.wait(prefetchLock, [this]() 
+        { 
+            return !mPrefetchBusy; 
+        });
+        mPrefetchResults.clear();
+    }
+
     mLevelSounds.FreeArchive();
     mVoiceSounds.FreeArchive();
 
     for (SfxSample* currSample: mLevelSfxSamples)
     {
-        SafeDelete(currSample);
+        DestroySample(currSample);
     }
 
     for (SfxSample* currSample: mVoiceSfxSamples)
     {
-        SafeDelete(currSample);
+        DestroySample(currSample);
     }
 
     mLevelSfxSamples.clear();
     mVoiceSfxSamples.clear();
+    mLevelSfxPending.clear();
+    mVoiceSfxPending.clear();
+    mSfxStats.mPendingPrefetchesCount = 0;
+    mCommonSoundsRequested = false;
 }
 
 void AudioManager::ShutdownAudioResources()
@@ -163,6 +219,13 @@ bool AudioManager::PrepareAudioResources()
 
 void AudioManager::StopAllSounds()
 {
+    mPendingSounds.clear();
+
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        currEmitter->StopAllSounds();
+    }
+
     for (AudioSource* currSource: mSfxAudioSources)
     {
         if (currSource->IsPlaying() || currSource->IsPaused())
@@ -174,6 +237,11 @@ void AudioManager::StopAllSounds()
 
 void AudioManager::PauseAllSounds()
 {
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        currEmitter->PauseAllSounds();
+    }
+
     for (AudioSource* currSource: mSfxAudioSources)
     {
         if (currSource->IsPlaying())
@@ -185,6 +253,11 @@ void AudioManager::PauseAllSounds()
 
 void AudioManager::ResumeAllSounds()
 {
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        currEmitter->ResumeAllSounds();
+    }
+
     for (AudioSource* currSource: mSfxAudioSources)
     {
         if (currSource->IsPaused())
@@ -196,19 +269,20 @@ void AudioManager::ResumeAllSounds()
 
 SfxSample* AudioManager::GetSound(eSfxSampleType sfxType, SfxSampleIndex sfxIndex)
 {
-    AudioSampleArchive& sampleArchive = (sfxType == eSfxSampleType_Level) ? mLevelSounds : mVoiceSounds;
+    AudioSampleArchive& sampleArchive = GetSampleArchive(sfxType);
     if ((int) sfxIndex >= sampleArchive.GetEntriesCount())
     {
         debug_assert(false);
         return nullptr;
     }
 
-    std::vector<SfxSample*>& samples = (sfxType == eSfxSampleType_Level) ? 
-        mLevelSfxSamples : 
-        mVoiceSfxSamples;
+    std::vector<SfxSample*>& samples = GetSamplesList(sfxType);
 
     if (samples[sfxIndex] == nullptr)
     {
+        // sound was not prefetched in time, so it is loaded right away
+        ++mSfxStats.mLoadStalls;
+
         AudioSampleArchive::SampleEntry archiveEntry;
         if (!sampleArchive.GetEntryData(sfxIndex, archiveEntry))
         {
@@ -216,25 +290,367 @@ SfxSample* AudioManager::GetSound(eSfxSampleType sfxType, SfxSampleIndex sfxInde
             return nullptr;
         }
         // upload audio data
-        AudioSampleBuffer* audioBuffer = gAudioDevice.CreateSampleBuffer(
-            archiveEntry.mSampleRate,
-            archiveEntry.mBitsPerSample,
-            archiveEntry.mChannelsCount,
-            archiveEntry.mDataLength,
-            archiveEntry.mData);
-        debug_assert(audioBuffer && !audioBuffer->IsBufferError());
+        samples[sfxIndex] = CreateSample(sfxType, sfxIndex, archiveEntry.mData);
 
         // free source data
         sampleArchive.FreeEntryData(sfxIndex);
+    }
+
+    if (samples[sfxIndex])
+    {
+        samples[sfxIndex]->mLastUsedFrame = mUpdateFrameIndex;
+    }
+    return samples[sfxIndex];
+}
 
-        if (audioBuffer)
+void AudioManager::PrefetchSound(eSfxSampleType sfxType, SfxSampleIndex sfxIndex, float priority)
+{
+    // there is no background thread, sounds are loaded on demand
+    if (!mPrefetchThread.joinable())
+        return;
+
+    std::vector<SfxSample*>& samples = GetSamplesList(sfxType);
+    if (sfxIndex >= samples.size())
+        return;
+
+    if (samples[sfxIndex])
+    {
+        // sound is expected to be used soon, so keep it resident
+        samples[sfxIndex]->mLastUsedFrame = mUpdateFrameIndex;
+        return;
+    }
+
+    std::vector<bool>& pending = GetPendingList(sfxType);
+    if (pending[sfxIndex])
+    {
+        // sound could be needed sooner than it was expected
+        std::lock_guard<std::mutex> prefetchLock (mPrefetchMutex);
+        for (SfxPrefetchRequest& currRequest: mPrefetchRequests)
         {
-            samples[sfxIndex] = new SfxSample(sfxType, sfxIndex, audioBuffer);
+            if (currRequest.mSfxType == sfxType && currRequest.mSfxIndex == sfxIndex)
+            {
+                currRequest.mPriority = std::max(currRequest.mPriority, priority);
+                break;
+            }
         }
+        return;
+    }
+
+    pending[sfxIndex] = true;
+    ++mSfxStats.mPendingPrefetchesCount;
+
+    SfxPrefetchRequest prefetchRequest;
+    prefetchRequest.mSfxType = sfxType;
+    prefetchRequest.mSfxIndex = sfxIndex;
+    prefetchRequest.mPriority = priority;
+    {
+        std::lock_guard<std::mutex> prefetchLock (mPrefetchMutex);
+        mPrefetchRequests.push_back(prefetchRequest);
+    }
+    mPrefetchCondition.notify_all();
+}
+
+AudioSampleArchive& AudioManager::GetSampleArchive(eSfxSampleType sfxType)
+{
+    return (sfxType == eSfxSampleType_Level) ? mLevelSounds : mVoiceSounds;
+}
+
+std::vector<SfxSample*>& AudioManager::GetSamplesList(eSfxSampleType sfxType)
+{
+    return (sfxType == eSfxSampleType_Level) ? mLevelSfxSamples : mVoiceSfxSamples;
+}
+
+std::vector<bool>& AudioManager::GetPendingList(eSfxSampleType sfxType)
+{
+    return (sfxType == eSfxSampleType_Level) ? mLevelSfxPending : mVoiceSfxPending;
+}
+
+SfxSample* AudioManager::FindResidentSound(eSfxSampleType sfxType, SfxSampleIndex sfxIndex)
+{
+    std::vector<SfxSample*>& samples = GetSamplesList(sfxType);
+    if (sfxIndex >= samples.size())
+        return nullptr;
+
+    if (samples[sfxIndex])
+    {
+        samples[sfxIndex]->mLastUsedFrame = mUpdateFrameIndex;
     }
     return samples[sfxIndex];
 }
 
+SfxSample* AudioManager::CreateSample(eSfxSampleType sfxType, SfxSampleIndex sfxIndex, const unsigned char* sampleData)
+{
+    AudioSampleArchive::SampleEntry archiveEntry;
+    if (!GetSampleArchive(sfxType).GetEntryInfo(sfxIndex, archiveEntry))
+        return nullptr;
+
+    AudioSampleBuffer* audioBuffer = gAudioDevice.CreateSampleBuffer(
+        archiveEntry.mSampleRate,
+        archiveEntry.mBitsPerSample,
+        archiveEntry.mChannelsCount,
+        archiveEntry.mDataLength,
+        sampleData);
+    debug_assert(audioBuffer && !audioBuffer->IsBufferError());
+
+    if (audioBuffer == nullptr)
+        return nullptr;
+
+    SfxSample* sfxSample = new SfxSample(sfxType, sfxIndex, audioBuffer);
+    sfxSample->mDataLength = archiveEntry.mDataLength;
+    sfxSample->mLastUsedFrame = mUpdateFrameIndex;
+
+    ++mSfxStats.mResidentSamplesCount;
+    mSfxStats.mResidentBytes += sfxSample->mDataLength;
+    return sfxSample;
+}
+
+void AudioManager::DestroySample(SfxSample* sfxSample)
+{
+    if (sfxSample == nullptr)
+        return;
+
+    // buffer cannot be deleted while attached to source
+    for (AudioSource* currSource: mSfxAudioSources)
+    {
+        if (currSource->GetSampleBuffer() == sfxSample->mSampleBuffer)
+        {
+            currSource->SetSampleBuffer(nullptr);
+        }
+    }
+
+    --mSfxStats.mResidentSamplesCount;
+    mSfxStats.mResidentBytes -= sfxSample->mDataLength;
+    delete sfxSample;
+}
+
+bool AudioManager::IsSampleInUse(SfxSample* sfxSample) const
+{
+    for (AudioSource* currSource: mSfxAudioSources)
+    {
+        if (currSource->GetSampleBuffer() != sfxSample->mSampleBuffer)
+            continue;
+
+        if (currSource->IsPlaying() || currSource->IsPaused())
+            return true;
+    }
+
+    // virtual voices will need sample once they become audible
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        for (const SfxEmitter::SfxChannel& currChannel: currEmitter->mAudioChannels)
+        {
+            if (currChannel.mIsActive && currChannel.mSfxSample == sfxSample)
+                return true;
+        }
+    }
+    return false;
+}
+
+void AudioManager::StartPrefetchThread()
+{
+#ifndef __EMSCRIPTEN__
+    debug_assert(!mPrefetchThread.joinable());
+    mPrefetchShutdown = false;
+    mPrefetchThread = std::thread(&AudioManager::PrefetchThreadProc, this);
+#endif
+}
+
+void AudioManager::StopPrefetchThread()
+{
+    if (!mPrefetchThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> prefetchLock (mPrefetchMutex);
+        mPrefetchShutdown = true;
+        mPrefetchRequests.clear();
+    }
+    mPrefetchCondition.notify_all();
+    mPrefetchThread.join();
+    mPrefetchResults.clear();
+}
+
+void AudioManager::PrefetchThreadProc()
+{
+    std::unique_lock<std::mutex> prefetchLock (mPrefetchMutex);
+    for (;;)
+    {
+        mPrefetchCondition.wait(prefetchLock, [this]() 
+        { 
+            return mPrefetchShutdown || !mPrefetchRequests.empty(); 
+        });
+
+        if (mPrefetchShutdown)
+            break;
+
+        // most important request goes first
+        auto requestIterator = std::max_element(mPrefetchRequests.begin(), mPrefetchRequests.end(), 
+            [](const SfxPrefetchRequest& lhs, const SfxPrefetchRequest& rhs)
+            {
+                return lhs.mPriority < rhs.mPriority;
+            });
+
+        SfxPrefetchResult prefetchResult;
+        prefetchResult.mSfxType = requestIterator->mSfxType;
+        prefetchResult.mSfxIndex = requestIterator->mSfxIndex;
+        mPrefetchRequests.erase(requestIterator);
+        mPrefetchBusy = true;
+
+        // archive is not released while busy flag is set
+        prefetchLock.unlock();
+        AudioSampleArchive& sampleArchive = GetSampleArchive(prefetchResult.mSfxType);
+        prefetchResult.mIsSuccess = sampleArchive.ReadEntryData(prefetchResult.mSfxIndex, prefetchResult.mSampleData);
+        prefetchLock.lock();
+
+        mPrefetchBusy = false;
+        mPrefetchResults.push_back(std::move(prefetchResult));
+        mPrefetchCondition.notify_all();
+    }
+}
+
+void AudioManager::ProcessPrefetchResults()
+{
+    std::vector<SfxPrefetchResult> prefetchResults;
+    {
+        std::lock_guard<std::mutex> prefetchLock (mPrefetchMutex);
+        if (mPrefetchResults.empty())
+            return;
+
+        // audio data upload is spread across frames
+        int resultsCount = std::min((int) mPrefetchResults.size(), MaxPrefetchUploadsPerFrame);
+        std::move(mPrefetchResults.begin(), mPrefetchResults.begin() + resultsCount, std::back_inserter(prefetchResults));
+        mPrefetchResults.erase(mPrefetchResults.begin(), mPrefetchResults.begin() + resultsCount);
+    }
+
+    for (SfxPrefetchResult& currResult: prefetchResults)
+    {
+        std::vector<SfxSample*>& samples = GetSamplesList(currResult.mSfxType);
+        std::vector<bool>& pending = GetPendingList(currResult.mSfxType);
+        debug_assert(pending[currResult.mSfxIndex]);
+        pending[currResult.mSfxIndex] = false;
+        --mSfxStats.mPendingPrefetchesCount;
+
+        // sound could be loaded on demand while request was in progress
+        if (!currResult.mIsSuccess || samples[currResult.mSfxIndex])
+            continue;
+
+        samples[currResult.mSfxIndex] = CreateSample(currResult.mSfxType, currResult.mSfxIndex, currResult.mSampleData.data());
+        if (samples[currResult.mSfxIndex])
+        {
+            ++mSfxStats.mPrefetchedCount;
+        }
+    }
+}
+
+void AudioManager::UpdatePrefetchHints()
+{
+    if (!mPrefetchThread.joinable() || mLevelSfxSamples.empty())
+        return;
+
+    // sounds that are used almost immediately on any level
+    if (!mCommonSoundsRequested)
+    {
+        static const SfxSampleIndex CommonSounds[] =
+        {
+            SfxLevel_FootStep1,
+            SfxLevel_FootStep2,
+            SfxLevel_Punch,
+            SfxLevel_CarDoorOpen,
+            SfxLevel_CarDoorClose,
+            SfxLevel_PistolShot,
+            SfxLevel_HugeExplosion,
+        };
+        for (SfxSampleIndex currSound: CommonSounds)
+        {
+            PrefetchSound(eSfxSampleType_Level, currSound, 0.0f);
+        }
+        mCommonSoundsRequested = true;
+    }
+
+    if ((mUpdateFrameIndex % PrefetchHintsFramesInterval) > 0)
+        return;
+
+    if (mListenersCount == 0)
+        return;
+
+    // emitters that are playing now will likely need their follow-up sounds, closest ones go first
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        GameObject* gameObject = currEmitter->mGameObject;
+        if (gameObject == nullptr)
+            continue;
+
+        float priority = 1.0f / (1.0f + GetListenerDistance(currEmitter->mEmitterPosition));
+
+        if (gameObject->IsVehicleClass())
+        {
+            Vehicle* car = static_cast<Vehicle*>(gameObject);
+            PrefetchSound(eSfxSampleType_Level, SfxLevel_FirstCarEngineSound + car->mCarInfo->mEngine, priority);
+            PrefetchSound(eSfxSampleType_Level, SfxLevel_CarDoorOpen, priority);
+            PrefetchSound(eSfxSampleType_Level, SfxLevel_CarDoorClose, priority);
+            continue;
+        }
+
+        if (gameObject->IsPedestrianClass())
+        {
+            Pedestrian* pedestrian = static_cast<Pedestrian*>(gameObject);
+            WeaponInfo* weaponInfo = pedestrian->mWeapons[pedestrian->mCurrentWeapon].GetWeaponInfo();
+            if (weaponInfo && weaponInfo->mShotSound >= 0)
+            {
+                PrefetchSound(eSfxSampleType_Level, weaponInfo->mShotSound, priority);
+            }
+            if (weaponInfo && weaponInfo->mProjectileHitObjectSound >= 0)
+            {
+                PrefetchSound(eSfxSampleType_Level, weaponInfo->mProjectileHitObjectSound, priority);
+            }
+            PrefetchSound(eSfxSampleType_Level, SfxLevel_Punch, priority);
+        }
+    }
+}
+
+void AudioManager::EnforceSamplesMemoryBudget()
+{
+    int budgetBytes = std::max(gCvarAudioSfxMemoryBudget.mValue, 0) * 1024;
+    if (mSfxStats.mResidentBytes <= budgetBytes)
+        return;
+
+    // samples used in current frame are kept
+    std::vector<SfxSample*> evictSamples;
+    for (SfxSample* currSample: mLevelSfxSamples)
+    {
+        if (currSample && currSample->mLastUsedFrame != mUpdateFrameIndex)
+        {
+            evictSamples.push_back(currSample);
+        }
+    }
+    for (SfxSample* currSample: mVoiceSfxSamples)
+    {
+        if (currSample && currSample->mLastUsedFrame != mUpdateFrameIndex)
+        {
+            evictSamples.push_back(currSample);
+        }
+    }
+
+    // least recently used go first
+    std::sort(evictSamples.begin(), evictSamples.end(), [](const SfxSample* lhs, const SfxSample* rhs)
+    {
+        return lhs->mLastUsedFrame < rhs->mLastUsedFrame;
+    });
+
+    for (SfxSample* currSample: evictSamples)
+    {
+        if (mSfxStats.mResidentBytes <= budgetBytes)
+            break;
+
+        if (IsSampleInUse(currSample))
+            continue;
+
+        GetSamplesList(currSample->mSfxType)[currSample->mSfxIndex] = nullptr;
+        DestroySample(currSample);
+        ++mSfxStats.mEvictions;
+    }
+}
+
 SfxEmitter* AudioManager::CreateEmitter(GameObject* gameObject, const glm::vec3& emitterPosition, SfxEmitterFlags emitterFlags)
 {
     SfxEmitter* emitter = mEmittersPool.create(gameObject, emitterFlags);
@@ -251,6 +667,8 @@ void AudioManager::DestroyEmitter(SfxEmitter* sfxEmitter)
         return;
     }
 
+    CancelPendingSounds(sfxEmitter, -1);
+
     mEmittersPool.destroy(sfxEmitter);
     cxx::erase_elements(mActiveEmitters, sfxEmitter);
 }
@@ -293,7 +711,7 @@ void AudioManager::UpdateActiveEmitters()
             currEmitter->UpdateEmitterParams(gameObjectPosition);
         }
 
-        currEmitter->UpdateSounds();
+        currEmitter->UpdateSounds(gTimeManager.mSystemFrameDelta);
         if (!currEmitter->IsActiveEmitter())
         {
             inactiveEmitters.push_back(currEmitter);
@@ -312,15 +730,49 @@ void AudioManager::UpdateActiveEmitters()
 
 bool AudioManager::StartSound(eSfxSampleType sfxType, SfxSampleIndex sfxIndex, SfxFlags sfxFlags, const glm::vec3& emitterPosition)
 {
-    SfxSample* audioSample = GetSound(sfxType, sfxIndex);
+    SfxSample* audioSample = FindResidentSound(sfxType, sfxIndex);
     if (audioSample == nullptr)
+    {
+        if (QueuePendingSound(nullptr, 0, sfxType, sfxIndex, sfxFlags, emitterPosition))
+            return true;
+
+        // load right away
+        audioSample = GetSound(sfxType, sfxIndex);
+        if (audioSample == nullptr)
+            return false;
+    }
+    return StartOneShotSound(audioSample, sfxFlags, emitterPosition);
+}
+
+bool AudioManager::StartEmitterSound(SfxEmitter* sfxEmitter, int ichannel, eSfxSampleType sfxType, SfxSampleIndex sfxIndex, SfxFlags sfxFlags)
+{
+    if (sfxEmitter == nullptr)
+    {
+        debug_assert(false);
         return false;
+    }
+
+    SfxSample* audioSample = FindResidentSound(sfxType, sfxIndex);
+    if (audioSample == nullptr)
+    {
+        if (QueuePendingSound(sfxEmitter, ichannel, sfxType, sfxIndex, sfxFlags, sfxEmitter->mEmitterPosition))
+            return true;
 
+        // load right away
+        audioSample = GetSound(sfxType, sfxIndex);
+        if (audioSample == nullptr)
+            return false;
+    }
+    return sfxEmitter->StartSound(ichannel, audioSample, sfxFlags);
+}
+
+bool AudioManager::StartOneShotSound(SfxSample* sfxSample, SfxFlags sfxFlags, const glm::vec3& emitterPosition)
+{
     SfxEmitter* autoreleaseEmitter = CreateEmitter(nullptr, emitterPosition, SfxEmitterFlags_Autorelease);
     debug_assert(autoreleaseEmitter);
     if (autoreleaseEmitter)
     {
-        if (autoreleaseEmitter->StartSound(0, audioSample, sfxFlags))
+        if (autoreleaseEmitter->StartSound(0, sfxSample, sfxFlags))
             return true;
 
         DestroyEmitter(autoreleaseEmitter);
@@ -328,6 +780,97 @@ bool AudioManager::StartSound(eSfxSampleType sfxType, SfxSampleIndex sfxIndex, S
     return false;
 }
 
+bool AudioManager::QueuePendingSound(SfxEmitter* sfxEmitter, int ichannel, eSfxSampleType sfxType, SfxSampleIndex sfxIndex, SfxFlags sfxFlags,
+    const glm::vec3& emitterPosition)
+{
+    // there is no background thread, sounds are loaded on demand
+    if (!mPrefetchThread.joinable())
+        return false;
+
+    if (sfxIndex >= GetSamplesList(sfxType).size())
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    // sample is uploaded to audio device on main thread, sound starts after that
+    ++mSfxStats.mLoadStalls;
+    PrefetchSound(sfxType, sfxIndex, PendingSoundPrefetchPriority);
+
+    // new sound replaces previous one on same channel
+    if (sfxEmitter)
+    {
+        CancelPendingSounds(sfxEmitter, ichannel);
+    }
+
+    SfxPendingSound pendingSound;
+    pendingSound.mEmitter = sfxEmitter;
+    pendingSound.mChannelIndex = ichannel;
+    pendingSound.mSfxType = sfxType;
+    pendingSound.mSfxIndex = sfxIndex;
+    pendingSound.mSfxFlags = sfxFlags;
+    pendingSound.mPosition = emitterPosition;
+    pendingSound.mRequestFrame = mUpdateFrameIndex;
+    mPendingSounds.push_back(pendingSound);
+    return true;
+}
+
+void AudioManager::ProcessPendingSounds()
+{
+    if (mPendingSounds.empty())
+        return;
+
+    std::vector<SfxPendingSound> pendingSounds;
+    pendingSounds.swap(mPendingSounds);
+
+    for (const SfxPendingSound& currSound: pendingSounds)
+    {
+        SfxSample* sfxSample = FindResidentSound(currSound.mSfxType, currSound.mSfxIndex);
+        if (sfxSample == nullptr)
+        {
+            // keep waiting while sample is loading, unless sound is too late already
+            bool isLoading = GetPendingList(currSound.mSfxType)[currSound.mSfxIndex];
+            if (isLoading && (mUpdateFrameIndex - currSound.mRequestFrame) < MaxPendingSoundFrames)
+            {
+                mPendingSounds.push_back(currSound);
+            }
+            continue;
+        }
+
+        if (currSound.mEmitter == nullptr)
+        {
+            StartOneShotSound(sfxSample, currSound.mSfxFlags, currSound.mPosition);
+            continue;
+        }
+
+        if (currSound.mEmitter->mGameObject) // sync audio params
+        {
+            currSound.mEmitter->UpdateEmitterParams(currSound.mEmitter->mGameObject->mTransform.mPosition);
+        }
+        currSound.mEmitter->StartSound(currSound.mChannelIndex, sfxSample, currSound.mSfxFlags);
+    }
+}
+
+void AudioManager::CancelPendingSounds(SfxEmitter* sfxEmitter, int ichannel)
+{
+    cxx::erase_elements_if(mPendingSounds, [sfxEmitter, ichannel](const SfxPendingSound& currSound)
+    {
+        return (currSound.mEmitter == sfxEmitter) && (ichannel == -1 || currSound.mChannelIndex == ichannel);
+    });
+}
+
+void AudioManager::DetachPendingSounds(SfxEmitter* sfxEmitter)
+{
+    for (SfxPendingSound& currSound: mPendingSounds)
+    {
+        if (currSound.mEmitter == sfxEmitter)
+        {
+            currSound.mEmitter = nullptr;
+            currSound.mPosition = sfxEmitter->mEmitterPosition;
+        }
+    }
+}
+
 float AudioManager::NextRandomPitch()
 {
     static const float _pitchValues[] = {0.95f, 1.0f, 1.1f};
@@ -350,6 +893,141 @@ void AudioManager::RegisterActiveEmitter(SfxEmitter* emitter)
     }
 }
 
+void AudioManager::UpdateListeners()
+{
+    mListenersCount = 0;
+    for (HumanPlayer* currPlayer: gCarnageGame.mHumanPlayers)
+    {
+        if (currPlayer)
+        {
+            mListenerPositions[mListenersCount++] = currPlayer->mPlayerView.mCamera.mPosition;
+        }
+    }
+}
+
+float AudioManager::GetListenerDistance(const glm::vec3& position) const
+{
+    if (mListenersCount == 0)
+        return 0.0f;
+
+    float minDistance2 = glm::distance2(mListenerPositions[0], position);
+    for (int ilistener = 1; ilistener < mListenersCount; ++ilistener)
+    {
+        minDistance2 = std::min(minDistance2, glm::distance2(mListenerPositions[ilistener], position));
+    }
+    return sqrtf(minDistance2);
+}
+
+float AudioManager::GetVoiceAudibility(const SfxEmitter* emitter, int ichannel) const
+{
+    static const float PriorityWeights[eSfxPriority_COUNT] = { 0.25f, 1.0f, 4.0f, 1000.0f };
+
+    const SfxEmitter::SfxChannel& channel = emitter->mAudioChannels[ichannel];
+    float audibility = PriorityWeights[channel.mPriority] * channel.mGainValue;
+    return audibility / (1.0f + GetListenerDistance(emitter->mEmitterPosition));
+}
+
+AudioSource* AudioManager::AcquireAudioSource(SfxEmitter* emitter, int ichannel)
+{
+    AudioSource* audioSource = GetFreeAudioSource();
+    if (audioSource)
+        return audioSource;
+
+    // find least audible voice that is currently real
+    float audibility = GetVoiceAudibility(emitter, ichannel);
+
+    SfxEmitter* victimEmitter = nullptr;
+    int victimChannel = 0;
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        for (int icurrChannel = 0, ChannelsCount = (int) currEmitter->mAudioChannels.size(); icurrChannel < ChannelsCount; ++icurrChannel)
+        {
+            const SfxEmitter::SfxChannel& currChannel = currEmitter->mAudioChannels[icurrChannel];
+            if (!currChannel.mIsActive || currChannel.mIsPaused || currChannel.mHardwareSource == nullptr)
+                continue;
+
+            float currAudibility = GetVoiceAudibility(currEmitter, icurrChannel) * RealVoiceAudibilityBonus;
+            if (currAudibility < audibility)
+            {
+                audibility = currAudibility;
+                victimEmitter = currEmitter;
+                victimChannel = icurrChannel;
+            }
+        }
+    }
+
+    if (victimEmitter == nullptr)
+        return nullptr;
+
+    audioSource = victimEmitter->mAudioChannels[victimChannel].mHardwareSource;
+    victimEmitter->DetachVoiceSource(victimChannel);
+    ++mVoicesStats.mVirtualizedCount;
+    return audioSource;
+}
+
+void AudioManager::UpdateVoices()
+{
+    mVoicesList.clear();
+    for (SfxEmitter* currEmitter: mActiveEmitters)
+    {
+        for (int ichannel = 0, ChannelsCount = (int) currEmitter->mAudioChannels.size(); ichannel < ChannelsCount; ++ichannel)
+        {
+            // paused voices keep their sources
+            const SfxEmitter::SfxChannel& currChannel = currEmitter->mAudioChannels[ichannel];
+            if (!currChannel.mIsActive || currChannel.mIsPaused)
+                continue;
+
+            SfxVoice voice;
+            voice.mEmitter = currEmitter;
+            voice.mChannelIndex = ichannel;
+            voice.mAudibility = GetVoiceAudibility(currEmitter, ichannel);
+            // prevents voices of similar audibility from swapping sources every frame
+            if (currChannel.mHardwareSource)
+            {
+                voice.mAudibility *= RealVoiceAudibilityBonus;
+            }
+            mVoicesList.push_back(voice);
+        }
+    }
+
+    std::sort(mVoicesList.begin(), mVoicesList.end(), [](const SfxVoice& lhs, const SfxVoice& rhs)
+    {
+        return lhs.mAudibility > rhs.mAudibility;
+    });
+
+    const int VoicesCount = (int) mVoicesList.size();
+    const int MaxRealVoices = std::min((int) mSfxAudioSources.size(), VoicesCount);
+
+    // release sources of less audible voices first so that louder ones can take them
+    for (int ivoice = MaxRealVoices; ivoice < VoicesCount; ++ivoice)
+    {
+        const SfxVoice& voice = mVoicesList[ivoice];
+        if (voice.mEmitter->mAudioChannels[voice.mChannelIndex].mHardwareSource)
+        {
+            voice.mEmitter->DetachVoiceSource(voice.mChannelIndex);
+            ++mVoicesStats.mVirtualizedCount;
+        }
+    }
+
+    int realVoicesCount = 0;
+    for (int ivoice = 0; ivoice < MaxRealVoices; ++ivoice)
+    {
+        const SfxVoice& voice = mVoicesList[ivoice];
+        if (voice.mEmitter->mAudioChannels[voice.mChannelIndex].mHardwareSource == nullptr)
+        {
+            AudioSource* audioSource = GetFreeAudioSource();
+            if (audioSource == nullptr)
+                continue;
+
+            voice.mEmitter->AttachVoiceSource(voice.mChannelIndex, audioSource);
+        }
+        ++realVoicesCount;
+    }
+
+    mVoicesStats.mActiveVoicesCount = VoicesCount;
+    mVoicesStats.mRealVoicesCount = realVoicesCount;
+}
+
 void AudioManager::UpdateMusic()
 {
     if ((gCvarGameMusicMode.mValue == eGameMusicMode_Disabled) || (mMusicStatus == eMusicStatus_Stopped))
@@ -5,11 +5,38 @@
 #include "SfxEmitter.h"
 #include "AudioDataStream.h"
 
+// sound samples residency statistics
+struct SfxSamplesStats
+{
+public:
+    int mResidentSamplesCount = 0; // current
+    int mResidentBytes = 0;
+    int mPendingPrefetchesCount = 0;
+    int mPrefetchedCount = 0; // since last reset
+    int mLoadStalls = 0; // sounds that were requested before their samples got loaded
+    int mEvictions = 0;
+};
+
+// sound voices statistics
+struct SfxVoicesStats
+{
+public:
+    int mActiveVoicesCount = 0; // current
+    int mRealVoicesCount = 0;
+    int mVirtualizedCount = 0; // since last reset
+};
+
 // This class manages in game music and sounds
+// Sounds of emitters are virtual voices, only most audible of them are mapped to hardware audio sources
 class AudioManager final: public cxx::noncopyable
 {
     friend class SfxEmitter;
 
+public:
+    // readonly
+    SfxSamplesStats mSfxStats;
+    SfxVoicesStats mVoicesStats;
+
 public:
     bool Initialize();
     void Deinit();
@@ -20,16 +47,33 @@ public:
     bool PreloadLevelSounds();
     void ReleaseLevelSounds();
 
+    // Load sound archives for current level without touching audio device, level sounds must be released
+    // Can be called from worker thread while level is being loaded
+    bool LoadLevelSoundArchives();
+
     // Simple play one shot sound within world
+    // If sound is not loaded yet, it gets requested with high priority and starts once uploaded on main thread
     // @param sfxType, sfxIndex: Sound identifier
     // @param emitterPosition: Sound position
     bool StartSound(eSfxSampleType sfxType, SfxSampleIndex sfxIndex, SfxFlags sfxFlags, const glm::vec3& emitterPosition);
 
+    // Play sound on emitter channel
+    // If sound is not loaded yet, it gets requested with high priority and starts once uploaded on main thread
+    // @param sfxEmitter: Emitter instance
+    // @param ichannel: Emitter channel index
+    // @param sfxType, sfxIndex: Sound identifier
+    bool StartEmitterSound(SfxEmitter* sfxEmitter, int ichannel, eSfxSampleType sfxType, SfxSampleIndex sfxIndex, SfxFlags sfxFlags);
+
     // Get game sound by its identifier, will load audio data if it is not loaded yet
     // @param sfxType: Sound type
     // @param sfxIndex: Sound index
     SfxSample* GetSound(eSfxSampleType sfxType, SfxSampleIndex sfxIndex);
 
+    // Request game sound to be loaded on background thread, does nothing if sound is loaded or already requested
+    // @param sfxType, sfxIndex: Sound identifier
+    // @param priority: Requests with higher priority are loaded first
+    void PrefetchSound(eSfxSampleType sfxType, SfxSampleIndex sfxIndex, float priority);
+
     // Allocate new sound emitter instance
     // @param gameObject: Game object which emitting sounds, optional
     SfxEmitter* CreateEmitter(GameObject* gameObject, const glm::vec3& emitterPosition, SfxEmitterFlags emitterFlags = SfxEmitterFlags_None);
@@ -52,6 +96,45 @@ private:
     void ReleaseActiveEmitters();
     void RegisterActiveEmitter(SfxEmitter* emitter);
 
+    bool StartOneShotSound(SfxSample* sfxSample, SfxFlags sfxFlags, const glm::vec3& emitterPosition);
+
+    // sounds waiting for their samples to be loaded
+    // @returns false if there is no background loading
+    bool QueuePendingSound(SfxEmitter* sfxEmitter, int ichannel, eSfxSampleType sfxType, SfxSampleIndex sfxIndex, SfxFlags sfxFlags,
+        const glm::vec3& emitterPosition);
+    void ProcessPendingSounds();
+    // @param ichannel: Emitter channel or -1 for all channels
+    void CancelPendingSounds(SfxEmitter* sfxEmitter, int ichannel);
+    // Pending sounds of emitter will be played at its current position without emitter
+    void DetachPendingSounds(SfxEmitter* sfxEmitter);
+
+    // voices management
+    void UpdateListeners();
+    void UpdateVoices();
+    float GetListenerDistance(const glm::vec3& position) const;
+    float GetVoiceAudibility(const SfxEmitter* emitter, int ichannel) const;
+
+    // Get hardware source for emitter voice, takes it from less audible voice if there are no free sources
+    // @returns null if voice is not audible enough
+    AudioSource* AcquireAudioSource(SfxEmitter* emitter, int ichannel);
+
+    // sound samples streaming
+    AudioSampleArchive& GetSampleArchive(eSfxSampleType sfxType);
+    std::vector<SfxSample*>& GetSamplesList(eSfxSampleType sfxType);
+    std::vector<bool>& GetPendingList(eSfxSampleType sfxType);
+    SfxSample* CreateSample(eSfxSampleType sfxType, SfxSampleIndex sfxIndex, const unsigned char* sampleData);
+    // Get sound if it is loaded, does not touch audio device
+    SfxSample* FindResidentSound(eSfxSampleType sfxType, SfxSampleIndex sfxIndex);
+    void DestroySample(SfxSample* sfxSample);
+
+    void StartPrefetchThread();
+    void StopPrefetchThread();
+    void PrefetchThreadProc();
+    void ProcessPrefetchResults();
+    void UpdatePrefetchHints();
+    void EnforceSamplesMemoryBudget();
+    bool IsSampleInUse(SfxSample* sfxSample) const;
+
     // generate random pitch value
     float NextRandomPitch();
 
@@ -66,6 +149,11 @@ private:
     static const int MusicSampleBufferSize = 32768;
     static const int MaxSfxAudioSources = 32;
     static const int MaxMusicSampleBuffers = 4;
+    static const int MaxPrefetchUploadsPerFrame = 4;
+    static const int PrefetchHintsFramesInterval = 15;
+    static const int MaxPendingSoundFrames = 30; // late sounds are dropped
+    static constexpr float PendingSoundPrefetchPriority = 1000.0f; // above any hint
+    static constexpr float RealVoiceAudibilityBonus = 1.1f;
 
     enum eMusicStatus
     {
@@ -74,11 +162,50 @@ private:
         eMusicStatus_NextTrackRequest,
     };
 
+    // background loading request
+    struct SfxPrefetchRequest
+    {
+        eSfxSampleType mSfxType;
+        SfxSampleIndex mSfxIndex;
+        float mPriority;
+    };
+
+    // sound start that waits for sample to be loaded
+    struct SfxPendingSound
+    {
+        SfxEmitter* mEmitter; // null for one shot sounds
+        int mChannelIndex;
+        eSfxSampleType mSfxType;
+        SfxSampleIndex mSfxIndex;
+        SfxFlags mSfxFlags;
+        glm::vec3 mPosition; // for one shot sounds
+        unsigned int mRequestFrame;
+    };
+
+    struct SfxVoice
+    {
+        SfxEmitter* mEmitter;
+        int mChannelIndex;
+        float mAudibility;
+    };
+
+    struct SfxPrefetchResult
+    {
+        eSfxSampleType mSfxType;
+        SfxSampleIndex mSfxIndex;
+        bool mIsSuccess;
+        std::vector<unsigned char> mSampleData;
+    };
+
     // audio resources
     std::vector<AudioSource*> mSfxAudioSources; // available hardware audio sources
     std::vector<SfxSample*> mLevelSfxSamples;
     std::vector<SfxSample*> mVoiceSfxSamples;
+    std::vector<bool> mLevelSfxPending; // prefetch requested but not processed yet
+    std::vector<bool> mVoiceSfxPending;
     std::vector<SfxEmitter*> mActiveEmitters;
+    std::vector<SfxVoice> mVoicesList; // sorted by audibility
+    std::vector<SfxPendingSound> mPendingSounds;
     AudioSource* mMusicAudioSource = nullptr;
     std::deque<AudioSampleBuffer*> mMusicSampleBuffers;
 
@@ -94,6 +221,21 @@ private:
     float mMusicGain = 1.0f;
     float mSoundsGain = 1.0f;
 
+    unsigned int mUpdateFrameIndex = 0;
+    bool mCommonSoundsRequested = false;
+
+    glm::vec3 mListenerPositions[GAME_MAX_PLAYERS];
+    int mListenersCount = 0;
+
+    // prefetch thread shared data, guarded by mutex
+    std::thread mPrefetchThread;
+    std::mutex mPrefetchMutex;
+    std::condition_variable mPrefetchCondition;
+    std::vector<SfxPrefetchRequest> mPrefetchRequests;
+    std::vector<SfxPrefetchResult> mPrefetchResults;
+    bool mPrefetchBusy = false;
+    bool mPrefetchShutdown = false;
+
     // object pools
     cxx::object_pool<SfxEmitter> mEmittersPool;
 };
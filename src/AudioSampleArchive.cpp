@@ -117,6 +117,8 @@ bool AudioSampleArchive::GetEntryData(int entryIndex, SampleEntry& output)
         if (currEntry.mData == nullptr) // force load audio data from raw stream
         {
             currEntry.mData = new unsigned char[currEntry.mDataLength];
+
+            std::lock_guard<std::mutex> rawDataLock (mRawDataMutex);
             mRawDataStream.seekg(currEntry.mDataOffset);
             mRawDataStream.read((char*)currEntry.mData, currEntry.mDataLength);
         }
@@ -128,6 +130,23 @@ bool AudioSampleArchive::GetEntryData(int entryIndex, SampleEntry& output)
     return false;
 }
 
+bool AudioSampleArchive::ReadEntryData(int entryIndex, std::vector<unsigned char>& outputData)
+{
+    int MaxEntriesCount = GetEntriesCount();
+    if (entryIndex < MaxEntriesCount)
+    {
+        const SampleEntry& currEntry = mAudioEntries[entryIndex];
+        outputData.resize(currEntry.mDataLength);
+
+        std::lock_guard<std::mutex> rawDataLock (mRawDataMutex);
+        mRawDataStream.clear();
+        mRawDataStream.seekg(currEntry.mDataOffset);
+        return !!mRawDataStream.read((char*) outputData.data(), currEntry.mDataLength);
+    }
+    debug_assert(false);
+    return false;
+}
+
 void AudioSampleArchive::FreeEntryData(int entryIndex)
 {
     int MaxEntriesCount = GetEntriesCount();
@@ -33,6 +33,12 @@ public:
     bool GetEntryData(int entryIndex, SampleEntry& output);
     int GetEntriesCount() const;
 
+    // Read entry data to external buffer, does not keep data in archive
+    // Thread safe while archive is loaded
+    // @param entryIndex: Entry index
+    // @param outputData: Output audio data
+    bool ReadEntryData(int entryIndex, std::vector<unsigned char>& outputData);
+
     // Unload entry data from memory
     void FreeEntryData(int entryIndex);
 
@@ -42,4 +48,5 @@ public:
 private:
     std::vector<SampleEntry> mAudioEntries;
     std::ifstream mRawDataStream;
+    std::mutex mRawDataMutex;
 };
\ No newline at end of file
@@ -130,11 +130,17 @@ bool AudioSource::SetSampleBuffer(AudioSampleBuffer* audioBuffer)
         ::alSourcei(mSourceID, AL_BUFFER, bufferID);
         alCheckError();
 
+        mSampleBuffer = audioBuffer;
         return true;
     }
     return false;
 }
 
+AudioSampleBuffer* AudioSource::GetSampleBuffer() const
+{
+    return mSampleBuffer;
+}
+
 bool AudioSource::QueueSampleBuffer(AudioSampleBuffer* audioBuffer)
 {
     if (audioBuffer == nullptr)
@@ -290,6 +296,18 @@ bool AudioSource::SetPitch(float value)
     return false;
 }
 
+bool AudioSource::SetPlaybackOffset(float seconds)
+{
+    if (::alIsSource(mSourceID))
+    {
+        ::alSourcef(mSourceID, AL_SEC_OFFSET, seconds);
+        alCheckError();
+
+        return true;
+    }
+    return false;
+}
+
 bool AudioSource::SetPosition3D(float positionx, float positiony, float positionz)
 {
     if (::alIsSource(mSourceID))
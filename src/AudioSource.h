@@ -61,6 +61,9 @@ public:
     // @param audioBuffer: New audio buffer or nullptr 
     bool SetSampleBuffer(AudioSampleBuffer* audioBuffer);
 
+    // Get currently attached sample buffer, static type only
+    AudioSampleBuffer* GetSampleBuffer() const;
+
     // Queue sample buffer, set source to streaming type
     bool QueueSampleBuffer(AudioSampleBuffer* audioBuffer);
     // Unqueue sample buffers which was already processed, works for streaming type only
@@ -76,6 +79,7 @@ public:
     // Set audio params
     bool SetGain(float value);
     bool SetPitch(float value);
+    bool SetPlaybackOffset(float seconds);
     bool SetPosition3D(float positionx, float positiony, float positionz);
     bool SetVelocity3D(float velocityx, float velocityy, float velocityz);
     // Get source current status
@@ -110,6 +114,7 @@ public:
 
 private:
     unsigned int mSourceID = 0; // openal source handle
+    AudioSampleBuffer* mSampleBuffer = nullptr; // static source buffer
 
     glm::vec3 mSourceLocation;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "BroadcastEventsManager.h"
 #include "TimeManager.h"
 #include "CarnageGame.h"
+#include "FrameProfiler.h"
 
 BroadcastEventsManager gBroadcastEvents;
 
@@ -16,6 +17,7 @@ void BroadcastEventsManager::ClearEvents()
 
 void BroadcastEventsManager::UpdateFrame()
 {
+    PROFILE_SCOPE("Broadcast events");
     float currentGameTime = gTimeManager.mGameTime;
 
     // remove obsolete events from list
@@ -16,6 +16,8 @@
 #include "cvars.h"
 #include "ParticleEffectsManager.h"
 #include "WeatherManager.h"
+#include "FrameProfiler.h"
+#include "LevelLoader.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -32,6 +34,7 @@ CvarString gCvarCurrentBaseDir("g_basedir", "", "Current gta data location", Cva
 CvarEnum<eGtaGameVersion> gCvarGameVersion("g_gamever", eGtaGameVersion_Unknown, "Current gta game version", CvarFlags_Init);
 CvarString gCvarGameLanguage("g_gamelang", "en", "Current game language", CvarFlags_Init);
 CvarInt gCvarNumPlayers("g_numplayers", 1, "Number of players in split screen mode", CvarFlags_Init);
+CvarInt gCvarGameRandSeed("g_randSeed", 0, "Game randomizer seed, 0 to seed from system clock", CvarFlags_Init);
 
 // debug
 CvarVoid gCvarDbgDumpSpriteDeltas("dbg_dumpSpriteDeltas", "Dump sprite deltas", CvarFlags_None);
@@ -50,9 +53,17 @@ bool CarnageGame::Initialize()
     debug_assert(mCurrentGamestate == nullptr);
 
     // init randomizer
-    std::chrono::milliseconds ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch());
-    mGameRand.set_seed((unsigned int) ms.count());
+    if (gCvarGameRandSeed.mValue)
+    {
+        gConsole.LogMessage(eLogMessage_Info, "Game randomizer seed: %d", gCvarGameRandSeed.mValue);
+        mGameRand.set_seed((unsigned int) gCvarGameRandSeed.mValue);
+    }
+    else
+    {
+        std::chrono::milliseconds ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch());
+        mGameRand.set_seed((unsigned int) ms.count());
+    }
 
     gGameParams.SetToDefaults();
 
@@ -122,6 +133,22 @@ bool CarnageGame::IsInGameState() const
 
 void CarnageGame::UpdateFrame()
 {
+    PROFILE_SCOPE("Game");
+    if (gLevelLoader.IsLoading())
+    {
+        gLevelLoader.UpdateFrame();
+        if (gLevelLoader.GetLoadingStage() == eLevelLoadingStage_Done)
+        {
+            EnterScenario();
+        }
+        else if (gLevelLoader.GetLoadingStage() == eLevelLoadingStage_Failed)
+        {
+            ShutdownCurrentScenario();
+            gConsole.LogMessage(eLogMessage_Error, "Fail to start game");
+            gSystem.QuitRequest();
+        }
+    }
+
     if (mCurrentGamestate)
     {
         mCurrentGamestate->OnGamestateFrame();
@@ -265,7 +292,10 @@ void CarnageGame::SetupHumanPlayer(int humanIndex, Pedestrian* pedestrian)
 
     humanPlayer->mSpawnPosition = pedestrian->mTransform.mPosition;
     humanPlayer->mPlayerView.mFollowCameraController.SetFollowTarget(pedestrian);
-    humanPlayer->mPlayerView.mHUD.SetupHUD(humanPlayer);
+    if (!gCvarSysHeadless.mValue)
+    {
+        humanPlayer->mPlayerView.mHUD.SetupHUD(humanPlayer);
+    }
 }
 
 void CarnageGame::DeleteHumanPlayer(int playerIndex)
@@ -289,6 +319,11 @@ void CarnageGame::SetupScreenLayout()
     debug_assert(playersCount > 0);
 
     Rect fullViewport = gGraphicsDevice.mViewportRect;
+    if (gCvarSysHeadless.mValue)
+    {
+        // there is no screen, but cameras still define visible area for traffic generation
+        fullViewport.Set(0, 0, gCvarGraphicsScreenDims.mValue.x, gCvarGraphicsScreenDims.mValue.y);
+    }
 
     int numRows = (playersCount + MaxCols - 1) / MaxCols;
     debug_assert(numRows > 0);
@@ -341,22 +376,24 @@ bool CarnageGame::StartScenario(const std::string& mapName)
         return false;
     }
 
-    if (!gGameMap.LoadFromFile(mapName))
-    {
-        gConsole.LogMessage(eLogMessage_Warning, "Cannot load map '%s'", mapName.c_str());
+    if (!gLevelLoader.StartLoading(mapName))
         return false;
-    }
-    if (!gAudioManager.PreloadLevelSounds())
-    {
-        // ignore
-    }
-    gSpriteManager.Cleanup();
-    gRenderManager.mMapRenderer.BuildMapMesh();
-    if (!gSpriteManager.InitLevelSprites())
+
+    if (gLevelLoader.IsLoading())
     {
-        debug_assert(false);
+        // show loading progress until level data is ready
+        SetCurrentGamestate(&mMainMenuGamestate);
+        return true;
     }
 
+    EnterScenario();
+    return true;
+}
+
+void CarnageGame::EnterScenario()
+{
+    debug_assert(gLevelLoader.GetLoadingStage() == eLevelLoadingStage_Done);
+
     gPhysics.EnterWorld();
     gParticleManager.EnterWorld();
     gGameObjectsManager.EnterWorld();
@@ -416,11 +453,11 @@ bool CarnageGame::StartScenario(const std::string& mapName)
     gWeatherManager.EnterWorld();
 
     SetCurrentGamestate(&mGameplayGamestate);
-    return true;
 }
 
 void CarnageGame::ShutdownCurrentScenario()
 {
+    gLevelLoader.CancelLoading();
     SetCurrentGamestate(nullptr);
     for (int ihuman = 0; ihuman < GAME_MAX_PLAYERS; ++ihuman)
     {
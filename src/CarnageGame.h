@@ -59,7 +59,9 @@ private:
 
     std::string GetTextsLanguageFileName(const std::string& languageID) const;
 
+    // Level data is loaded asynchronously, scenario gets entered once it is ready
     bool StartScenario(const std::string& mapName);
+    void EnterScenario();
     void ShutdownCurrentScenario();
 
     void SetCurrentGamestate(GenericGamestate* gamestate);
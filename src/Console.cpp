@@ -3,7 +3,11 @@
 #include "ConsoleVar.h"
 #include "cvars.h"
 
-static char ConsoleMessageBuffer[2048];
+CvarString gCvarSysLogFile("sys_logFile", "", "Log file path, empty to disable log file", CvarFlags_Archive | CvarFlags_Init);
+CvarInt gCvarSysLogFileMaxSize("sys_logFileMaxSize", 1024, "Log file size in kilobytes after which it gets rotated, 0 for unlimited", CvarFlags_Archive | CvarFlags_Init);
+CvarInt gCvarSysLogRateLimit("sys_logRateLimit", 50, "Max log messages per second from worker threads for each category except errors, 0 for unlimited", CvarFlags_Archive);
+
+static thread_local char ConsoleMessageBuffer[2048]; // same as log record message length
 
 #define VA_SCOPE_OPEN(firstArg, vaName) \
     { \
@@ -16,30 +20,278 @@ static char ConsoleMessageBuffer[2048];
 
 Console gConsole;
 
+inline long long GetLogTimestampMs()
+{
+    auto currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+    return currentTime.count();
+}
+
 bool Console::Initialize()
 {
+    debug_assert(!mWriterThread.joinable());
+
+    for (int irecord = 0; irecord < MaxQueuedMessages; ++irecord)
+    {
+        mLogRecords[irecord].mSequence.store(irecord, std::memory_order_relaxed);
+    }
+    mEnqueuePosition.store(0, std::memory_order_relaxed);
+    mDequeuePosition = 0;
+
+    // without writer thread messages are written synchronously by caller
+#ifndef __EMSCRIPTEN__
+    mWriterShutdown = false;
+    mWriterThread = std::thread(&Console::WriterThreadProc, this);
+    mWriterActive = true;
+#endif
     return true;
 }
 
 void Console::Deinit()
 {
+    if (mWriterThread.joinable())
+    {
+        mWriterActive = false;
+        {
+            std::lock_guard<std::mutex> writerLock (mWriterMutex);
+            mWriterShutdown = true;
+        }
+        mWriterCondition.notify_all();
+        mWriterThread.join();
+    }
+
+    std::lock_guard<std::mutex> writerLock (mWriterMutex);
+    // messages that were queued while writer was shutting down
+    WriteQueuedMessages();
+    CloseLogFile();
+}
+
+void Console::SetLogFile(const std::string& filePath, int maxFileSize)
+{
+    std::lock_guard<std::mutex> writerLock (mWriterMutex);
+    CloseLogFile();
+
+    mLogFilePath = filePath;
+    mLogFileMaxSize = std::max(maxFileSize, 0);
+    if (mLogFilePath.empty())
+        return;
+
+    // keep messages of previous sessions until rotation
+    mLogFile = std::fopen(mLogFilePath.c_str(), "a");
+    if (mLogFile == nullptr)
+    {
+        printf("Cannot open log file '%s'\n", mLogFilePath.c_str());
+        return;
+    }
+    mLogFileSize = std::ftell(mLogFile);
 }
 
 void Console::LogMessage(eLogMessage messageCat, const char* format, ...)
 {
+    if (!CheckRateLimit(messageCat))
+        return;
+
     VA_SCOPE_OPEN(format, vaList)
     vsnprintf(ConsoleMessageBuffer, sizeof(ConsoleMessageBuffer), format, vaList);
     VA_SCOPE_CLOSE(vaList)
 
+    if (!mWriterActive)
+    {
+        std::lock_guard<std::mutex> writerLock (mWriterMutex);
+        WriteMessage(messageCat, ConsoleMessageBuffer);
+        return;
+    }
+
+    if (!PushLogRecord(messageCat, ConsoleMessageBuffer))
+    {
+        ++mDroppedMessagesCount;
+        // writer is behind, don't wait for its next interval
+        mWriterCondition.notify_one();
+    }
+}
+
+void Console::ProcessPendingMessages()
+{
+    debug_assert(std::this_thread::get_id() == mMainThreadID);
+
+    mMessagesRateLimit.store(gCvarSysLogRateLimit.mValue, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mPendingLinesMutex);
+    for (ConsoleLine& currLine: mPendingLines)
+    {
+        mLines.push_back(std::move(currLine));
+    }
+    mPendingLines.clear();
+
+    // oldest lines are discarded
+    while (mLines.size() > MaxConsoleLines)
+    {
+        mLines.pop_front();
+    }
+}
+
+bool Console::PushLogRecord(eLogMessage messageCat, const char* message)
+{
+    unsigned int position = mEnqueuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        LogRecord& record = mLogRecords[position & (MaxQueuedMessages - 1)];
+        unsigned int sequence = record.mSequence.load(std::memory_order_acquire);
+        int difference = (int) (sequence - position);
+        if (difference == 0)
+        {
+            // slot is free, try to claim it
+            if (mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                record.mMessageCategory = messageCat;
+                strncpy(record.mMessage, message, MaxMessageLength - 1);
+                record.mMessage[MaxMessageLength - 1] = 0;
+                record.mSequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false; // queue is full
+        }
+        else
+        {
+            position = mEnqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool Console::CheckRateLimit(eLogMessage messageCat)
+{
+    // main thread output includes interactive console commands results, which must never be cut
+    int messagesLimit = mMessagesRateLimit.load(std::memory_order_relaxed);
+    if (messagesLimit <= 0 || messageCat == eLogMessage_Error || std::this_thread::get_id() == mMainThreadID)
+        return true;
+
+    LogRateLimit& rateLimit = mRateLimits[messageCat];
+
+    long long currentTime = GetLogTimestampMs();
+    long long intervalStart = rateLimit.mIntervalStart.load(std::memory_order_relaxed);
+    if ((currentTime - intervalStart) >= RateLimitIntervalMs && 
+        rateLimit.mIntervalStart.compare_exchange_strong(intervalStart, currentTime, std::memory_order_relaxed))
+    {
+        rateLimit.mMessagesCount = 0;
+
+        int suppressedCount = rateLimit.mSuppressedCount.exchange(0);
+        if (suppressedCount > 0)
+        {
+            char message[128];
+            snprintf(message, sizeof(message), "%d %s messages suppressed", suppressedCount, cxx::enum_to_string(messageCat));
+            ++rateLimit.mMessagesCount;
+            if (!mWriterActive)
+            {
+                std::lock_guard<std::mutex> writerLock (mWriterMutex);
+                WriteMessage(messageCat, message);
+            }
+            else if (!PushLogRecord(messageCat, message))
+            {
+                ++mDroppedMessagesCount;
+            }
+        }
+    }
+
+    if (rateLimit.mMessagesCount.fetch_add(1, std::memory_order_relaxed) < messagesLimit)
+        return true;
+
+    ++rateLimit.mSuppressedCount;
+    return false;
+}
+
+void Console::WriteQueuedMessages()
+{
+    for (;;)
+    {
+        LogRecord& record = mLogRecords[mDequeuePosition & (MaxQueuedMessages - 1)];
+        unsigned int sequence = record.mSequence.load(std::memory_order_acquire);
+        if (sequence != mDequeuePosition + 1)
+            break; // queue is empty or record is not published yet
+
+        WriteMessage(record.mMessageCategory, record.mMessage);
+        record.mSequence.store(mDequeuePosition + MaxQueuedMessages, std::memory_order_release);
+        ++mDequeuePosition;
+    }
+
+    int droppedCount = mDroppedMessagesCount.exchange(0);
+    if (droppedCount > 0)
+    {
+        char message[128];
+        snprintf(message, sizeof(message), "%d messages dropped, log queue is full", droppedCount);
+        WriteMessage(eLogMessage_Warning, message);
+    }
+
+    if (mLogFile)
+    {
+        std::fflush(mLogFile);
+    }
+}
+
+void Console::WriteMessage(eLogMessage messageCat, const char* message)
+{
     if (messageCat > eLogMessage_Debug)
     {
-        printf("%s\n", ConsoleMessageBuffer);
+        printf("%s\n", message);
     }
+
+    if (mLogFile)
+    {
+        int bytesWritten = std::fprintf(mLogFile, "[%s] %s\n", cxx::enum_to_string(messageCat), message);
+        if (bytesWritten > 0)
+        {
+            mLogFileSize += bytesWritten;
+        }
+        if (mLogFileMaxSize > 0 && mLogFileSize >= mLogFileMaxSize)
+        {
+            RotateLogFile();
+        }
+    }
+
     ConsoleLine consoleLine;
     consoleLine.mLineType = eConsoleLineType_Message;
     consoleLine.mMessageCategory = messageCat;
-    consoleLine.mString = ConsoleMessageBuffer;
-    mLines.push_back(std::move(consoleLine));
+    consoleLine.mString = message;
+
+    std::lock_guard<std::mutex> lock(mPendingLinesMutex);
+    mPendingLines.push_back(std::move(consoleLine));
+}
+
+void Console::RotateLogFile()
+{
+    CloseLogFile();
+
+    // single previous file is kept
+    std::string prevFilePath = mLogFilePath + ".1";
+    std::remove(prevFilePath.c_str());
+    std::rename(mLogFilePath.c_str(), prevFilePath.c_str());
+
+    mLogFile = std::fopen(mLogFilePath.c_str(), "w");
+    mLogFileSize = 0;
+}
+
+void Console::CloseLogFile()
+{
+    if (mLogFile)
+    {
+        std::fclose(mLogFile);
+        mLogFile = nullptr;
+    }
+    mLogFileSize = 0;
+}
+
+void Console::WriterThreadProc()
+{
+    std::unique_lock<std::mutex> writerLock (mWriterMutex);
+    for (;;)
+    {
+        WriteQueuedMessages();
+        if (mWriterShutdown)
+            break;
+
+        mWriterCondition.wait_for(writerLock, std::chrono::milliseconds(WriterIntervalMs));
+    }
 }
 
 void Console::Flush()
@@ -6,6 +6,8 @@
 class Cvar;
 
 // represents console system that handles debug commands
+// Log messages are passed through bounded lock-free queue to background writer thread,
+// which prints them to stdout and log file, so logging never blocks caller
 class Console final: public cxx::noncopyable
 {
 public:
@@ -19,9 +21,18 @@ public:
     void Deinit();
     void RegisterGlobalVariables();
 
-    // Write text message in console
+    // Start writing log messages to file, current file is rotated once it exceeds size limit
+    // @param filePath: Log file path, empty string to disable file output
+    // @param maxFileSize: Max log file size in bytes, 0 for unlimited
+    void SetLogFile(const std::string& filePath, int maxFileSize);
+
+    // Write text message in console, can be called from any thread
+    // Message gets dropped if log queue is full or, when called from worker thread, category exceeds its rate limit
     void LogMessage(eLogMessage messageCat, const char* format, ...);
 
+    // Move written messages to console lines, main thread only
+    void ProcessPendingMessages();
+
     // Clear all console text messages
     void Flush();
 
@@ -33,6 +44,63 @@ public:
     // @returns false on error
     bool RegisterVariable(Cvar* consoleVariable);
     bool UnregisterVariable(Cvar* consoleVariable);
+
+private:
+    static const int MaxQueuedMessages = 512; // must be power of two
+    static const int MaxMessageLength = 2048;
+    static const int MaxConsoleLines = 4096;
+    static const int RateLimitIntervalMs = 1000;
+    static const int WriterIntervalMs = 10;
+
+    // slot of bounded multi-producer single-consumer queue
+    struct LogRecord
+    {
+        std::atomic<unsigned int> mSequence;
+        eLogMessage mMessageCategory;
+        char mMessage[MaxMessageLength];
+    };
+
+    // messages rate limiting state of single category
+    struct LogRateLimit
+    {
+        std::atomic<long long> mIntervalStart {0}; // ms
+        std::atomic<int> mMessagesCount {0};
+        std::atomic<int> mSuppressedCount {0};
+    };
+
+    bool PushLogRecord(eLogMessage messageCat, const char* message);
+    bool CheckRateLimit(eLogMessage messageCat);
+
+    // writer side, called with writer mutex locked
+    void WriteQueuedMessages();
+    void WriteMessage(eLogMessage messageCat, const char* message);
+    void RotateLogFile();
+    void CloseLogFile();
+
+    void WriterThreadProc();
+
+private:
+    std::thread::id mMainThreadID = std::this_thread::get_id();
+    std::mutex mPendingLinesMutex;
+    std::vector<ConsoleLine> mPendingLines;
+
+    LogRecord mLogRecords[MaxQueuedMessages];
+    std::atomic<unsigned int> mEnqueuePosition {0};
+    unsigned int mDequeuePosition = 0; // writer only
+    std::atomic<int> mDroppedMessagesCount {0};
+    std::atomic<int> mMessagesRateLimit {0};
+    LogRateLimit mRateLimits[eLogMessage_COUNT];
+
+    // writer thread shared data, guarded by mutex
+    std::thread mWriterThread;
+    std::atomic<bool> mWriterActive {false};
+    std::mutex mWriterMutex;
+    std::condition_variable mWriterCondition;
+    bool mWriterShutdown = false;
+    std::FILE* mLogFile = nullptr;
+    std::string mLogFilePath;
+    long mLogFileSize = 0;
+    long mLogFileMaxSize = 0;
 };
 
 extern Console gConsole;
\ No newline at end of file
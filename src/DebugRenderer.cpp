@@ -56,27 +56,12 @@ bool DebugRenderer::Initialize()
     mDebugLinesCount = 0;
     mDebugLinesDepthTestCount = 0;
     mDebugVerticesCount = 0;
-
-    int BufferSizeBytes = MaxDebugVertices * Sizeof_Vertex3D_Debug;
-    mGpuVerticesBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices, eBufferUsage_Stream, BufferSizeBytes, nullptr);
-    debug_assert(mGpuVerticesBuffer);
-
-    if (mGpuVerticesBuffer == nullptr)
-    {
-        Deinit();
-        return false;
-    }
-
     return true;
 }
 
 void DebugRenderer::Deinit()
 {
-    if (mGpuVerticesBuffer)
-    {
-        gGraphicsDevice.DestroyBuffer(mGpuVerticesBuffer);
-        mGpuVerticesBuffer = nullptr;
-    }
+    mTrimeshBuffer.Deinit();
 }
 
 void DebugRenderer::RenderFrameBegin(RenderView* renderview)
@@ -383,23 +368,9 @@ void DebugRenderer::FlushDebugVertices(bool depth_test)
     gGraphicsDevice.SetRenderStates(renderStates);
 
     // upload data
-    debug_assert(mGpuVerticesBuffer);
-    gGraphicsDevice.BindIndexBuffer(nullptr);
-    gGraphicsDevice.BindVertexBuffer(mGpuVerticesBuffer, Vertex3D_Debug_Format::Get());
-
     int vertexDataSizeBytes = mDebugVerticesCount * Sizeof_Vertex3D_Debug;
-    if (void* bufferData = mGpuVerticesBuffer->Lock(BufferAccess_Write | BufferAccess_InvalidateBuffer))
-    {
-        ::memcpy(bufferData, mDebugVertices, vertexDataSizeBytes);
-        if (!mGpuVerticesBuffer->Unlock())
-        {
-            debug_assert(false);
-        }
-    }
-    else
-    {
-        debug_assert(false);
-    }
+    mTrimeshBuffer.SetVertices(vertexDataSizeBytes, mDebugVertices);
+    mTrimeshBuffer.Bind(Vertex3D_Debug_Format::Get(), nullptr);
 
     // issue draw call
     gGraphicsDevice.RenderPrimitives(ePrimitiveType_Lines, 0, mDebugVerticesCount);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GraphicsDefs.h"
+#include "TrimeshBuffer.h"
 
 class RenderView;
 
@@ -77,6 +78,6 @@ private:
     DebugLineStruct mDebugLinesArray[MaxDebugLines];
     Vertex3D_Debug mDebugVertices[MaxDebugVertices];
 
-    GpuBuffer* mGpuVerticesBuffer = nullptr;
+    TrimeshBuffer mTrimeshBuffer;
     RenderView* mCurrentRenderView = nullptr;
 };
@@ -79,7 +79,7 @@ void Explosion::HandleSpawn()
     // broadcast event
     gBroadcastEvents.RegisterEvent(eBroadcastEvent_Explosion, mTransform.GetPosition2(), gGameParams.mBroadcastExplosionEventDuration);
 
-    StartGameObjectSound(0, eSfxSampleType_Level, SfxLevel_HugeExplosion, SfxFlags_RandomPitch);
+    StartGameObjectSound(0, eSfxSampleType_Level, SfxLevel_HugeExplosion, SfxFlags_RandomPitch | SfxFlags_HighPriority);
 }
 
 void Explosion::DamagePedsNearby(bool enableInstantKill)
@@ -2,6 +2,12 @@
 #include "FileSystem.h"
 #include "cvars.h"
 
+#if OS_NAME == OS_LINUX && !defined(__EMSCRIPTEN__)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 
 static const char* GTA1MapFileExtension = ".CMP";
@@ -15,6 +21,128 @@ CvarString gCvarGtaDataPath("g_gtadata", "", "GTA data location", CvarFlags_Arch
 
 FileSystem gFiles;
 
+//////////////////////////////////////////////////////////////////////////
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& filePath)
+{
+    Close();
+
+#if OS_NAME == OS_WINDOWS
+    mFileHandle = ::CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mFileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(mFileHandle, &fileSize) || fileSize.HighPart != 0)
+    {
+        Close();
+        return false;
+    }
+
+    mDataLength = fileSize.LowPart;
+    if (mDataLength == 0)
+        return true;
+
+    mMappingHandle = ::CreateFileMappingA(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mMappingHandle)
+    {
+        mData = static_cast<const unsigned char*>(::MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (mData == nullptr)
+    {
+        Close();
+        return false;
+    }
+    return true;
+
+#elif OS_NAME == OS_LINUX && !defined(__EMSCRIPTEN__)
+    int fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+    if (fileDescriptor == -1)
+        return false;
+
+    struct stat fileStat;
+    if (::fstat(fileDescriptor, &fileStat) == -1)
+    {
+        ::close(fileDescriptor);
+        return false;
+    }
+
+    mDataLength = (unsigned int) fileStat.st_size;
+    if (mDataLength > 0)
+    {
+        // mapping stays valid after descriptor is closed
+        void* mappedData = ::mmap(nullptr, mDataLength, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (mappedData != MAP_FAILED)
+        {
+            mData = static_cast<const unsigned char*>(mappedData);
+            mIsMapped = true;
+        }
+    }
+    ::close(fileDescriptor);
+
+    if (mDataLength > 0 && !mIsMapped)
+    {
+        Close();
+        return false;
+    }
+    return true;
+
+#else
+    std::ifstream fileStream;
+    fileStream.open(filePath, std::ios::in | std::ios::binary);
+    if (!fileStream.is_open())
+        return false;
+
+    fileStream.seekg(0, std::ios::end);
+    mFallbackData.resize((size_t) fileStream.tellg());
+    fileStream.seekg(0);
+    if (!fileStream.read((char*) mFallbackData.data(), mFallbackData.size()))
+    {
+        Close();
+        return false;
+    }
+    mData = mFallbackData.data();
+    mDataLength = (unsigned int) mFallbackData.size();
+    return true;
+#endif
+}
+
+void MappedFile::Close()
+{
+#if OS_NAME == OS_WINDOWS
+    if (mData)
+    {
+        ::UnmapViewOfFile(mData);
+    }
+    if (mMappingHandle)
+    {
+        ::CloseHandle(mMappingHandle);
+        mMappingHandle = nullptr;
+    }
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+    {
+        ::CloseHandle(mFileHandle);
+        mFileHandle = INVALID_HANDLE_VALUE;
+    }
+#elif OS_NAME == OS_LINUX && !defined(__EMSCRIPTEN__)
+    if (mIsMapped)
+    {
+        ::munmap(const_cast<unsigned char*>(mData), mDataLength);
+        mIsMapped = false;
+    }
+#endif
+    mFallbackData.clear();
+    mData = nullptr;
+    mDataLength = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 bool FileSystem::Initialize()
 {
     mExecutablePath = cxx::get_executable_path();
@@ -201,6 +329,17 @@ void FileSystem::AddSearchPlace(const std::string& searchPlace)
     mSearchPlaces.emplace_back(searchPlace);
 }
 
+bool FileSystem::OpenMappedFile(const std::string& objectName, MappedFile& mappedFile)
+{
+    mappedFile.Close();
+
+    std::string fullPath;
+    if (!GetFullPathToFile(objectName, fullPath))
+        return false;
+
+    return mappedFile.Open(fullPath);
+}
+
 bool FileSystem::GetFullPathToFile(const std::string& objectName, std::string& fullPath) const
 {
     if (cxx::is_file_exists(objectName))
@@ -1,5 +1,32 @@
 #pragma once
 
+// read only memory mapping of whole file
+class MappedFile final: public cxx::noncopyable
+{
+public:
+    // readonly
+    const unsigned char* mData = nullptr;
+    unsigned int mDataLength = 0;
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // Map file into memory, previously mapped file gets closed
+    // @param filePath: Full path to file
+    bool Open(const std::string& filePath);
+    void Close();
+
+private:
+#if OS_NAME == OS_WINDOWS
+    HANDLE mFileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mMappingHandle = nullptr;
+#elif OS_NAME == OS_LINUX && !defined(__EMSCRIPTEN__)
+    bool mIsMapped = false;
+#endif
+    std::vector<unsigned char> mFallbackData; // when memory mapping is not supported
+};
+
 // file system manager
 class FileSystem final: public cxx::noncopyable
 {
@@ -42,6 +69,11 @@ public:
 
     // Load whole binary file content to std vector
     bool ReadBinaryFile(const std::string& objectName, std::vector<unsigned char>& output);
+
+    // Map whole binary file into memory for reading without intermediate copies
+    // @param objectName: File name
+    // @param mappedFile: Output mapping
+    bool OpenMappedFile(const std::string& objectName, MappedFile& mappedFile);
     
     // Load or save json config document
     bool ReadConfig(const std::string& filePath, cxx::json_document& configDocument);
@@ -0,0 +1,222 @@
+#include "stdafx.h"
+#include "FrameProfiler.h"
+
+FrameProfiler gFrameProfiler;
+
+// scopes recorded by single thread within frame
+struct ProfilerThreadScopes
+{
+public:
+    ~ProfilerThreadScopes()
+    {
+        if (mThreadIndex == -1)
+            return;
+
+        std::lock_guard<std::mutex> threadsLock (gFrameProfiler.mThreadsMutex);
+        cxx::erase_elements(gFrameProfiler.mThreadsScopes, this);
+        // keep scopes of exited thread until frame ends
+        if (mFrameIndex != -1 && mFrameIndex == gFrameProfiler.mRecordingFrameIndex)
+        {
+            gFrameProfiler.mExitedThreadsScopes.insert(gFrameProfiler.mExitedThreadsScopes.end(), mScopes.begin(), mScopes.end());
+        }
+    }
+
+public:
+    int mThreadIndex = -1; // not registered yet
+    int mFrameIndex = -1;
+    std::vector<FrameProfiler::ScopeSample> mScopes; // start times are since profiler start
+    std::vector<int> mScopesStack; // indices of currently open scopes
+
+    // contended only while frame merges buffered scopes
+    std::mutex mScopesMutex;
+};
+
+static thread_local ProfilerThreadScopes ThreadScopes;
+
+FrameProfiler::FrameProfiler()
+    : mProfilerStartTime(std::chrono::high_resolution_clock::now())
+    , mMainThreadID(std::this_thread::get_id())
+    , mFrames(MaxFramesHistory)
+    , mRecordingFrameIndex(-1)
+{
+}
+
+void FrameProfiler::BeginFrame()
+{
+    debug_assert(mCurrentFrame == nullptr);
+    if (!mIsEnabled)
+        return;
+
+    mCurrentFrame = &mFrames[mFramesCursor];
+    mCurrentFrame->mScopes.clear();
+    mCurrentFrame->mFrameIndex = mFrameIndex++;
+    mCurrentFrame->mStartTime = GetProfilerTime();
+    mCurrentFrame->mDuration = 0.0;
+    mCurrentFrame->mThreadsCount = 1;
+
+    mRecordingFrameIndex = mCurrentFrame->mFrameIndex;
+}
+
+void FrameProfiler::EndFrame()
+{
+    if (mCurrentFrame == nullptr)
+        return;
+
+    // close scopes left open
+    ProfilerThreadScopes& threadScopes = GetThreadScopes();
+    debug_assert(threadScopes.mFrameIndex != mCurrentFrame->mFrameIndex || threadScopes.mScopesStack.empty());
+    while (threadScopes.mFrameIndex == mCurrentFrame->mFrameIndex && !threadScopes.mScopesStack.empty())
+    {
+        LeaveScope();
+    }
+
+    mRecordingFrameIndex = -1;
+    MergeThreadScopes();
+
+    mCurrentFrame->mDuration = GetProfilerTime() - mCurrentFrame->mStartTime;
+    mCurrentFrame = nullptr;
+
+    mFramesCursor = (mFramesCursor + 1) % MaxFramesHistory;
+    mFramesCount = std::min(mFramesCount + 1, (int) MaxFramesHistory);
+}
+
+void FrameProfiler::EnterScope(const char* scopeName)
+{
+    int frameIndex = mRecordingFrameIndex;
+    if (frameIndex == -1)
+        return;
+
+    ProfilerThreadScopes& threadScopes = GetThreadScopes();
+
+    std::lock_guard<std::mutex> scopesLock (threadScopes.mScopesMutex);
+    if (threadScopes.mFrameIndex != frameIndex)
+    {
+        threadScopes.mFrameIndex = frameIndex;
+        threadScopes.mScopes.clear();
+        threadScopes.mScopesStack.clear();
+    }
+
+    ScopeSample scopeSample;
+    scopeSample.mName = scopeName;
+    scopeSample.mThreadIndex = threadScopes.mThreadIndex;
+    scopeSample.mDepth = (int) threadScopes.mScopesStack.size();
+    scopeSample.mStartTime = GetProfilerTime();
+    scopeSample.mDuration = 0.0;
+
+    threadScopes.mScopesStack.push_back((int) threadScopes.mScopes.size());
+    threadScopes.mScopes.push_back(scopeSample);
+}
+
+void FrameProfiler::LeaveScope()
+{
+    ProfilerThreadScopes& threadScopes = ThreadScopes;
+
+    std::lock_guard<std::mutex> scopesLock (threadScopes.mScopesMutex);
+    // frame could be started or merged while scope was open
+    if (threadScopes.mFrameIndex != mRecordingFrameIndex || threadScopes.mScopesStack.empty())
+        return;
+
+    ScopeSample& scopeSample = threadScopes.mScopes[threadScopes.mScopesStack.back()];
+    scopeSample.mDuration = GetProfilerTime() - scopeSample.mStartTime;
+    threadScopes.mScopesStack.pop_back();
+}
+
+ProfilerThreadScopes& FrameProfiler::GetThreadScopes()
+{
+    ProfilerThreadScopes& threadScopes = ThreadScopes;
+    if (threadScopes.mThreadIndex == -1)
+    {
+        std::lock_guard<std::mutex> threadsLock (mThreadsMutex);
+        threadScopes.mThreadIndex = (std::this_thread::get_id() == mMainThreadID) ? 0 : mThreadsCount++;
+        mThreadsScopes.push_back(&threadScopes);
+    }
+    return threadScopes;
+}
+
+void FrameProfiler::MergeThreadScopes()
+{
+    std::lock_guard<std::mutex> threadsLock (mThreadsMutex);
+    for (ProfilerThreadScopes* threadScopes: mThreadsScopes)
+    {
+        std::lock_guard<std::mutex> scopesLock (threadScopes->mScopesMutex);
+        // scopes still open on worker threads are kept with zero duration
+        if (threadScopes->mFrameIndex == mCurrentFrame->mFrameIndex)
+        {
+            AppendFrameScopes(threadScopes->mScopes);
+        }
+        threadScopes->mFrameIndex = -1;
+        threadScopes->mScopes.clear();
+        threadScopes->mScopesStack.clear();
+    }
+    AppendFrameScopes(mExitedThreadsScopes);
+    mExitedThreadsScopes.clear();
+}
+
+void FrameProfiler::AppendFrameScopes(const std::vector<ScopeSample>& scopes)
+{
+    for (ScopeSample scopeSample: scopes)
+    {
+        scopeSample.mStartTime -= mCurrentFrame->mStartTime;
+        mCurrentFrame->mScopes.push_back(scopeSample);
+        mCurrentFrame->mThreadsCount = std::max(mCurrentFrame->mThreadsCount, scopeSample.mThreadIndex + 1);
+    }
+}
+
+const FrameProfiler::FrameSample* FrameProfiler::GetFrame(int frameOffset) const
+{
+    if (frameOffset < 0 || frameOffset >= mFramesCount)
+        return nullptr;
+
+    int frameIndex = (mFramesCursor - 1 - frameOffset + MaxFramesHistory) % MaxFramesHistory;
+    return &mFrames[frameIndex];
+}
+
+int FrameProfiler::GetFramesCount() const
+{
+    return mFramesCount;
+}
+
+bool FrameProfiler::DumpChromeTrace(const std::string& filePath) const
+{
+    std::ofstream outputFile;
+    if (!gFiles.CreateTextFile(filePath, outputFile))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot write profiler trace file '%s'", filePath.c_str());
+        return false;
+    }
+
+    // trace events are written directly, there may be tens of thousands of them
+    outputFile << "{\"traceEvents\":[";
+    bool firstEvent = true;
+    auto WriteEvent = [&outputFile, &firstEvent](const char* eventName, int threadIndex, double startTime, double duration)
+    {
+        if (!firstEvent)
+        {
+            outputFile << ",";
+        }
+        firstEvent = false;
+        // timestamps are in microseconds
+        outputFile << "\n{\"name\":\"" << eventName << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (threadIndex + 1) << ",\"ts\":"
+            << (startTime * 1000.0) << ",\"dur\":" << (duration * 1000.0) << "}";
+    };
+
+    outputFile << std::fixed;
+    outputFile.precision(3);
+    for (int iframe = mFramesCount - 1; iframe >= 0; --iframe)
+    {
+        const FrameSample* frameSample = GetFrame(iframe);
+        WriteEvent("Frame", 0, frameSample->mStartTime, frameSample->mDuration);
+        for (const ScopeSample& currScope: frameSample->mScopes)
+        {
+            WriteEvent(currScope.mName, currScope.mThreadIndex, frameSample->mStartTime + currScope.mStartTime, currScope.mDuration);
+        }
+    }
+    outputFile << "\n]}\n";
+    return true;
+}
+
+double FrameProfiler::GetProfilerTime() const
+{
+    std::chrono::duration<double, std::milli> currentTime = std::chrono::high_resolution_clock::now() - mProfilerStartTime;
+    return currentTime.count();
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#pragma once
+
+// forwards
+struct ProfilerThreadScopes;
+
+// Lightweight hierarchical cpu profiler, collects nested scopes timings of recent frames
+// Scopes are recorded on any thread, each thread has its own scopes nesting
+// Threads buffer their scopes locally, buffers get merged into frame when it ends
+class FrameProfiler final: public cxx::noncopyable
+{
+    friend struct ProfilerThreadScopes;
+
+public:
+    static const int MaxFramesHistory = 300;
+
+    // single timed scope within frame
+    struct ScopeSample
+    {
+    public:
+        const char* mName; // must be statically allocated
+        int mThreadIndex; // 0 is main thread
+        int mDepth; // within thread
+        double mStartTime; // milliseconds since frame start
+        double mDuration; // milliseconds
+    };
+
+    struct FrameSample
+    {
+    public:
+        int mFrameIndex = 0;
+        double mStartTime = 0.0; // milliseconds since profiler start
+        double mDuration = 0.0; // milliseconds
+        int mThreadsCount = 1; // threads that had scopes within frame
+        std::vector<ScopeSample> mScopes;
+    };
+
+    bool mIsEnabled = true;
+
+public:
+    FrameProfiler();
+
+    void BeginFrame();
+    void EndFrame();
+
+    // Open or close nested timing scope, unbalanced calls are not allowed
+    // Can be called from any thread, scopes on worker threads must be closed before frame ends
+    // @param scopeName: Scope name, must be statically allocated
+    void EnterScope(const char* scopeName);
+    void LeaveScope();
+
+    // Get recorded frame
+    // @param frameOffset: 0 is most recent completed frame, 1 is previous one and so on
+    const FrameSample* GetFrame(int frameOffset) const;
+    int GetFramesCount() const;
+
+    // Save recorded frames in chrome trace event format, can be opened in chrome://tracing
+    // @param filePath: Output file path
+    bool DumpChromeTrace(const std::string& filePath) const;
+
+private:
+    double GetProfilerTime() const;
+
+    // get scopes buffer of calling thread, registers it on first use
+    ProfilerThreadScopes& GetThreadScopes();
+
+    // move scopes buffered by threads into current frame
+    void MergeThreadScopes();
+    void AppendFrameScopes(const std::vector<ScopeSample>& scopes);
+
+private:
+    std::chrono::high_resolution_clock::time_point mProfilerStartTime;
+    std::thread::id mMainThreadID;
+
+    std::vector<FrameSample> mFrames; // ring buffer
+    int mFramesCursor = 0;
+    int mFramesCount = 0;
+    int mFrameIndex = 0;
+    FrameSample* mCurrentFrame = nullptr;
+    int mThreadsCount = 1; // threads seen so far, main thread included
+
+    // index of frame being recorded, -1 if none
+    std::atomic<int> mRecordingFrameIndex;
+
+    // guards registered threads list, scopes recording does not touch it
+    std::mutex mThreadsMutex;
+    std::vector<ProfilerThreadScopes*> mThreadsScopes;
+    std::vector<ScopeSample> mExitedThreadsScopes; // scopes of threads exited within current frame
+};
+
+extern FrameProfiler gFrameProfiler;
+
+// Profiler scope helper
+class FrameProfilerScope final: public cxx::noncopyable
+{
+public:
+    FrameProfilerScope(const char* scopeName)
+    {
+        gFrameProfiler.EnterScope(scopeName);
+    }
+    ~FrameProfilerScope()
+    {
+        gFrameProfiler.LeaveScope();
+    }
+};
+
+#define PROFILE_SCOPE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(scopeName) FrameProfilerScope PROFILE_SCOPE_CONCAT(profilerScope, __LINE__)(scopeName)
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "stdafx.h"
+#include "FrameProfilerWindow.h"
+#include "FrameProfiler.h"
+#include "imgui.h"
+#include "ImGuiHelpers.h"
+#include "cvars.h"
+
+FrameProfilerWindow gFrameProfilerWindow;
+
+FrameProfilerWindow::FrameProfilerWindow()
+    : DebugWindow("Frame Profiler")
+{
+}
+
+void FrameProfilerWindow::DoUI(ImGuiIO& imguiContext)
+{
+    ImGuiWindowFlags wndFlags = ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+
+    ImGui::SetNextWindowSize(ImVec2(640.0f, 320.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin(mWindowName, &mWindowShown, wndFlags))
+    {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Checkbox("Record", &gFrameProfiler.mIsEnabled);
+    ImGui::SameLine();
+    ImGui::Checkbox("Follow last frame", &mFollowLastFrame);
+    ImGui::SameLine();
+    if (ImGui::Button("Dump trace"))
+    {
+        gCvarDbgDumpProfilerTrace.SetModified();
+    }
+
+    if (gFrameProfiler.GetFramesCount() > 0)
+    {
+        if (mFollowLastFrame)
+        {
+            mSelectedFrameOffset = 0;
+        }
+        mSelectedFrameOffset = glm::clamp(mSelectedFrameOffset, 0, gFrameProfiler.GetFramesCount() - 1);
+
+        DoFramesHistogram();
+        DoFlameView();
+    }
+    ImGui::End();
+}
+
+void FrameProfilerWindow::DoFramesHistogram()
+{
+    int framesCount = gFrameProfiler.GetFramesCount();
+
+    // oldest frame goes first
+    auto GetFrameTime = [](void* data, int index) -> float
+    {
+        int framesCount = gFrameProfiler.GetFramesCount();
+        const FrameProfiler::FrameSample* frameSample = gFrameProfiler.GetFrame(framesCount - 1 - index);
+        return frameSample ? (float) frameSample->mDuration : 0.0f;
+    };
+
+    const FrameProfiler::FrameSample* selectedFrame = gFrameProfiler.GetFrame(mSelectedFrameOffset);
+    debug_assert(selectedFrame);
+
+    std::string overlayText = cxx::va("frame %d: %.3f ms", selectedFrame->mFrameIndex, selectedFrame->mDuration);
+
+    float graphWidth = ImGui::GetContentRegionAvail().x;
+    ImGui::PlotHistogram("##frames", GetFrameTime, nullptr, framesCount, 0, overlayText.c_str(), 0.0f, 33.3f, ImVec2(graphWidth, 60.0f));
+
+    // pick frame
+    if (ImGui::IsItemHovered() && ImGui::IsMouseDown(0))
+    {
+        ImVec2 graphMin = ImGui::GetItemRectMin();
+        ImVec2 graphSize = ImGui::GetItemRectSize();
+        float cursorPosition = (ImGui::GetIO().MousePos.x - graphMin.x) / graphSize.x;
+        int frameIndex = glm::clamp((int) (cursorPosition * framesCount), 0, framesCount - 1);
+        mSelectedFrameOffset = framesCount - 1 - frameIndex;
+        mFollowLastFrame = false;
+    }
+}
+
+void FrameProfilerWindow::DoFlameView()
+{
+    const FrameProfiler::FrameSample* frameSample = gFrameProfiler.GetFrame(mSelectedFrameOffset);
+    debug_assert(frameSample);
+
+    const float RowHeight = ImGui::GetTextLineHeightWithSpacing();
+
+    ImGui::BeginChild("FlameView", ImVec2(0.0f, 0.0f), true, ImGuiWindowFlags_HorizontalScrollbar);
+
+    // each thread gets its own lane of rows, main thread goes first
+    std::vector<int> laneRows (frameSample->mThreadsCount, 0);
+    for (const FrameProfiler::ScopeSample& currScope: frameSample->mScopes)
+    {
+        laneRows[currScope.mThreadIndex] = std::max(laneRows[currScope.mThreadIndex], currScope.mDepth + 1);
+    }
+
+    std::vector<int> laneFirstRow (frameSample->mThreadsCount, 0);
+    int rowsCount = 0;
+    for (int ithread = 0; ithread < frameSample->mThreadsCount; ++ithread)
+    {
+        laneFirstRow[ithread] = rowsCount;
+        rowsCount += laneRows[ithread];
+    }
+
+    ImVec2 canvasPosition = ImGui::GetCursorScreenPos();
+    ImVec2 canvasSize (ImGui::GetContentRegionAvail().x, std::max(rowsCount, 1) * RowHeight);
+    ImGui::InvisibleButton("##flame", ImVec2(std::max(canvasSize.x, 1.0f), std::max(canvasSize.y, 1.0f)));
+
+    bool isCanvasHovered = ImGui::IsItemHovered();
+    ImVec2 mousePosition = ImGui::GetIO().MousePos;
+
+    float frameDuration = std::max((float) frameSample->mDuration, 0.001f);
+    float pixelsPerMs = canvasSize.x / frameDuration;
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    for (const FrameProfiler::ScopeSample& currScope: frameSample->mScopes)
+    {
+        ImVec2 rectMin (canvasPosition.x + (float) currScope.mStartTime * pixelsPerMs,
+            canvasPosition.y + (laneFirstRow[currScope.mThreadIndex] + currScope.mDepth) * RowHeight);
+        ImVec2 rectMax (rectMin.x + std::max((float) currScope.mDuration * pixelsPerMs, 1.0f),
+            rectMin.y + RowHeight - 1.0f);
+
+        // scope names are statically allocated, so color stays same between frames
+        unsigned int nameHash = (unsigned int) std::hash<const void*>()(currScope.mName) * 2654435761U;
+        ImU32 scopeColor = IM_COL32(96 + (nameHash & 0x7F), 96 + ((nameHash >> 8) & 0x7F), 96 + ((nameHash >> 16) & 0x7F), 255);
+
+        drawList->AddRectFilled(rectMin, rectMax, scopeColor);
+
+        // show label if it fits into rect
+        const char* scopeLabel = cxx::va("%s %.2f", currScope.mName, currScope.mDuration);
+        ImVec2 labelSize = ImGui::CalcTextSize(scopeLabel);
+        if (labelSize.x < (rectMax.x - rectMin.x - 4.0f))
+        {
+            drawList->AddText(ImVec2(rectMin.x + 2.0f, rectMin.y), IM_COL32_BLACK, scopeLabel);
+        }
+
+        if (isCanvasHovered &&
+            mousePosition.x >= rectMin.x && mousePosition.x < rectMax.x &&
+            mousePosition.y >= rectMin.y && mousePosition.y < rectMax.y)
+        {
+            const char* threadLabel = (currScope.mThreadIndex == 0) ? "main thread" : cxx::va("worker %d", currScope.mThreadIndex);
+            ImGui::SetTooltip("%s\n%.3f ms (%.1f%%)\n%s", currScope.mName, currScope.mDuration,
+                (currScope.mDuration / frameDuration) * 100.0, threadLabel);
+        }
+    }
+
+    // separate thread lanes
+    for (int ithread = 1; ithread < frameSample->mThreadsCount; ++ithread)
+    {
+        if (laneRows[ithread] == 0)
+            continue;
+
+        float laneY = canvasPosition.y + laneFirstRow[ithread] * RowHeight - 1.0f;
+        drawList->AddLine(ImVec2(canvasPosition.x, laneY), ImVec2(canvasPosition.x + canvasSize.x, laneY), IM_COL32(255, 255, 255, 64));
+    }
+
+    ImGui::EndChild();
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "DebugWindow.h"
+
+// shows recent frames timings and scopes hierarchy of selected frame
+class FrameProfilerWindow: public DebugWindow
+{
+public:
+    FrameProfilerWindow();
+
+private:
+    // process window state
+    // @param imguiContext: Internal imgui context
+    void DoUI(ImGuiIO& imguiContext) override;
+
+    void DoFramesHistogram();
+    void DoFlameView();
+
+private:
+    int mSelectedFrameOffset = 0; // 0 is most recent frame
+    bool mFollowLastFrame = true;
+};
+
+extern FrameProfilerWindow gFrameProfilerWindow;
\ No newline at end of file
@@ -0,0 +1,454 @@
+#include "stdafx.h"
+#include "GameBenchmark.h"
+#include "CarnageGame.h"
+#include "SpriteManager.h"
+#include "PhysicsManager.h"
+#include "GameObjectsManager.h"
+#include "WeatherManager.h"
+#include "ParticleEffectsManager.h"
+#include "TrafficManager.h"
+#include "AiManager.h"
+#include "BroadcastEventsManager.h"
+#include "TimeManager.h"
+#include "MemoryManager.h"
+#include "SpriteBatch.h"
+#include "GameMapManager.h"
+#include "cvars.h"
+
+GameBenchmark gGameBenchmark;
+
+static const char* BenchmarkStageNames[] =
+{
+    "blocksAnimations",
+    "physics",
+    "gameObjects",
+    "weather",
+    "particles",
+    "traffic",
+    "ai",
+    "broadcastEvents",
+    "total",
+};
+
+bool GameBenchmark::RunBenchmark(int ticksCount)
+{
+    if (!gCarnageGame.IsInGameState())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot run benchmark, level is not loaded");
+        return false;
+    }
+
+    debug_assert(ticksCount > 0);
+    float tickTime = gPhysics.GetSimulationStepTime();
+    if (tickTime <= 0.0f)
+    {
+        tickTime = 1.0f / gCvarPhysicsFramerate.mValue;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Running benchmark: %d ticks, %.4f seconds per tick", ticksCount, tickTime);
+
+    for (std::vector<float>& currSamples: mStageSamples)
+    {
+        currSamples.clear();
+        currSamples.reserve(ticksCount);
+    }
+
+    for (int itick = 0; itick < ticksCount; ++itick)
+    {
+        gTimeManager.UpdateFrameFixed(tickTime);
+        gMemoryManager.FlushFrameHeapMemory();
+
+        ExecuteTick(gTimeManager.mGameFrameDelta);
+    }
+
+    SaveResults(tickTime);
+    return true;
+}
+
+void GameBenchmark::ExecuteTick(float deltaTime)
+{
+    using BenchmarkClock = std::chrono::high_resolution_clock;
+
+    BenchmarkClock::time_point tickStart = BenchmarkClock::now();
+    BenchmarkClock::time_point stageStart = tickStart;
+
+    auto EndStage = [this, &stageStart](eBenchmarkStage stage)
+    {
+        BenchmarkClock::time_point stageEnd = BenchmarkClock::now();
+        std::chrono::duration<float, std::milli> stageDuration = stageEnd - stageStart;
+        mStageSamples[stage].push_back(stageDuration.count());
+        stageStart = stageEnd;
+    };
+
+    // same order as in gameplay gamestate
+    gSpriteManager.UpdateBlocksAnimations(deltaTime);
+    EndStage(eBenchmarkStage_BlocksAnimations);
+    gPhysics.UpdateFrame();
+    EndStage(eBenchmarkStage_Physics);
+    gGameObjectsManager.UpdateFrame();
+    EndStage(eBenchmarkStage_GameObjects);
+    gWeatherManager.UpdateFrame();
+    EndStage(eBenchmarkStage_Weather);
+    gParticleManager.UpdateFrame();
+    EndStage(eBenchmarkStage_Particles);
+    gTrafficManager.UpdateFrame();
+    EndStage(eBenchmarkStage_Traffic);
+    gAiManager.UpdateFrame();
+    EndStage(eBenchmarkStage_Ai);
+    gBroadcastEvents.UpdateFrame();
+    EndStage(eBenchmarkStage_BroadcastEvents);
+
+    std::chrono::duration<float, std::milli> tickDuration = BenchmarkClock::now() - tickStart;
+    mStageSamples[eBenchmarkStage_Total].push_back(tickDuration.count());
+}
+
+void GameBenchmark::SaveResults(float tickTime)
+{
+    static_assert(sizeof(BenchmarkStageNames) / sizeof(BenchmarkStageNames[0]) == eBenchmarkStage_COUNT, "Stage names mismatch");
+
+    cxx::json_document resultsDocument;
+    resultsDocument.create_document();
+
+    cxx::json_document_node rootNode = resultsDocument.get_root_node();
+    rootNode.create_string_node("map", gCvarMapname.mValue);
+    rootNode.create_numeric_node("seed", gCvarGameRandSeed.mValue);
+    rootNode.create_numeric_node("ticks", (int) mStageSamples[eBenchmarkStage_Total].size());
+    rootNode.create_numeric_node("tickTime", tickTime);
+
+    cxx::json_document_node stagesNode = rootNode.create_object_node("stages");
+    for (int istage = 0; istage < eBenchmarkStage_COUNT; ++istage)
+    {
+        SaveSamplesStats(stagesNode, BenchmarkStageNames[istage], mStageSamples[istage]);
+    }
+
+    cxx::json_document_node worldNode = rootNode.create_object_node("world");
+    worldNode.create_numeric_node("objects", (int) gGameObjectsManager.mAllObjects.size());
+    worldNode.create_numeric_node("pedestrians", (int) gGameObjectsManager.mPedestriansList.size());
+    worldNode.create_numeric_node("vehicles", (int) gGameObjectsManager.mVehiclesList.size());
+
+    OutputResults(resultsDocument);
+}
+
+void GameBenchmark::SaveSamplesStats(cxx::json_document_node parentNode, const char* nodeName, std::vector<float>& samples) const
+{
+    if (samples.empty())
+        return;
+
+    std::sort(samples.begin(), samples.end());
+
+    float totalTime = 0.0f;
+    for (float currSample: samples)
+    {
+        totalTime += currSample;
+    }
+
+    int p99Index = (int) std::ceil(samples.size() * 0.99f) - 1;
+    p99Index = glm::clamp(p99Index, 0, (int) samples.size() - 1);
+
+    cxx::json_document_node statsNode = parentNode.create_object_node(nodeName);
+    statsNode.create_numeric_node("min", samples.front());
+    statsNode.create_numeric_node("avg", totalTime / samples.size());
+    statsNode.create_numeric_node("p99", samples[p99Index]);
+}
+
+void GameBenchmark::OutputResults(cxx::json_document& resultsDocument) const
+{
+    std::string documentContent;
+    resultsDocument.dump_document(documentContent);
+    printf("%s\n", documentContent.c_str());
+
+    if (!gCvarSysBenchmarkOutput.mValue.empty())
+    {
+        if (!gFiles.SaveConfig(gCvarSysBenchmarkOutput.mValue, resultsDocument))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot save benchmark results to '%s'", gCvarSysBenchmarkOutput.mValue.c_str());
+        }
+    }
+}
+
+bool GameBenchmark::RunSpritesSortBenchmark(int spritesCount)
+{
+    using BenchmarkClock = std::chrono::high_resolution_clock;
+
+    debug_assert(spritesCount > 0);
+    const int IterationsCount = 200;
+    const int TexturesCount = 8;
+
+    gConsole.LogMessage(eLogMessage_Info, "Running sprites sort benchmark: %d sprites, %d iterations", spritesCount, IterationsCount);
+
+    // sorting never touches texture data, so fake texture addresses are enough to emulate batches
+    static unsigned char FakeTextures[TexturesCount];
+
+    cxx::randomizer spritesRandom (gCvarGameRandSeed.mValue);
+    std::vector<Sprite2D> sourceSprites (spritesCount);
+    for (Sprite2D& currSprite: sourceSprites)
+    {
+        currSprite.mTexture = reinterpret_cast<GpuTexture2D*>(&FakeTextures[spritesRandom.generate_int(TexturesCount - 1)]);
+        // most of sprites are lying on few discrete map levels
+        currSprite.mHeight = spritesRandom.generate_int(0, 5) + (spritesRandom.random_chance(10) ? 0.25f : 0.0f);
+        currSprite.mDrawOrder = (eSpriteDrawOrder) spritesRandom.generate_int(eSpriteDrawOrder_Background, eSpriteDrawOrder_Projectiles);
+    }
+
+    auto SortProc = [](const Sprite2D& lhs, const Sprite2D& rhs)
+    {
+        if (lhs.mHeight != rhs.mHeight)
+        {
+            return (lhs.mHeight < rhs.mHeight);
+        }
+        return (lhs.mDrawOrder < rhs.mDrawOrder);
+    };
+
+    std::vector<float> comparatorSamples;
+    std::vector<float> radixSamples;
+    comparatorSamples.reserve(IterationsCount);
+    radixSamples.reserve(IterationsCount);
+
+    std::vector<Sprite2D> comparatorSprites;
+    SpriteBatch spriteBatch;
+    spriteBatch.BeginBatch(SpriteBatch::DepthAxis_Y, eSpritesSortMode_HeightAndDrawOrder);
+
+    for (int iteration = 0; iteration < IterationsCount; ++iteration)
+    {
+        comparatorSprites = sourceSprites;
+        BenchmarkClock::time_point sortStart = BenchmarkClock::now();
+        std::stable_sort(comparatorSprites.begin(), comparatorSprites.end(), SortProc);
+        std::chrono::duration<float, std::milli> sortDuration = BenchmarkClock::now() - sortStart;
+        comparatorSamples.push_back(sortDuration.count());
+
+        spriteBatch.mSpritesList = sourceSprites;
+        sortStart = BenchmarkClock::now();
+        spriteBatch.SortSprites();
+        sortDuration = BenchmarkClock::now() - sortStart;
+        radixSamples.push_back(sortDuration.count());
+    }
+
+    // both paths must produce same depth order, only sprites at same depth may be reordered by texture
+    for (int isprite = 0; isprite < spritesCount; ++isprite)
+    {
+        const Sprite2D& radixSprite = sourceSprites[spriteBatch.mSortedSprites[isprite].mSpriteIndex];
+        const Sprite2D& comparatorSprite = comparatorSprites[isprite];
+        if (radixSprite.mHeight != comparatorSprite.mHeight || radixSprite.mDrawOrder != comparatorSprite.mDrawOrder)
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Sprites sort order mismatch at %d", isprite);
+            spriteBatch.Clear();
+            return false;
+        }
+    }
+
+    // count texture switches
+    auto CountBatches = [spritesCount](auto GetSprite)
+    {
+        int batchesCount = 1;
+        for (int isprite = 1; isprite < spritesCount; ++isprite)
+        {
+            if (GetSprite(isprite).mTexture != GetSprite(isprite - 1).mTexture)
+            {
+                ++batchesCount;
+            }
+        }
+        return batchesCount;
+    };
+    int comparatorBatches = CountBatches([&comparatorSprites](int isprite) -> const Sprite2D& 
+    { 
+        return comparatorSprites[isprite]; 
+    });
+    int radixBatches = CountBatches([&spriteBatch, &sourceSprites](int isprite) -> const Sprite2D&
+    { 
+        return sourceSprites[spriteBatch.mSortedSprites[isprite].mSpriteIndex]; 
+    });
+    spriteBatch.Clear();
+
+    cxx::json_document resultsDocument;
+    resultsDocument.create_document();
+
+    cxx::json_document_node rootNode = resultsDocument.get_root_node();
+    rootNode.create_numeric_node("sprites", spritesCount);
+    rootNode.create_numeric_node("iterations", IterationsCount);
+    rootNode.create_numeric_node("seed", gCvarGameRandSeed.mValue);
+
+    SaveSamplesStats(rootNode, "stableSort", comparatorSamples);
+    SaveSamplesStats(rootNode, "radixSort", radixSamples);
+
+    cxx::json_document_node batchesNode = rootNode.create_object_node("batches");
+    batchesNode.create_numeric_node("stableSort", comparatorBatches);
+    batchesNode.create_numeric_node("radixSort", radixBatches);
+
+    OutputResults(resultsDocument);
+    return true;
+}
+
+bool GameBenchmark::RunStyleBlitBenchmark(int iterationsCount)
+{
+    using BenchmarkClock = std::chrono::high_resolution_clock;
+
+    debug_assert(iterationsCount > 0);
+
+    StyleData& styleData = gGameMap.mStyleData;
+    if (!styleData.IsLoaded())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Style blit benchmark requires loaded level");
+        return false;
+    }
+
+    const int BlocksCount = styleData.GetBlockTexturesCount();
+    const int SpritesCount = (int) styleData.mSprites.size();
+
+    gConsole.LogMessage(eLogMessage_Info, "Running style blit benchmark: %d blocks, %d sprites, %d iterations", 
+        BlocksCount, SpritesCount, iterationsCount);
+
+    // block textures are stacked vertically, sprites are blitted one by one to same place
+    PixelsArray blocksIndices;
+    PixelsArray blocksColors;
+    PixelsArray spriteIndices;
+    PixelsArray spriteColors;
+    if (!blocksIndices.Create(eTextureFormat_R8, MAP_BLOCK_TEXTURE_DIMS, MAP_BLOCK_TEXTURE_DIMS * BlocksCount) ||
+        !blocksColors.Create(eTextureFormat_RGBA8, MAP_BLOCK_TEXTURE_DIMS, MAP_BLOCK_TEXTURE_DIMS * BlocksCount) ||
+        !spriteIndices.Create(eTextureFormat_R8, GTA_SPRITE_PAGE_DIMS, GTA_SPRITE_PAGE_DIMS) ||
+        !spriteColors.Create(eTextureFormat_RGBA8, GTA_SPRITE_PAGE_DIMS, GTA_SPRITE_PAGE_DIMS))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot allocate style blit benchmark bitmaps");
+        return false;
+    }
+
+    auto GetBlockType = [&styleData](int blockLinearIndex, int& blockIndex)
+    {
+        eBlockType blockType = eBlockType_Side;
+        for (; blockType < eBlockType_Aux; blockType = (eBlockType) (blockType + 1))
+        {
+            if (blockLinearIndex < styleData.GetBlockTexturesCount(blockType))
+                break;
+
+            blockLinearIndex -= styleData.GetBlockTexturesCount(blockType);
+        }
+        blockIndex = blockLinearIndex;
+        return blockType;
+    };
+
+    auto BlitBlocks = [&styleData, &GetBlockType, BlocksCount](PixelsArray* bitmap)
+    {
+        for (int iblock = 0; iblock < BlocksCount; ++iblock)
+        {
+            int blockIndex = 0;
+            eBlockType blockType = GetBlockType(iblock, blockIndex);
+            styleData.GetBlockTexture(blockType, blockIndex, bitmap, 0, iblock * MAP_BLOCK_TEXTURE_DIMS, 0);
+        }
+    };
+
+    auto BlitSprites = [&styleData, SpritesCount](PixelsArray* bitmap)
+    {
+        for (int isprite = 0; isprite < SpritesCount; ++isprite)
+        {
+            styleData.GetSpriteTexture(isprite, bitmap, 0, 0);
+        }
+    };
+
+    // per pixel palette expansion as it was done before row kernels, used as reference
+    auto ExpandPixels = [](unsigned char* destPixels, const unsigned char* srcIndices, int pixelsCount, const Palette256& palette)
+    {
+        for (int ipixel = 0; ipixel < pixelsCount; ++ipixel)
+        {
+            unsigned char palentry = srcIndices[ipixel];
+            const Color32& color = palette.mColors[palentry];
+            destPixels[ipixel * 4 + 0] = color.mR;
+            destPixels[ipixel * 4 + 1] = color.mG;
+            destPixels[ipixel * 4 + 2] = color.mB;
+            destPixels[ipixel * 4 + 3] = (palentry == 0) ? 0x00 : 0xFF;
+        }
+    };
+
+    // collect tightly packed color indices of all sprites
+    std::vector<int> spritesOffsets (SpritesCount + 1);
+    std::vector<unsigned char> spritesIndices;
+    for (int isprite = 0; isprite < SpritesCount; ++isprite)
+    {
+        const SpriteInfo& sprite = styleData.mSprites[isprite];
+        spritesOffsets[isprite] = (int) spritesIndices.size();
+        styleData.GetSpriteTexture(isprite, &spriteIndices, 0, 0);
+        for (int iy = 0; iy < sprite.mHeight; ++iy)
+        {
+            const unsigned char* srcRow = spriteIndices.mData + iy * spriteIndices.mSizex;
+            spritesIndices.insert(spritesIndices.end(), srcRow, srcRow + sprite.mWidth);
+        }
+    }
+    spritesOffsets[SpritesCount] = (int) spritesIndices.size();
+
+    const int BlocksPixelsCount = BlocksCount * MAP_BLOCK_TEXTURE_AREA;
+    std::vector<unsigned char> referenceColors ((BlocksPixelsCount + spritesIndices.size()) * 4);
+    unsigned char* referenceSpritesColors = referenceColors.data() + BlocksPixelsCount * 4;
+
+    std::vector<float> indicesSamples;
+    std::vector<float> perPixelSamples;
+    std::vector<float> rowKernelsSamples;
+    indicesSamples.reserve(iterationsCount);
+    perPixelSamples.reserve(iterationsCount);
+    rowKernelsSamples.reserve(iterationsCount);
+
+    for (int iteration = 0; iteration < iterationsCount; ++iteration)
+    {
+        BenchmarkClock::time_point blitStart = BenchmarkClock::now();
+        BlitBlocks(&blocksIndices);
+        BlitSprites(&spriteIndices);
+        std::chrono::duration<float, std::milli> blitDuration = BenchmarkClock::now() - blitStart;
+        indicesSamples.push_back(blitDuration.count());
+
+        blitStart = BenchmarkClock::now();
+        for (int iblock = 0; iblock < BlocksCount; ++iblock)
+        {
+            int blockIndex = 0;
+            eBlockType blockType = GetBlockType(iblock, blockIndex);
+            const Palette256& palette = styleData.mPalettes[styleData.GetBlockTexturePaletteIndex(blockType, blockIndex, 0)];
+            const int PixelsOffset = iblock * MAP_BLOCK_TEXTURE_AREA;
+            ExpandPixels(referenceColors.data() + PixelsOffset * 4, blocksIndices.mData + PixelsOffset, MAP_BLOCK_TEXTURE_AREA, palette);
+        }
+        for (int isprite = 0; isprite < SpritesCount; ++isprite)
+        {
+            const Palette256& palette = styleData.mPalettes[styleData.GetSpritePaletteIndex(styleData.mSprites[isprite].mClut, 0)];
+            const int PixelsOffset = spritesOffsets[isprite];
+            ExpandPixels(referenceSpritesColors + PixelsOffset * 4, spritesIndices.data() + PixelsOffset, 
+                spritesOffsets[isprite + 1] - PixelsOffset, palette);
+        }
+        blitDuration = BenchmarkClock::now() - blitStart;
+        perPixelSamples.push_back(blitDuration.count());
+
+        blitStart = BenchmarkClock::now();
+        BlitBlocks(&blocksColors);
+        BlitSprites(&spriteColors);
+        blitDuration = BenchmarkClock::now() - blitStart;
+        rowKernelsSamples.push_back(blitDuration.count());
+    }
+
+    // row kernels must produce exactly same pixels as reference
+    bool isMatching = ::memcmp(blocksColors.mData, referenceColors.data(), BlocksPixelsCount * 4) == 0;
+    for (int isprite = 0; isprite < SpritesCount && isMatching; ++isprite)
+    {
+        const SpriteInfo& sprite = styleData.mSprites[isprite];
+        styleData.GetSpriteTexture(isprite, &spriteColors, 0, 0);
+        for (int iy = 0; iy < sprite.mHeight && isMatching; ++iy)
+        {
+            const unsigned char* referenceRow = referenceSpritesColors + (spritesOffsets[isprite] + iy * sprite.mWidth) * 4;
+            isMatching = ::memcmp(spriteColors.mData + iy * spriteColors.mSizex * 4, referenceRow, sprite.mWidth * 4) == 0;
+        }
+        if (!isMatching)
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Style blit mismatch at sprite %d", isprite);
+        }
+    }
+
+    if (!isMatching)
+        return false;
+
+    cxx::json_document resultsDocument;
+    resultsDocument.create_document();
+
+    cxx::json_document_node rootNode = resultsDocument.get_root_node();
+    rootNode.create_numeric_node("blocks", BlocksCount);
+    rootNode.create_numeric_node("sprites", SpritesCount);
+    rootNode.create_numeric_node("iterations", iterationsCount);
+
+    SaveSamplesStats(rootNode, "indices", indicesSamples);
+    SaveSamplesStats(rootNode, "perPixel", perPixelSamples);
+    SaveSamplesStats(rootNode, "rowKernels", rowKernelsSamples);
+
+    OutputResults(resultsDocument);
+    return true;
+}
\ No newline at end of file
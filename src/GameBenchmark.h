@@ -0,0 +1,48 @@
+#pragma once
+
+// Runs gameplay simulation for a fixed number of ticks without rendering and collects timings
+// of each subsystem, results are printed to stdout in json format
+class GameBenchmark final: public cxx::noncopyable
+{
+public:
+    // Run fixed step simulation on currently loaded level
+    // @param ticksCount: Number of simulation ticks
+    bool RunBenchmark(int ticksCount);
+
+    // Run sprites sorting microbenchmark, compares comparator based sort with sprite batch sort
+    // @param spritesCount: Number of sprites to sort
+    bool RunSpritesSortBenchmark(int spritesCount);
+
+    // Run style data blitting microbenchmark over all block textures and sprites of loaded level,
+    // compares per pixel palette expansion with row kernels
+    // @param iterationsCount: Number of passes over style data
+    bool RunStyleBlitBenchmark(int iterationsCount);
+
+private:
+    enum eBenchmarkStage
+    {
+        eBenchmarkStage_BlocksAnimations,
+        eBenchmarkStage_Physics,
+        eBenchmarkStage_GameObjects,
+        eBenchmarkStage_Weather,
+        eBenchmarkStage_Particles,
+        eBenchmarkStage_Traffic,
+        eBenchmarkStage_Ai,
+        eBenchmarkStage_BroadcastEvents,
+        eBenchmarkStage_Total,
+        eBenchmarkStage_COUNT
+    };
+
+    void ExecuteTick(float deltaTime);
+    void SaveResults(float tickTime);
+
+    // write min, avg and p99 of samples to json node, samples get sorted
+    void SaveSamplesStats(cxx::json_document_node parentNode, const char* nodeName, std::vector<float>& samples) const;
+    void OutputResults(cxx::json_document& resultsDocument) const;
+
+private:
+    // per tick samples of each stage, milliseconds
+    std::vector<float> mStageSamples[eBenchmarkStage_COUNT];
+};
+
+extern GameBenchmark gGameBenchmark;
\ No newline at end of file
@@ -2,15 +2,18 @@
 #include "GameCheatsWindow.h"
 #include "imgui.h"
 #include "RenderingManager.h"
+#include "SpriteManager.h"
 #include "PhysicsManager.h"
 #include "CarnageGame.h"
 #include "Pedestrian.h"
 #include "TimeManager.h"
 #include "AiManager.h"
 #include "TrafficManager.h"
+#include "AudioManager.h"
 #include "AiCharacterController.h"
 #include "cvars.h"
 #include "ImGuiHelpers.h"
+#include "FrameProfilerWindow.h"
 
 GameCheatsWindow gGameCheatsWindow;
 
@@ -96,6 +99,13 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
 
     ImGui::HorzSpacing();
     ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Frame Time: %.3f ms (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+    {
+        const FramePacingStats& pacingStats = gTimeManager.mFramePacingStats;
+        ImGui::Text("Frame pacing: avg %.3f ms, jitter %.3f ms, max %.3f ms",
+            pacingStats.mAverageFrameTime, pacingStats.mFrameTimeJitter, pacingStats.mMaxFrameTime);
+        ImGui::Text("Frame wait: sleep %.3f ms, spin %.3f ms", pacingStats.mAverageSleepTime, pacingStats.mAverageSpinTime);
+    }
+    ImGui::Checkbox("Frame profiler", &gFrameProfilerWindow.mWindowShown);
     
     // pedestrian stats
     if (playerCharacter)
@@ -115,6 +125,14 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
         {
             ImGui::Text("Traffic Hint: %s", cxx::enum_to_string(blockInfo->mTrafficHint));
         }
+        if ((characterLogPos.y > 0) && ImGui::Button("Clear block below"))
+        {
+            MapBlockInfo clearBlock = *gGameMap.GetBlockInfo(characterLogPos.x, characterLogPos.z, characterLogPos.y - 1);
+            clearBlock.mGroundType = eGroundType_Air;
+            clearBlock.mSlopeType = 0;
+            memset(clearBlock.mFaces, 0, sizeof(clearBlock.mFaces));
+            gGameMap.SetBlockInfo(characterLogPos.x, characterLogPos.z, characterLogPos.y - 1, clearBlock);
+        }
 
         if (Vehicle* currCar = playerCharacter->mCurrentCar)
         {
@@ -208,8 +226,22 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
     if (ImGui::CollapsingHeader("Draw"))
     {
         ImGui::Text("Map chunks drawn: %d", gRenderManager.mMapRenderer.mRenderStats.mBlockChunksDrawnCount);
+        ImGui::Text("Map chunks rebuilt: %d", gRenderManager.mMapRenderer.mRenderStats.mBlockChunksRebuiltCount);
         ImGui::Text("Sprites drawn: %d", gRenderManager.mMapRenderer.mRenderStats.mSpritesDrawnCount);
         ImGui::HorzSpacing();
+
+        SpritesCacheStats& cacheStats = gSpriteManager.mCacheStats;
+        ImGui::Text("Sprites cache: %d (%d kb)", cacheStats.mCachedSpritesCount, cacheStats.mCachedSpritesBytes / 1024);
+        ImGui::Text("Free textures: %d (%d kb)", cacheStats.mFreeTexturesCount, cacheStats.mFreeTexturesBytes / 1024);
+        ImGui::Text("Spritesheet pages: %d", cacheStats.mSpritesheetPagesCount);
+        ImGui::Text("Hits: %d, misses: %d, evictions: %d", cacheStats.mCacheHits, cacheStats.mCacheMisses, cacheStats.mCacheEvictions);
+        if (ImGui::Button("Reset counters"))
+        {
+            cacheStats.mCacheHits = 0;
+            cacheStats.mCacheMisses = 0;
+            cacheStats.mCacheEvictions = 0;
+        }
+        ImGui::HorzSpacing();
         ImGui::Checkbox("Debug draw", &mEnableDebugDraw);
         ImGui::Checkbox("Decorations", &mEnableDrawDecorations);
         ImGui::SameLine(); ImGui::Checkbox("Obstacles", &mEnableDrawObstacles);
@@ -218,6 +250,23 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
         ImGui::Checkbox("City mesh", &mEnableDrawCityMesh);
     }
 
+    if (ImGui::CollapsingHeader("Audio"))
+    {
+        SfxSamplesStats& sfxStats = gAudioManager.mSfxStats;
+        SfxVoicesStats& voicesStats = gAudioManager.mVoicesStats;
+        ImGui::Text("Resident samples: %d (%d kb)", sfxStats.mResidentSamplesCount, sfxStats.mResidentBytes / 1024);
+        ImGui::Text("Pending prefetches: %d", sfxStats.mPendingPrefetchesCount);
+        ImGui::Text("Prefetched: %d, stalls: %d, evictions: %d", sfxStats.mPrefetchedCount, sfxStats.mLoadStalls, sfxStats.mEvictions);
+        ImGui::Text("Voices: %d (real: %d), virtualized: %d", voicesStats.mActiveVoicesCount, voicesStats.mRealVoicesCount, voicesStats.mVirtualizedCount);
+        if (ImGui::Button("Reset counters##sfx"))
+        {
+            sfxStats.mPrefetchedCount = 0;
+            sfxStats.mLoadStalls = 0;
+            sfxStats.mEvictions = 0;
+            voicesStats.mVirtualizedCount = 0;
+        }
+    }
+
     if (ImGui::CollapsingHeader("Traffic"))
     {
         ImGui::HorzSpacing();
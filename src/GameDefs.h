@@ -15,6 +15,9 @@
 // map width and height is same
 #define MAP_DIMENSIONS 256
 #define MAP_LAYERS_COUNT 6
+// game objects spatial grid cell side length, in map blocks
+#define GAMEOBJECTS_GRID_CELL_SIZE 2
+#define GAMEOBJECTS_GRID_DIMENSIONS (MAP_DIMENSIONS / GAMEOBJECTS_GRID_CELL_SIZE)
 
 #define PIXELS_PER_MAP_UNIT (MAP_BLOCK_TEXTURE_DIMS)
 #define METERS_PER_MAP_UNIT (4.0f)
@@ -199,6 +202,22 @@ enum eGameObjectClass
 
 decl_enum_strings(eGameObjectClass);
 
+// game object classes mask, used to filter objects in spatial queries
+enum GameObjectClassMask: unsigned int
+{
+    GameObjectClassMask_None = 0,
+    GameObjectClassMask_Car = BIT(eGameObjectClass_Car),
+    GameObjectClassMask_Pedestrian = BIT(eGameObjectClass_Pedestrian),
+    GameObjectClassMask_Projectile = BIT(eGameObjectClass_Projectile),
+    GameObjectClassMask_Powerup = BIT(eGameObjectClass_Powerup),
+    GameObjectClassMask_Decoration = BIT(eGameObjectClass_Decoration),
+    GameObjectClassMask_Obstacle = BIT(eGameObjectClass_Obstacle),
+    GameObjectClassMask_Explosion = BIT(eGameObjectClass_Explosion),
+    GameObjectClassMask_All = (BIT(eGameObjectClass_COUNT) - 1),
+};
+
+decl_enum_as_flags(GameObjectClassMask);
+
 enum GameObjectFlags: unsigned int
 {
     GameObjectFlags_None = 0,
@@ -462,6 +481,55 @@ struct MapBlockInfo
 
 const unsigned int Sizeof_BlockInfo = sizeof(MapBlockInfo);
 
+// define compact map block information used by hot map queries
+// ground type, slope and flags are packed into 16 bits
+struct MapBlockBits
+{
+public:
+    MapBlockBits() = default;
+    explicit MapBlockBits(const MapBlockInfo& blockInfo)
+        : mBits(static_cast<unsigned short>(
+            (blockInfo.mGroundType & 0x07) | 
+            ((blockInfo.mSlopeType & 0x3F) << 3) |
+            (blockInfo.mUpDirection << 9) |
+            (blockInfo.mDownDirection << 10) |
+            (blockInfo.mLeftDirection << 11) |
+            (blockInfo.mRightDirection << 12) |
+            (blockInfo.mIsRailway << 13) |
+            (blockInfo.mIsFlat << 14)))
+    {
+    }
+    inline eGroundType GetGroundType() const { return static_cast<eGroundType>(mBits & 0x07); }
+    inline int GetSlopeType() const { return (mBits >> 3) & 0x3F; }
+    inline bool HasUpDirection() const { return (mBits & (1 << 9)) > 0; }
+    inline bool HasDownDirection() const { return (mBits & (1 << 10)) > 0; }
+    inline bool HasLeftDirection() const { return (mBits & (1 << 11)) > 0; }
+    inline bool HasRightDirection() const { return (mBits & (1 << 12)) > 0; }
+    inline bool IsRailway() const { return (mBits & (1 << 13)) > 0; }
+    inline bool IsFlat() const { return (mBits & (1 << 14)) > 0; }
+    // get number of traffic directions set
+    inline int GetDirectionsCount() const
+    {
+        return (int) HasUpDirection() + (int) HasDownDirection() + (int) HasLeftDirection() + (int) HasRightDirection();
+    }
+public:
+    unsigned short mBits = 0;
+};
+
+// map blocks column is padded so that it occupies 16 bytes, 4 columns per cache line
+#define MAP_COLUMN_STRIDE 8
+static_assert(MAP_COLUMN_STRIDE >= MAP_LAYERS_COUNT, "Map column stride is too small");
+
+// define precomputed ground surface of map blocks column
+struct MapColumnSurface
+{
+public:
+    // layer where falling body stops for each start layer, 0 if body falls to bottom
+    unsigned char mGroundLayer[MAP_LAYERS_COUNT]; // water is solid
+    unsigned char mGroundLayerNoWater[MAP_LAYERS_COUNT]; // water is passable
+    signed char mWaterLayer; // topmost water layer, -1 if there is no water
+};
+
 // define map block anim information
 struct BlockAnimationInfo
 {
@@ -636,6 +704,9 @@ struct SpriteInfo
     {
         int mSize; // bytes for this delta
         int mOffset;
+        // decoded spans, see StyleData::mSpriteDeltaSpans
+        int mFirstSpan;
+        int mSpansCount;
     };
     DeltaInfo mDeltas[MAX_SPRITE_DELTAS];
 
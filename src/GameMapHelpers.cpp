@@ -7,10 +7,6 @@ bool GameMapHelpers::BuildMapMesh(GameMapManager& cityScape, const Rect& area, i
 {
     debug_assert(layerIndex > -1 && layerIndex < MAP_LAYERS_COUNT);
 
-    // preallocate
-    meshData.mBlocksIndices.reserve(1 * 1024 * 1024);
-    meshData.mBlocksVertices.reserve(1 * 1024 * 1024);
-
     // prepare
     for (int tiley = 0; tiley < area.h; ++tiley)
     for (int tilex = 0; tilex < area.w; ++tilex)
@@ -33,10 +29,6 @@ bool GameMapHelpers::BuildMapMesh(GameMapManager& cityScape, const Rect& area, i
 
 bool GameMapHelpers::BuildMapMesh(GameMapManager& cityScape, const Rect& area, CityMeshData& meshData)
 {
-    // preallocate
-    meshData.mBlocksIndices.reserve(4 * 1024 * 1024);
-    meshData.mBlocksVertices.reserve(4 * 1024 * 1024);
-
     // prepare
     for (int tilez = 0; tilez < MAP_LAYERS_COUNT; ++tilez)
     for (int tiley = 0; tiley < area.h; ++tiley)
@@ -25,7 +25,7 @@ class GameMapManager;
 class GameMapHelpers final
 {
 public:
-    // construct mesh for specified city area and layer
+    // construct mesh for specified city area and layer, geometry is appended to mesh data
     // @param cityScape: City scape data
     // @param area: Target map rect
     // @param layerIndex: Target map layer, see MAP_LAYERS_COUNT
@@ -1,7 +1,9 @@
 #include "stdafx.h"
 #include "GameMapManager.h"
 #include "CarnageGame.h"
+#include "RenderingManager.h"
 #include "cvars.h"
+#include "TrafficManager.h"
 
 GameMapManager gGameMap;
 
@@ -29,19 +31,22 @@ struct GTAFileHeaderCMP
     int nav_data_size;
 };
 
-bool GameMapManager::LoadFromFile(const std::string& filename)
+bool GameMapManager::LoadFromFile(const std::string& filename, const MapBlockInfo* decodedMapTiles)
 {
     Cleanup();
 
     gConsole.LogMessage(eLogMessage_Info, "Loading map data '%s'", filename.c_str());
 
-    std::ifstream file;
-    if (!gFiles.OpenBinaryFile(filename, file))
+    // file data is parsed directly from memory mapping
+    MappedFile mappedFile;
+    if (!gFiles.OpenMappedFile(filename, mappedFile))
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot open map data file");
         return false;
     }
 
+    cxx::memory_reader file(mappedFile.mData, mappedFile.mDataLength);
+
     GTAFileHeaderCMP header;
     if (!cxx::read_from_stream(file, header) || header.version_code != GTA_CMPFILE_VERSION_CODE)
     {
@@ -49,12 +54,24 @@ bool GameMapManager::LoadFromFile(const std::string& filename)
         return false;
     }
 
-    if (!ReadCompressedMapData(file, header.column_size, header.block_size))
+    if (decodedMapTiles)
+    {
+        const int compressedDataLength = (MAP_DIMENSIONS * MAP_DIMENSIONS * sizeof(int)) + header.column_size + header.block_size;
+        if (!file.skip(compressedDataLength))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot read compressed map data");
+            return false;
+        }
+        memcpy(mMapTiles, decodedMapTiles, sizeof(mMapTiles));
+    }
+    else if (!ReadCompressedMapData(file, header.column_size, header.block_size))
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot read compressed map data");
         return false;
     }
 
+    BuildMapColumns();
+
     if (!ReadStartupObjects(file, header.object_pos_size))
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot read startup objects data");
@@ -104,6 +121,8 @@ void GameMapManager::Cleanup()
             memset(&mMapTiles[tilez][tiley][tilex], 0, Sizeof_BlockInfo);
         }
     }
+    memset(mMapColumns, 0, sizeof(mMapColumns));
+    memset(mColumnSurfaces, 0, sizeof(mColumnSurfaces));
     mStartupObjects.clear();
     for (int ibase = 0; ibase < eAccidentServise_COUNT; ++ibase)
     {
@@ -113,29 +132,58 @@ void GameMapManager::Cleanup()
     mAudioFileNumber = 0;
 }
 
+bool GameMapManager::GetMapStyleFileName(const std::string& filename, std::string& styleName) const
+{
+    MappedFile mappedFile;
+    if (!gFiles.OpenMappedFile(filename, mappedFile))
+        return false;
+
+    cxx::memory_reader file(mappedFile.mData, mappedFile.mDataLength);
+
+    GTAFileHeaderCMP header;
+    if (!cxx::read_from_stream(file, header) || header.version_code != GTA_CMPFILE_VERSION_CODE)
+        return false;
+
+    styleName = GetStyleFileName(header.style_number);
+    return true;
+}
+
+void GameMapManager::GetMapTiles(std::vector<MapBlockInfo>& mapTiles) const
+{
+    const MapBlockInfo* firstTile = &mMapTiles[0][0][0];
+    mapTiles.assign(firstTile, firstTile + (MAP_LAYERS_COUNT * MAP_DIMENSIONS * MAP_DIMENSIONS));
+}
+
 bool GameMapManager::IsLoaded() const
 {
     return mStyleData.IsLoaded();
 }
 
-bool GameMapManager::ReadCompressedMapData(std::istream& file, int columnLength, int blocksLength)
+bool GameMapManager::ReadCompressedMapData(cxx::memory_reader& file, int columnLength, int blocksLength)
 {
     // reading base data
     const int baseDataLength = MAP_DIMENSIONS * MAP_DIMENSIONS * sizeof(int);
-    if (!file.read(reinterpret_cast<char*>(mBaseTilesData), baseDataLength))
+    if (!file.read(mBaseTilesData, baseDataLength))
         return false;
 
-    // reading column data
-    std::vector<unsigned short> columnData;
+    // column data is accessed in place, it is not guaranteed to be aligned
+    const unsigned char* columnData = nullptr;
+    const int columnDataCount = columnLength / (int) sizeof(unsigned short);
     if (columnLength)
     {
         assert((columnLength % sizeof(unsigned short)) == 0);
-        columnData.resize(columnLength / sizeof(unsigned short));
-
-        if (!file.read(reinterpret_cast<char*>(columnData.data()), columnLength))
+        columnData = file.read_pointer(columnLength);
+        if (columnData == nullptr)
             return false;
     }
 
+    auto GetColumnElement = [columnData](int elementIndex)
+    {
+        unsigned short elementValue;
+        ::memcpy(&elementValue, columnData + elementIndex * sizeof(unsigned short), sizeof(elementValue));
+        return elementValue;
+    };
+
     std::vector<MapBlockInfo> blocksData;
 
     const int blockSize = sizeof(unsigned short) + sizeof(unsigned char) * 6;
@@ -195,10 +243,25 @@ bool GameMapManager::ReadCompressedMapData(std::istream& file, int columnLength,
     {
         const int columnElement = mBaseTilesData[tiley][tilex] / sizeof(unsigned short);
         assert((mBaseTilesData[tiley][tilex] % sizeof(unsigned short)) == 0);
-        const int columnHeight = MAP_LAYERS_COUNT - columnData[columnElement];
+        if (columnElement >= columnDataCount)
+        {
+            debug_assert(false);
+            return false;
+        }
+        const int columnHeight = MAP_LAYERS_COUNT - GetColumnElement(columnElement);
+        if (columnHeight < 0 || columnHeight > MAP_LAYERS_COUNT || columnElement + columnHeight >= columnDataCount)
+        {
+            debug_assert(false);
+            return false;
+        }
         for (int tilez = 0; tilez < columnHeight; ++tilez)
         {
-            int srcBlock = columnData[columnElement + columnHeight - tilez];
+            int srcBlock = GetColumnElement(columnElement + columnHeight - tilez);
+            if (srcBlock >= (int) blocksData.size())
+            {
+                debug_assert(false);
+                return false;
+            }
             mMapTiles[tilez][tiley][tilex] = blocksData[srcBlock];
         }
     }
@@ -215,6 +278,97 @@ const MapBlockInfo* GameMapManager::GetBlockInfo(int coordx, int coordz, int lay
     return &mMapTiles[layer][coordz][coordx];
 }
 
+bool GameMapManager::SetBlockInfo(int coordx, int coordz, int layer, const MapBlockInfo& blockInfo)
+{
+    if ((layer < 0) || (layer >= MAP_LAYERS_COUNT) || 
+        (coordx < 0) || (coordx >= MAP_DIMENSIONS) || 
+        (coordz < 0) || (coordz >= MAP_DIMENSIONS))
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    mMapTiles[layer][coordz][coordx] = blockInfo;
+    mMapColumns[coordz][coordx][layer] = MapBlockBits(blockInfo);
+    UpdateColumnSurface(coordx, coordz);
+
+    // faces of neighbour blocks might become visible or hidden
+    if (!gCvarSysHeadless.mValue)
+    {
+        Rect changedArea { coordx - 1, coordz - 1, 3, 3 };
+        gRenderManager.mMapRenderer.InvalidateMapMesh(changedArea);
+    }
+
+    // traffic spawn cell depends only on blocks of its own column
+    Rect spawnArea { coordx, coordz, 1, 1 };
+    gTrafficManager.InvalidateSpawnCandidates(spawnArea);
+    return true;
+}
+
+const MapBlockBits* GameMapManager::GetBlockColumn(int coordx, int coordz) const
+{
+    coordx = glm::clamp(coordx, 0, MAP_DIMENSIONS - 1);
+    coordz = glm::clamp(coordz, 0, MAP_DIMENSIONS - 1);
+
+    return mMapColumns[coordz][coordx];
+}
+
+void GameMapManager::BuildMapColumns()
+{
+    for (int tiley = 0; tiley < MAP_DIMENSIONS; ++tiley)
+    for (int tilex = 0; tilex < MAP_DIMENSIONS; ++tilex)
+    {
+        MapBlockBits* column = mMapColumns[tiley][tilex];
+        for (int tilez = 0; tilez < MAP_LAYERS_COUNT; ++tilez)
+        {
+            column[tilez] = MapBlockBits(mMapTiles[tilez][tiley][tilex]);
+        }
+        // padding layers are air
+        for (int tilez = MAP_LAYERS_COUNT; tilez < MAP_COLUMN_STRIDE; ++tilez)
+        {
+            column[tilez] = MapBlockBits();
+        }
+        UpdateColumnSurface(tilex, tiley);
+    }
+}
+
+void GameMapManager::UpdateColumnSurface(int coordx, int coordz)
+{
+    const MapBlockBits* column = mMapColumns[coordz][coordx];
+    MapColumnSurface& surface = mColumnSurfaces[coordz][coordx];
+
+    // falling body stops at first slope or solid block, bottom layer is never tested
+    for (int startLayer = 0; startLayer < MAP_LAYERS_COUNT; ++startLayer)
+    {
+        int groundLayer = startLayer;
+        for (; groundLayer > 0; --groundLayer)
+        {
+            if (column[groundLayer].GetSlopeType() || column[groundLayer].GetGroundType() != eGroundType_Air)
+                break;
+        }
+        surface.mGroundLayer[startLayer] = groundLayer;
+
+        groundLayer = startLayer;
+        for (; groundLayer > 0; --groundLayer)
+        {
+            eGroundType groundType = column[groundLayer].GetGroundType();
+            if (column[groundLayer].GetSlopeType() || (groundType != eGroundType_Air && groundType != eGroundType_Water))
+                break;
+        }
+        surface.mGroundLayerNoWater[startLayer] = groundLayer;
+    }
+
+    surface.mWaterLayer = -1;
+    for (int tilez = MAP_LAYERS_COUNT - 1; tilez > -1; --tilez)
+    {
+        if (column[tilez].GetGroundType() == eGroundType_Water)
+        {
+            surface.mWaterLayer = tilez;
+            break;
+        }
+    }
+}
+
 void GameMapManager::FixShiftedBits()
 {
     // as CityScape Data Structure document says:
@@ -258,17 +412,15 @@ void GameMapManager::FixShiftedBits()
 float GameMapManager::GetWaterLevelAtPosition2(const glm::vec2& position) const
 {
     glm::ivec2 blockPosition = Convert::MetersToMapUnits(position);
+    blockPosition.x = glm::clamp(blockPosition.x, 0, MAP_DIMENSIONS - 1);
+    blockPosition.y = glm::clamp(blockPosition.y, 0, MAP_DIMENSIONS - 1);
 
-    for (int i = MAP_LAYERS_COUNT; i > 0; --i)
-    {
-        const MapBlockInfo* blockData = GetBlockInfo(blockPosition.x, blockPosition.y, i - 1);
-        if (blockData->mGroundType == eGroundType_Water)
-        {
-            float waterHeight = Convert::MapUnitsToMeters(i - 1.0f);
-            return waterHeight;
-        }
-    }
-    return 0.0f;
+    const MapColumnSurface& surface = mColumnSurfaces[blockPosition.y][blockPosition.x];
+    if (surface.mWaterLayer < 0)
+        return 0.0f;
+
+    float waterHeight = Convert::MapUnitsToMeters((float) surface.mWaterLayer);
+    return waterHeight;
 }
 
 const DistrictInfo* GameMapManager::GetDistrictAtPosition2(const glm::vec2& position) const
@@ -306,31 +458,38 @@ float GameMapManager::GetHeightAtPosition(const glm::vec3& position, bool exclud
     // get map block position in which we are located
     glm::ivec3 mapBlock = Convert::MetersToMapUnits(position);
 
-    float currentHeight = (float) mapBlock.y; // set current height to ground, map units
-    for (; currentHeight > 0.0f;)
-    {
-        const MapBlockInfo* blockData = GetBlockInfo(mapBlock.x, mapBlock.z, mapBlock.y); // y is map layer
+    // y is map layer
+    if (mapBlock.y < 1)
+        return Convert::MapUnitsToMeters((float) mapBlock.y);
 
-        // compute slope height
-        if (blockData->mSlopeType) 
-        {
-            // subposition within block
-            float cx = Convert::MetersToMapUnits(position.x) - mapBlock.x;
-            float cy = Convert::MetersToMapUnits(position.z) - mapBlock.z;
+    const int columnx = glm::clamp(mapBlock.x, 0, MAP_DIMENSIONS - 1);
+    const int columnz = glm::clamp(mapBlock.z, 0, MAP_DIMENSIONS - 1);
+    const MapBlockBits* column = mMapColumns[columnz][columnx];
+    const MapColumnSurface& surface = mColumnSurfaces[columnz][columnx];
+    const unsigned char* groundLayers = excludeWater ? surface.mGroundLayerNoWater : surface.mGroundLayer;
 
-            currentHeight += GameMapHelpers::GetSlopeHeight(blockData->mSlopeType, cx, cy);
+    // above top layer body falls through to top layer, unless top block is solid
+    int groundLayer = std::min(mapBlock.y, MAP_LAYERS_COUNT - 1);
+    if (groundLayers[groundLayer] == groundLayer)
+    {
+        groundLayer = mapBlock.y;
+    }
+    else
+    {
+        groundLayer = groundLayers[groundLayer];
+    }
 
-            break;
-        }
+    float currentHeight = (float) groundLayer;
 
-        if (blockData->mGroundType == eGroundType_Air || (blockData->mGroundType == eGroundType_Water && excludeWater)) // fall through non solid block
-        {
-            currentHeight -= 1.0f;
-            mapBlock.y -= 1;
-            continue;
-        }
+    // compute slope height
+    const int slopeType = (groundLayer > 0) ? column[std::min(groundLayer, MAP_LAYERS_COUNT - 1)].GetSlopeType() : 0;
+    if (slopeType)
+    {
+        // subposition within block
+        float cx = Convert::MetersToMapUnits(position.x) - mapBlock.x;
+        float cy = Convert::MetersToMapUnits(position.z) - mapBlock.z;
 
-        break; // bail out
+        currentHeight += GameMapHelpers::GetSlopeHeight(slopeType, cx, cy);
     }
     return Convert::MapUnitsToMeters(currentHeight);
 }
@@ -427,7 +586,7 @@ bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& de
     return false;
 }
 
-bool GameMapManager::ReadStartupObjects(std::istream& file, int dataSize)
+bool GameMapManager::ReadStartupObjects(cxx::memory_reader& file, int dataSize)
 {
     const unsigned int RecordSize = 14;
     debug_assert(dataSize % RecordSize == 0);
@@ -457,13 +616,12 @@ bool GameMapManager::ReadStartupObjects(std::istream& file, int dataSize)
     return true;
 }
 
-bool GameMapManager::ReadRoutes(std::istream& file, int dataSize)
+bool GameMapManager::ReadRoutes(cxx::memory_reader& file, int dataSize)
 {
-    file.seekg(dataSize, std::ios::cur);
-    return true;
+    return file.skip(dataSize);
 }
 
-bool GameMapManager::ReadServiceBaseLocations(std::ifstream& file)
+bool GameMapManager::ReadServiceBaseLocations(cxx::memory_reader& file)
 {
     struct LocationData
     {
@@ -488,7 +646,7 @@ bool GameMapManager::ReadServiceBaseLocations(std::ifstream& file)
     const int DataSize = sizeof(locations);
     static_assert(DataSize == (MaxLocations * 6 * LocationDataSize), "Invalid locations data size");
 
-    if (!file.read((char*)&locations, DataSize))
+    if (!file.read(&locations, DataSize))
     {
         debug_assert(false);
         return false;
@@ -533,7 +691,7 @@ bool GameMapManager::ReadServiceBaseLocations(std::ifstream& file)
     return true;
 }
 
-bool GameMapManager::ReadNavData(std::ifstream& file, int dataSize)
+bool GameMapManager::ReadNavData(cxx::memory_reader& file, int dataSize)
 {
     struct nav_data_struct
     {
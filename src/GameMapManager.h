@@ -19,7 +19,18 @@ public:
 public:
     // load map data from specific file, returns false on error
     // @param filename: Target file name
-    bool LoadFromFile(const std::string& filename);
+    // @param decodedMapTiles: Optional previously decoded map grid of MAP_LAYERS_COUNT * MAP_DIMENSIONS * MAP_DIMENSIONS blocks,
+    //                         compressed map data is not decoded if specified
+    bool LoadFromFile(const std::string& filename, const MapBlockInfo* decodedMapTiles = nullptr);
+
+    // read style file name from map file header without loading map
+    // @param filename: Map file name
+    // @param styleName: Output style file name
+    bool GetMapStyleFileName(const std::string& filename, std::string& styleName) const;
+
+    // copy decoded map grid, z y x order
+    // @param mapTiles: Output blocks
+    void GetMapTiles(std::vector<MapBlockInfo>& mapTiles) const;
 
     // free currently loaded map data
     void Cleanup();
@@ -32,6 +43,18 @@ public:
     // @param coordx, coordy, layer: Block location
     const MapBlockInfo* GetBlockInfo(int coordx, int coordy, int layer) const;
 
+    // change map block at specific location, city mesh chunks around block get rebuilt on next render frame
+    // note that static collision geometry is built on level start and is not updated
+    // @param coordx, coordy, layer: Block location
+    // @param blockInfo: New block data
+    // @returns false if location is out of map bounds
+    bool SetBlockInfo(int coordx, int coordy, int layer, const MapBlockInfo& blockInfo);
+
+    // get compact blocks column at specific location, layers go from bottom to top
+    // columns are stored contiguously so top-down scans touch single cache line
+    // @param coordx, coordy: Column location, gets clamped to map dimensions
+    const MapBlockBits* GetBlockColumn(int coordx, int coordy) const;
+
     // Get navigation data sector at specific map point
     // @param position: Current position on map, meters
     // @returns null on error
@@ -58,17 +81,22 @@ public:
 private:
     // Reading map data internals
     // @param file: Source stream
-    bool ReadCompressedMapData(std::istream& file, int columnLength, int blockLength);
-    bool ReadStartupObjects(std::istream& file, int dataSize);
-    bool ReadRoutes(std::istream& file, int dataSize);
-    bool ReadServiceBaseLocations(std::ifstream& file);
-    bool ReadNavData(std::ifstream& file, int dataSize);
+    bool ReadCompressedMapData(cxx::memory_reader& file, int columnLength, int blockLength);
+    bool ReadStartupObjects(cxx::memory_reader& file, int dataSize);
+    bool ReadRoutes(cxx::memory_reader& file, int dataSize);
+    bool ReadServiceBaseLocations(cxx::memory_reader& file);
+    bool ReadNavData(cxx::memory_reader& file, int dataSize);
     void FixShiftedBits();
+    void BuildMapColumns();
+    // should be invoked whenever blocks within column are changed
+    void UpdateColumnSurface(int coordx, int coordy);
 
     std::string GetStyleFileName(int styleNumber) const;
 
 private:
     MapBlockInfo mMapTiles[MAP_LAYERS_COUNT][MAP_DIMENSIONS][MAP_DIMENSIONS]; // z, y, x
+    alignas(16) MapBlockBits mMapColumns[MAP_DIMENSIONS][MAP_DIMENSIONS][MAP_COLUMN_STRIDE]; // y, x, z
+    MapColumnSurface mColumnSurfaces[MAP_DIMENSIONS][MAP_DIMENSIONS]; // y, x
     int mBaseTilesData[MAP_DIMENSIONS][MAP_DIMENSIONS]; // y x
 
     // accident service base locations
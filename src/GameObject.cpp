@@ -10,6 +10,7 @@
 GameObject::GameObject(eGameObjectClass objectTypeID, GameObjectID uniqueID)
     : mObjectID(uniqueID)
     , mClassID(objectTypeID)
+    , mGridCellNode(this)
 {
 }
 
@@ -43,14 +44,12 @@ void GameObject::FreeSounds()
 
 void GameObject::SetSprite(int spriteIndex, SpriteDeltaBits deltaBits)
 {
-    if (deltaBits > 0)
-    {
-        gSpriteManager.GetSpriteTexture(mObjectID, spriteIndex, mRemapClut, deltaBits, mDrawSprite);
-    }
-    else
-    {
-        gSpriteManager.GetSpriteTexture(mObjectID, spriteIndex, mRemapClut, mDrawSprite);
-    }
+    mDrawSpriteIndex = spriteIndex;
+    mDrawSpriteDeltaBits = deltaBits;
+
+    // objects are updated on worker threads, so sprite with deltas is not created here,
+    // renderer resolves it before draw on main thread, base sprite has same dimensions
+    gSpriteManager.GetSpriteTexture(mObjectID, spriteIndex, mRemapClut, mDrawSprite);
     RefreshDrawSprite();
 }
 
@@ -229,6 +228,7 @@ void GameObject::OnTransformChanged()
         mPhysicsBody->SetTransform(mTransform.mPosition, mTransform.mOrientation);
     }
 
+    gGameObjectsManager.RefreshObjectGridCell(this);
     RefreshDrawSprite();
 
     // update attached objects
@@ -284,6 +284,7 @@ void GameObject::SyncPhysicsTransform()
         }
     }
 
+    gGameObjectsManager.RefreshObjectGridCell(this);
     RefreshDrawSprite();
 
     // propagate sync to attached objects
@@ -632,12 +633,9 @@ bool GameObject::StartGameObjectSound(int ichannel, eSfxSampleType sampleType, S
 
     if (mSfxEmitter)
     {
-        SfxSample* sfxSample = gAudioManager.GetSound(sampleType, sampleIndex);
-        if (sfxSample)
-        {
-            mSfxEmitter->UpdateEmitterParams(mTransformSmooth.mPosition); // force sync params
-            return mSfxEmitter->StartSound(ichannel, sfxSample, sfxFlags);
-        }
+        // sample might be not loaded yet, in that case sound starts later on main thread
+        mSfxEmitter->UpdateEmitterParams(mTransformSmooth.mPosition); // force sync params
+        return gAudioManager.StartEmitterSound(mSfxEmitter, ichannel, sampleType, sampleIndex, sfxFlags);
     }
     return false;
 }
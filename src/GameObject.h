@@ -150,8 +150,17 @@ protected:
     int mRemapClut = 0;
     cxx::aabbox2d_t mDrawBounds; // sprite bounds cache
 
+    // sprite with deltas is cached by sprite manager and might be evicted, so it's requested before each draw
+    int mDrawSpriteIndex = 0;
+    SpriteDeltaBits mDrawSpriteDeltaBits = 0;
+
 private:
     // marked object will be destroyed next game frame
     bool mMarkedForDeletion = false;
     unsigned int mLastRenderFrame = 0; // render frames counter
+
+    // spatial grid location, managed by GameObjectsManager
+    cxx::intrusive_node<GameObject> mGridCellNode;
+    int mGridCellIndex = -1;
+    unsigned int mCreationIndex = 0; // order of objects creation
 };
\ No newline at end of file
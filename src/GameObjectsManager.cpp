@@ -6,6 +6,7 @@
 #include "GameMapManager.h"
 #include "Projectile.h"
 #include "RenderingManager.h"
+#include "FrameProfiler.h"
 
 GameObjectsManager gGameObjectsManager;
 
@@ -26,6 +27,7 @@ GameObjectsManager::~GameObjectsManager()
 void GameObjectsManager::EnterWorld()
 {
     mIDsCounter = 0;
+    mCreationCounter = 0;
 
     if (!CreateStartupObjects())
     {
@@ -40,6 +42,7 @@ void GameObjectsManager::ClearWorld()
 
 void GameObjectsManager::UpdateFrame()
 {
+    PROFILE_SCOPE("Game objects");
     bool hasDeadObjects = false;
 
     // if is safe to add new objects during loop by adding them to the end of the list
@@ -76,6 +79,7 @@ Pedestrian* GameObjectsManager::CreatePedestrian(const glm::vec3& position, cxx:
         instance->mRemapIndex = remap;
     }
     mAllObjects.push_back(instance);
+    InsertObjectToGrid(instance);
     mPedestriansList.push_back(instance);
 
     // init
@@ -94,6 +98,7 @@ Vehicle* GameObjectsManager::CreateVehicle(const glm::vec3& position, cxx::angle
     debug_assert(instance);
 
     mAllObjects.push_back(instance);
+    InsertObjectToGrid(instance);
     mVehiclesList.push_back(instance);
 
     // init
@@ -129,6 +134,7 @@ Projectile* GameObjectsManager::CreateProjectile(const glm::vec3& position, cxx:
     debug_assert(instance);
 
     mAllObjects.push_back(instance);
+    InsertObjectToGrid(instance);
     // init
     instance->SetTransform(position, heading);
     instance->HandleSpawn();
@@ -148,6 +154,7 @@ Obstacle* GameObjectsManager::CreateObstacle(const glm::vec3& position, cxx::ang
         instance = mObstaclesPool.create(objectID, desc);
         debug_assert(instance);
         mAllObjects.push_back(instance);
+        InsertObjectToGrid(instance);
         // init
         instance->SetTransform(position, heading);
         instance->HandleSpawn();
@@ -160,6 +167,7 @@ Explosion* GameObjectsManager::CreateExplosion(GameObject* explodingObject, Pede
     Explosion* instance = mExplosionsPool.create(explodingObject, causer, explosionType);
     debug_assert(instance);
     mAllObjects.push_back(instance);
+    InsertObjectToGrid(instance);
     // init
     static const cxx::angle_t heading;
     instance->SetTransform(position, heading);
@@ -179,6 +187,7 @@ Decoration* GameObjectsManager::CreateDecoration(const glm::vec3& position, cxx:
     instance = mDecorationsPool.create(objectID, desc);
     debug_assert(instance);
     mAllObjects.push_back(instance);
+    InsertObjectToGrid(instance);
     // init
     instance->SetTransform(position, heading);
     instance->HandleSpawn();
@@ -306,6 +315,7 @@ void GameObjectsManager::DestroyGameObject(GameObject* object)
     }
 
     object->HandleDespawn();
+    RemoveObjectFromGrid(object);
 
     cxx::erase_elements(mAllObjects, object);
 
@@ -417,6 +427,106 @@ GameObjectID GameObjectsManager::GenerateUniqueID()
     return newID;
 }
 
+void GameObjectsManager::QueryObjectsInRect(const cxx::aabbox2d_t& area, GameObjectClassMask classMask, std::vector<GameObject*>& outputObjects) const
+{
+    const float cellLength = Convert::MapUnitsToMeters(GAMEOBJECTS_GRID_CELL_SIZE * 1.0f);
+
+    int minCellX = glm::clamp((int) std::floor(area.mMin.x / cellLength), 0, GAMEOBJECTS_GRID_DIMENSIONS - 1);
+    int minCellY = glm::clamp((int) std::floor(area.mMin.y / cellLength), 0, GAMEOBJECTS_GRID_DIMENSIONS - 1);
+    int maxCellX = glm::clamp((int) std::floor(area.mMax.x / cellLength), 0, GAMEOBJECTS_GRID_DIMENSIONS - 1);
+    int maxCellY = glm::clamp((int) std::floor(area.mMax.y / cellLength), 0, GAMEOBJECTS_GRID_DIMENSIONS - 1);
+
+    for (int cellY = minCellY; cellY <= maxCellY; ++cellY)
+    {
+        for (int cellX = minCellX; cellX <= maxCellX; ++cellX)
+        {
+            const cxx::intrusive_list<GameObject>& cellObjects = mGridCells[cellY * GAMEOBJECTS_GRID_DIMENSIONS + cellX];
+            for (GameObject* currObject: cellObjects)
+            {
+                if ((classMask & BIT(currObject->mClassID)) == 0)
+                    continue;
+
+                if (area.contains(currObject->mTransform.GetPosition2()))
+                {
+                    outputObjects.push_back(currObject);
+                }
+            }
+        }
+    }
+}
+
+void GameObjectsManager::SortObjectsInCreationOrder(std::vector<GameObject*>& objects) const
+{
+    std::sort(objects.begin(), objects.end(), [](const GameObject* lhs, const GameObject* rhs)
+    {
+        return lhs->mCreationIndex < rhs->mCreationIndex;
+    });
+}
+
+void GameObjectsManager::QueryObjectsInRadius(const glm::vec2& center, float radius, GameObjectClassMask classMask, std::vector<GameObject*>& outputObjects) const
+{
+    size_t firstObjectIndex = outputObjects.size();
+
+    cxx::aabbox2d_t area (center - glm::vec2(radius), center + glm::vec2(radius));
+    QueryObjectsInRect(area, classMask, outputObjects);
+
+    // discard objects within rect corners
+    float radius2 = radius * radius;
+    auto outsideRadius = std::remove_if(outputObjects.begin() + firstObjectIndex, outputObjects.end(), [&center, radius2](GameObject* currObject)
+    {
+        return glm::distance2(currObject->mTransform.GetPosition2(), center) > radius2;
+    });
+    outputObjects.erase(outsideRadius, outputObjects.end());
+}
+
+void GameObjectsManager::RefreshObjectGridCell(GameObject* object)
+{
+    debug_assert(object);
+
+    // object is not registered or already destroyed
+    if (object->mGridCellIndex == -1)
+        return;
+
+    int cellIndex = GetGridCellIndex(object->mTransform.mPosition);
+    if (cellIndex == object->mGridCellIndex)
+        return;
+
+    mGridCells[object->mGridCellIndex].remove(&object->mGridCellNode);
+    mGridCells[cellIndex].insert(&object->mGridCellNode);
+    object->mGridCellIndex = cellIndex;
+}
+
+void GameObjectsManager::InsertObjectToGrid(GameObject* object)
+{
+    debug_assert(object->mGridCellIndex == -1);
+
+    int cellIndex = GetGridCellIndex(object->mTransform.mPosition);
+    mGridCells[cellIndex].insert(&object->mGridCellNode);
+    object->mGridCellIndex = cellIndex;
+
+    // objects get into grid once they are created
+    object->mCreationIndex = ++mCreationCounter;
+}
+
+void GameObjectsManager::RemoveObjectFromGrid(GameObject* object)
+{
+    if (object->mGridCellIndex == -1)
+        return;
+
+    mGridCells[object->mGridCellIndex].remove(&object->mGridCellNode);
+    object->mGridCellIndex = -1;
+}
+
+int GameObjectsManager::GetGridCellIndex(const glm::vec3& position) const
+{
+    const float cellLength = Convert::MapUnitsToMeters(GAMEOBJECTS_GRID_CELL_SIZE * 1.0f);
+
+    // objects outside of map are stored in border cells
+    int cellX = glm::clamp((int) std::floor(position.x / cellLength), 0, GAMEOBJECTS_GRID_DIMENSIONS - 1);
+    int cellY = glm::clamp((int) std::floor(position.z / cellLength), 0, GAMEOBJECTS_GRID_DIMENSIONS - 1);
+    return cellY * GAMEOBJECTS_GRID_DIMENSIONS + cellX;
+}
+
 bool GameObjectsManager::CreateStartupObjects()
 {
     debug_assert(gGameMap.IsLoaded());
@@ -67,14 +67,34 @@ public:
     // @param object: Object to destroy
     void DestroyGameObject(GameObject* object);
 
+    // Find gameobjects which positions are within specified area, results are appended to output list
+    // @param area: Real world area
+    // @param center, radius: Real world circle
+    // @param classMask: Gameobject classes to include
+    // @param outputObjects: Output objects list
+    void QueryObjectsInRect(const cxx::aabbox2d_t& area, GameObjectClassMask classMask, std::vector<GameObject*>& outputObjects) const;
+    // Order query results same way as objects are stored in mAllObjects
+    void SortObjectsInCreationOrder(std::vector<GameObject*>& objects) const;
+    void QueryObjectsInRadius(const glm::vec2& center, float radius, GameObjectClassMask classMask, std::vector<GameObject*>& outputObjects) const;
+
+    // Update gameobject location in spatial grid, invoked internally on transform changes
+    // @param object: Object which was moved
+    void RefreshObjectGridCell(GameObject* object);
+
 private:
     bool CreateStartupObjects();
     void DestroyAllObjects();
     void DestroyMarkedForDeletionObjects();
     GameObjectID GenerateUniqueID();
 
+    // spatial grid
+    void InsertObjectToGrid(GameObject* object);
+    void RemoveObjectFromGrid(GameObject* object);
+    int GetGridCellIndex(const glm::vec3& position) const;
+
 private:
     GameObjectID mIDsCounter = 0;
+    unsigned int mCreationCounter = 0;
 
     // objects pools
     cxx::object_pool<Pedestrian> mPedestriansPool;
@@ -83,6 +103,9 @@ private:
     cxx::object_pool<Decoration> mDecorationsPool;
     cxx::object_pool<Obstacle> mObstaclesPool;
     cxx::object_pool<Explosion> mExplosionsPool;
+
+    // objects lists by map area, each cell covers GAMEOBJECTS_GRID_CELL_SIZE x GAMEOBJECTS_GRID_CELL_SIZE blocks
+    cxx::intrusive_list<GameObject> mGridCells[GAMEOBJECTS_GRID_DIMENSIONS * GAMEOBJECTS_GRID_DIMENSIONS];
 };
 
 extern GameObjectsManager gGameObjectsManager;
\ No newline at end of file
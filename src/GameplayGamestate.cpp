@@ -10,6 +10,24 @@
 #include "ParticleEffectsManager.h"
 #include "TrafficManager.h"
 #include "AiManager.h"
+#include "GameObjectsManager.h"
+#include "BroadcastEventsManager.h"
+#include "cvars.h"
+
+CvarBoolean gCvarGameSerialUpdate("g_serialUpdate", false, "Update gameplay subsystems one after another on main thread", CvarFlags_None);
+
+// resources accessed by gameplay update stages
+enum : TaskResourceBits
+{
+    GameplayResource_BlocksTable = BIT(0), // animated blocks indices
+    GameplayResource_Physics = BIT(1),
+    GameplayResource_GameObjects = BIT(2), // including game randomizer
+    GameplayResource_BroadcastEvents = BIT(3),
+    GameplayResource_Particles = BIT(4),
+    GameplayResource_GameMap = BIT(5),
+    GameplayResource_Cameras = BIT(6), // including player views and hud
+    GameplayResource_Audio = BIT(7), // audio device calls, sound emitters and listeners
+};
 
 void GameplayGamestate::OnGamestateEnter()
 {
@@ -23,17 +41,56 @@ void GameplayGamestate::OnGamestateLeave()
 
 void GameplayGamestate::OnGamestateFrame()
 {
-    float deltaTime = gTimeManager.mGameFrameDelta;
     gCarnageGame.ProcessDebugCvars();
     // advance game state
-    gSpriteManager.UpdateBlocksAnimations(deltaTime);
-    gPhysics.UpdateFrame();
-    gGameObjectsManager.UpdateFrame();
-    gWeatherManager.UpdateFrame();
-    gParticleManager.UpdateFrame();
-    gTrafficManager.UpdateFrame();
-    gAiManager.UpdateFrame();
-    gBroadcastEvents.UpdateFrame();
+    if (mUpdateTasks.IsEmpty())
+    {
+        SetupUpdateTasks();
+    }
+    mUpdateTasks.Execute(gCvarGameSerialUpdate.mValue);
+}
+
+void GameplayGamestate::SetupUpdateTasks()
+{
+    // declaration order matches serial update order
+    mUpdateTasks.AddTask("Blocks animations", 0, GameplayResource_BlocksTable, []()
+    {
+        gSpriteManager.UpdateBlocksAnimations(gTimeManager.mGameFrameDelta);
+    });
+    // contact listeners affect objects, broadcast events and car sparks
+    mUpdateTasks.AddTask("Physics", GameplayResource_GameMap, 
+        GameplayResource_Physics | GameplayResource_GameObjects | GameplayResource_BroadcastEvents | GameplayResource_Particles | GameplayResource_Audio, []()
+    {
+        gPhysics.UpdateFrame();
+    });
+    // human players update their views, so cameras are modified
+    mUpdateTasks.AddTask("Game objects", GameplayResource_GameMap, 
+        GameplayResource_Physics | GameplayResource_GameObjects | GameplayResource_BroadcastEvents | GameplayResource_Cameras | GameplayResource_Audio, []()
+    {
+        gGameObjectsManager.UpdateFrame();
+    });
+    mUpdateTasks.AddTask("Weather", GameplayResource_Cameras, GameplayResource_Particles, []()
+    {
+        gWeatherManager.UpdateFrame();
+    });
+    mUpdateTasks.AddTask("Particles", GameplayResource_GameMap, GameplayResource_Particles, []()
+    {
+        gParticleManager.UpdateFrame();
+    });
+    mUpdateTasks.AddTask("Traffic", GameplayResource_GameMap | GameplayResource_Cameras, 
+        GameplayResource_Physics | GameplayResource_GameObjects | GameplayResource_BroadcastEvents | GameplayResource_Audio, []()
+    {
+        gTrafficManager.UpdateFrame();
+    });
+    mUpdateTasks.AddTask("Ai", GameplayResource_GameMap, 
+        GameplayResource_Physics | GameplayResource_GameObjects | GameplayResource_BroadcastEvents | GameplayResource_Audio, []()
+    {
+        gAiManager.UpdateFrame();
+    });
+    mUpdateTasks.AddTask("Broadcast events", GameplayResource_GameObjects, GameplayResource_BroadcastEvents, []()
+    {
+        gBroadcastEvents.UpdateFrame();
+    });
 }
 
 void GameplayGamestate::OnGamestateInputEvent(KeyInputEvent& inputEvent)
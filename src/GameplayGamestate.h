@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GenericGamestate.h"
+#include "TaskGraph.h"
 
 // Main game
 class GameplayGamestate: public GenericGamestate
@@ -24,4 +25,10 @@ public:
 private:
     void OnHumanPlayerDie(int playerIndex);
     void OnHumanPlayerStartDriveCar(int playerIndex);
+
+    // declare gameplay subsystems update stages and resources they access
+    void SetupUpdateTasks();
+
+private:
+    TaskGraph mUpdateTasks;
 };
\ No newline at end of file
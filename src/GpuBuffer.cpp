@@ -131,26 +131,30 @@ bool GpuBuffer::Resize(unsigned int newLength)
     GLenum bufferTargetGL = EnumToGL(mContent);
     GLenum bufferUsageGL = EnumToGL(mUsageHint);
 
-    // generate new buffer object and do setup params
+    // generate new buffer object and do setup params,
+    // copy targets are used so that array and element array bindings stay untouched,
+    // element array binding is part of vertex array object state
     GLuint newVBO;
     ::glGenBuffers(1, &newVBO);
     glCheckError();
-    ::glBindBuffer(bufferTargetGL, newVBO);
+    ::glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
     glCheckError();
-    ::glBufferData(bufferTargetGL, newBufferCapacity, nullptr, bufferUsageGL);
+    ::glBufferData(GL_COPY_WRITE_BUFFER, newBufferCapacity, nullptr, bufferUsageGL);
     glCheckError();
 
-    // bind source and destination buffers and do copy data
+    // bind source buffer and do copy data
     ::glBindBuffer(GL_COPY_READ_BUFFER, mResourceHandle);
     glCheckError();
-    ::glCopyBufferSubData(GL_COPY_READ_BUFFER, bufferTargetGL, 0, 0, mBufferCapacity);
+    ::glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, mBufferCapacity);
     glCheckError();
 
     // unbind source and destination buffers
     ::glBindBuffer(GL_COPY_READ_BUFFER, 0);
     glCheckError();
+    ::glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glCheckError();
 
-    // destroy old buffer
+    // destroy old buffer, if it was bound to its target then binding reverts to zero
     ::glDeleteBuffers(1, &mResourceHandle);
     glCheckError();
 
@@ -159,10 +163,10 @@ bool GpuBuffer::Resize(unsigned int newLength)
     mBufferLength = newLength;
     mResourceHandle = newVBO;
 
-    // restore state
-    if (!wasBound)
+    // restore state, binding cache still points to this buffer
+    if (wasBound)
     {
-        ::glBindBuffer(bufferTargetGL, 0);
+        ::glBindBuffer(bufferTargetGL, mResourceHandle);
         glCheckError();
     }
 
@@ -178,7 +182,7 @@ bool GpuBuffer::SubData(unsigned int dataOffset, unsigned int dataLength, const
     }
 
     debug_assert(dataLength && dataSource);
-    debug_assert(dataOffset + dataLength < mBufferCapacity);
+    debug_assert(dataOffset + dataLength <= mBufferCapacity);
 
     ScopedBufferBinder scopedBind (mGraphicsContext, this);
     GLenum bufferTargetGL = EnumToGL(mContent);
@@ -189,12 +193,20 @@ bool GpuBuffer::SubData(unsigned int dataOffset, unsigned int dataLength, const
 }
 
 void* GpuBuffer::Lock(BufferAccessBits accessBits)
+{
+    return Lock(0, mBufferLength, accessBits);
+}
+
+void* GpuBuffer::Lock(unsigned int dataOffset, unsigned int dataLength, BufferAccessBits accessBits)
 {
     if (!IsBufferInited())
     {
         debug_assert(false);
         return nullptr;
     }
+
+    debug_assert(dataLength > 0);
+    debug_assert(dataOffset + dataLength <= mBufferCapacity);
 
     ScopedBufferBinder scopedBind (mGraphicsContext, this);
     GLenum bufferTargetGL = EnumToGL(mContent);
@@ -206,7 +218,9 @@ void* GpuBuffer::Lock(BufferAccessBits accessBits)
         debug_assert(false); // reading is not supported
         return nullptr;
     }
-    pMappedData = ::glMapBufferRange(bufferTargetGL, 0, mBufferLength, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    GLbitfield accessBitsGL = GL_MAP_WRITE_BIT |
+        ((accessBits & BufferAccess_InvalidateBuffer) > 0 ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_INVALIDATE_RANGE_BIT);
+    pMappedData = ::glMapBufferRange(bufferTargetGL, dataOffset, dataLength, accessBitsGL);
 
 #else
     GLbitfield accessBitsGL = ((accessBits & BufferAccess_Read) > 0 ? GL_MAP_READ_BIT : 0) |
@@ -216,7 +230,7 @@ void* GpuBuffer::Lock(BufferAccessBits accessBits)
         ((accessBits & BufferAccess_InvalidateBuffer) > 0 ? GL_MAP_INVALIDATE_BUFFER_BIT : 0);
 
     debug_assert(accessBitsGL > 0);
-    pMappedData = ::glMapBufferRange(bufferTargetGL, 0, mBufferLength, accessBitsGL);
+    pMappedData = ::glMapBufferRange(bufferTargetGL, dataOffset, dataLength, accessBitsGL);
 
 #endif
     glCheckError();
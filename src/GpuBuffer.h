@@ -40,12 +40,25 @@ public:
     // @return Pointer to buffer data or null on fail
     void* Lock(BufferAccessBits accessBits);
 
+    // Map range of hardware buffer content to process memory
+    // @param dataOffset: Offset within buffer in bytes
+    // @param dataLength: Size of mapped range in bytes
+    // @param accessBits: Desired data access policy
+    // @return Pointer to range data or null on fail
+    void* Lock(unsigned int dataOffset, unsigned int dataLength, BufferAccessBits accessBits);
+
     template<typename TElement>
     inline TElement* LockData(BufferAccessBits accessBits)
     {
         return static_cast<TElement*>(Lock(accessBits));
     }
 
+    template<typename TElement>
+    inline TElement* LockData(unsigned int dataOffset, unsigned int dataLength, BufferAccessBits accessBits)
+    {
+        return static_cast<TElement*>(Lock(dataOffset, dataLength, accessBits));
+    }
+
     // Unmap buffer object data source
     // @return false on fail, indicates that buffer should be reload
     bool Unlock();
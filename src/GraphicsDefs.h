@@ -433,6 +433,7 @@ public:
     SingleAttribute mAttributes[eVertexAttribute_COUNT];
     unsigned int mDataStride = 0; // common to all attributes
     unsigned int mBaseOffset = 0; // additional offset in bytes within source vertex buffer, affects on all attribues
+    bool mInstanced = false; // attributes are advanced once per instance instead of once per vertex
 };
 
 // standard engine vertex definition
@@ -553,6 +554,8 @@ enum eRenderUniform
     eRenderUniform_NormalMatrix,         
     eRenderUniform_CameraPosition, // world space camera position
     eRenderUniform_EnableBiLinearFiltering,
+    eRenderUniform_SpritesDepthAxis, // 0 for y axis, 1 for z axis
+    eRenderUniform_ViewportSize, // in pixels
     eRenderUniform_COUNT
 };
 
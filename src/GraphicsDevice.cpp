@@ -6,6 +6,7 @@
 #include "GpuTexture2D.h"
 #include "GpuTextureArray2D.h"
 #include "cvars.h"
+#include "FrameProfiler.h"
 
 GraphicsDevice gGraphicsDevice;
 
@@ -749,8 +750,25 @@ void GraphicsDevice::RenderPrimitives(ePrimitiveType primitiveType, unsigned int
     glCheckError();
 }
 
+void GraphicsDevice::RenderPrimitivesInstanced(ePrimitiveType primitiveType, unsigned int firstIndex, unsigned int numElements, unsigned int numInstances)
+{
+    if (!IsDeviceInited())
+    {
+        debug_assert(false);
+        return;
+    }
+
+    GpuBuffer* vertexBuffer = mGraphicsContext.mCurrentBuffers[eBufferContent_Vertices];
+    debug_assert(vertexBuffer && mGraphicsContext.mCurrentProgram);
+
+    GLenum primitives = EnumToGL(primitiveType);
+    ::glDrawArraysInstanced(primitives, firstIndex, numElements, numInstances);
+    glCheckError();
+}
+
 void GraphicsDevice::Present()
 {
+    PROFILE_SCOPE("Present");
     if (!IsDeviceInited())
     {
         debug_assert(false);
@@ -958,6 +976,9 @@ void GraphicsDevice::SetupVertexAttributes(const VertexFormat& streamDefinition)
                 streamDefinition.mDataStride, BUFFER_OFFSET(attribute.mDataOffset + streamDefinition.mBaseOffset));
         }
         glCheckError();
+
+        ::glVertexAttribDivisor(currentProgram->mAttributes[iattribute], streamDefinition.mInstanced ? 1 : 0);
+        glCheckError();
     }
 }
 
@@ -122,6 +122,13 @@ public:
     // @param numElements: Number of elements to render
     void RenderPrimitives(ePrimitiveType primitiveType, unsigned int firstIndex, unsigned int numElements);
 
+    // Render multiple instances of geometry, per instance attributes must be bound with instanced vertex format
+    // @param primitiveType: Type of primitives to render
+    // @param firstIndex: Start position in attribute buffers, index
+    // @param numElements: Number of elements to render per instance
+    // @param numInstances: Number of instances to render
+    void RenderPrimitivesInstanced(ePrimitiveType primitiveType, unsigned int firstIndex, unsigned int numElements, unsigned int numInstances);
+
     // Finish render frame, prenent on screen
     void Present();
 
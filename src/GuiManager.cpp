@@ -8,6 +8,7 @@
 #include "CarnageGame.h"
 #include "ImGuiManager.h"
 #include "FontManager.h"
+#include "FrameProfiler.h"
 
 GuiManager gGuiManager;
 
@@ -34,6 +35,7 @@ void GuiManager::Deinit()
 
 void GuiManager::RenderFrame()
 {
+    PROFILE_SCOPE("Gui draw");
     mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Z, eSpritesSortMode_None);
 
     Rect prevScreenRect = gGraphicsDevice.mViewportRect;
@@ -44,7 +46,8 @@ void GuiManager::RenderFrame()
         gGraphicsDevice.BindTexture(eTextureUnit_3, gSpriteManager.mPalettesTable);
         gGraphicsDevice.BindTexture(eTextureUnit_2, gSpriteManager.mPaletteIndicesTable);
 
-        gRenderManager.mSpritesProgram.Activate();
+        RenderProgram& spritesProgram = gRenderManager.GetSpritesProgram();
+        spritesProgram.Activate();
 
         RenderStates guiRenderStates = RenderStates()
             .Disable(RenderStateFlags_FaceCulling)
@@ -63,14 +66,14 @@ void GuiManager::RenderFrame()
             gGraphicsDevice.SetViewportRect(mCamera2D.mViewportRect);
             gGraphicsDevice.SetScissorRect(mCamera2D.mViewportRect);
 
-            gRenderManager.mSpritesProgram.UploadCameraTransformMatrices(mCamera2D);
+            spritesProgram.UploadCameraTransformMatrices(mCamera2D);
 
             GuiContext uiContext ( mCamera2D, mSpriteBatch );
             currPlayer->mPlayerView.mHUD.DrawFrame(uiContext);
             mSpriteBatch.Flush();
         }
 
-        gRenderManager.mSpritesProgram.Deactivate();
+        spritesProgram.Deactivate();
     }
 
     { // draw imgui
@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "HumanPlayerView.h"
+#include "cvars.h"
 
 void HumanPlayerView::UpdateFrame()
 {
@@ -9,7 +10,10 @@ void HumanPlayerView::UpdateFrame()
     }
 
     mOnScreenArea = mCamera.ComputeViewBounds2();
-    mHUD.UpdateFrame();
+    if (!gCvarSysHeadless.mValue)
+    {
+        mHUD.UpdateFrame();
+    }
 }
 
 void HumanPlayerView::InputEvent(KeyInputEvent& inputEvent)
@@ -3,6 +3,7 @@
 #include "RenderingManager.h"
 #include "DebugWindow.h"
 #include "TimeManager.h"
+#include "FrameProfiler.h"
 
 ImGuiManager gImGuiManager;
 
@@ -85,6 +86,7 @@ void ImGuiManager::Deinit()
  
 void ImGuiManager::RenderFrame()
 {
+    PROFILE_SCOPE("Debug ui draw");
     ImGui::EndFrame();
     ImGui::Render();
 
@@ -138,7 +140,7 @@ void ImGuiManager::RenderFrame()
             gGraphicsDevice.BindTexture(eTextureUnit_0, bindTexture);
 
             gGraphicsDevice.SetScissorRect(rcClip);
-            unsigned int idxBufferOffset = Sizeof_ImGuiIndex * pcmd->IdxOffset;
+            unsigned int idxBufferOffset = mTrimeshBuffer.mIndicesOffset + Sizeof_ImGuiIndex * pcmd->IdxOffset;
 
             eIndicesType indicesType = Sizeof_ImGuiIndex == 2 ? eIndicesType_i16 : eIndicesType_i32;
             gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, indicesType, idxBufferOffset, pcmd->ElemCount);
@@ -148,6 +150,7 @@ void ImGuiManager::RenderFrame()
 
 void ImGuiManager::UpdateFrame()
 {
+    PROFILE_SCOPE("Debug ui");
     ImGuiIO& io = ImGui::GetIO();
 
     io.DeltaTime = (float) gTimeManager.mUiFrameDelta;   // set the time elapsed since the previous frame (in seconds)
@@ -0,0 +1,140 @@
+#include "stdafx.h"
+#include "JobsManager.h"
+#include "cvars.h"
+
+CvarInt gCvarSysWorkerThreads("sys_workerThreads", -1, "Number of worker threads, -1 to detect automatically", CvarFlags_Archive | CvarFlags_Init);
+
+JobsManager gJobsManager;
+
+bool JobsManager::Initialize()
+{
+    int workersCount = gCvarSysWorkerThreads.mValue;
+    if (workersCount < 0)
+    {
+        // main thread is working too
+        workersCount = (int) std::thread::hardware_concurrency() - 1;
+    }
+
+#ifdef __EMSCRIPTEN__
+    workersCount = 0;
+#endif
+
+    workersCount = glm::clamp(workersCount, 0, 16);
+    gConsole.LogMessage(eLogMessage_Info, "Worker threads count: %d", workersCount);
+
+    mShutdownRequested = false;
+    for (int icurr = 0; icurr < workersCount; ++icurr)
+    {
+        mWorkerThreads.emplace_back(&JobsManager::WorkerThreadProc, this);
+    }
+    return true;
+}
+
+void JobsManager::Deinit()
+{
+    {
+        std::lock_guard<std::mutex> lock(mJobsMutex);
+        mShutdownRequested = true;
+    }
+    mJobsCondition.notify_all();
+
+    for (std::thread& currThread: mWorkerThreads)
+    {
+        currThread.join();
+    }
+    mWorkerThreads.clear();
+    debug_assert(mJobsQueue.empty());
+}
+
+void JobsManager::ParallelFor(int jobsCount, const std::function<void(int jobIndex)>& jobFunction)
+{
+    if (jobsCount < 1)
+        return;
+
+    int runnersCount = std::min((int) mWorkerThreads.size(), jobsCount - 1);
+    if (runnersCount < 1)
+    {
+        for (int ijob = 0; ijob < jobsCount; ++ijob)
+        {
+            jobFunction(ijob);
+        }
+        return;
+    }
+
+    // each runner picks next job index until all jobs are taken
+    std::atomic<int> nextJobIndex { 0 };
+    std::atomic<int> activeRunners { runnersCount };
+    auto ExecuteJobs = [&nextJobIndex, &jobFunction, jobsCount]()
+    {
+        for (int ijob = nextJobIndex++; ijob < jobsCount; ijob = nextJobIndex++)
+        {
+            jobFunction(ijob);
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mJobsMutex);
+        for (int icurr = 0; icurr < runnersCount; ++icurr)
+        {
+            mJobsQueue.push_back([&ExecuteJobs, &activeRunners]()
+            {
+                ExecuteJobs();
+                --activeRunners;
+            });
+        }
+    }
+    mJobsCondition.notify_all();
+
+    ExecuteJobs();
+
+    // help with queued jobs while waiting for completion, this allows nested calls from workers
+    while (activeRunners > 0)
+    {
+        if (!ExecuteQueuedJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+int JobsManager::GetWorkersCount() const
+{
+    return (int) mWorkerThreads.size();
+}
+
+void JobsManager::WorkerThreadProc()
+{
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mJobsMutex);
+            mJobsCondition.wait(lock, [this]()
+            {
+                return mShutdownRequested || !mJobsQueue.empty();
+            });
+
+            if (mJobsQueue.empty()) // shutdown
+                return;
+
+            job = std::move(mJobsQueue.front());
+            mJobsQueue.pop_front();
+        }
+        job();
+    }
+}
+
+bool JobsManager::ExecuteQueuedJob()
+{
+    std::function<void()> job;
+    {
+        std::lock_guard<std::mutex> lock(mJobsMutex);
+        if (mJobsQueue.empty())
+            return false;
+
+        job = std::move(mJobsQueue.front());
+        mJobsQueue.pop_front();
+    }
+    job();
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+// Simple pool of worker threads to execute independent jobs
+class JobsManager final: public cxx::noncopyable
+{
+public:
+    bool Initialize();
+    void Deinit();
+
+    // Execute job for each index in range [0, jobsCount) on worker threads and calling thread,
+    // blocks until all jobs are completed
+    // @param jobsCount: Number of jobs
+    // @param jobFunction: Job function, receives job index
+    void ParallelFor(int jobsCount, const std::function<void(int jobIndex)>& jobFunction);
+
+    int GetWorkersCount() const;
+
+private:
+    void WorkerThreadProc();
+    bool ExecuteQueuedJob();
+
+private:
+    std::vector<std::thread> mWorkerThreads;
+    std::mutex mJobsMutex;
+    std::condition_variable mJobsCondition;
+    std::deque<std::function<void()>> mJobsQueue;
+    bool mShutdownRequested = false;
+};
+
+extern JobsManager gJobsManager;
\ No newline at end of file
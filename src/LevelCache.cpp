@@ -0,0 +1,237 @@
+#include "stdafx.h"
+#include "LevelCache.h"
+#include "GameMapManager.h"
+#include "MapRenderer.h"
+#include "cvars.h"
+
+LevelCache gLevelCache;
+
+// should be incremented whenever cached data layout or map mesh generation changes
+const unsigned int LevelCacheVersion = 1;
+const unsigned int LevelCacheSignature = 0x4C564331; // LVC1
+
+struct LevelCacheHeader
+{
+    unsigned int mSignature;
+    unsigned int mVersion;
+    unsigned long long mSourceKey;
+    unsigned int mMapTilesCount;
+    unsigned int mChunksCount;
+    unsigned int mBlockTextureLayersLength;
+};
+
+// FNV-1a
+inline unsigned long long ComputeDataHash(const void* data, size_t dataLength, unsigned long long hashValue = 14695981039346656037ULL)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t ibyte = 0; ibyte < dataLength; ++ibyte)
+    {
+        hashValue = (hashValue ^ bytes[ibyte]) * 1099511628211ULL;
+    }
+    return hashValue;
+}
+
+bool LevelCache::LoadFromFile(const std::string& mapName, unsigned long long sourceKey)
+{
+    Clear();
+
+    MappedFile mappedFile;
+    if (!mappedFile.Open(GetCacheFilePath(mapName)))
+        return false;
+
+    cxx::memory_reader file(mappedFile.mData, mappedFile.mDataLength);
+
+    LevelCacheHeader header;
+    if (!cxx::read_from_stream(file, header) || header.mSignature != LevelCacheSignature || header.mVersion != LevelCacheVersion)
+    {
+        gConsole.LogMessage(eLogMessage_Info, "Level cache for '%s' is outdated", mapName.c_str());
+        return false;
+    }
+
+    if (header.mSourceKey != sourceKey)
+    {
+        gConsole.LogMessage(eLogMessage_Info, "Level cache for '%s' does not match source files", mapName.c_str());
+        return false;
+    }
+
+    // counts are checked before allocating memory, so broken file can't cause huge allocations
+    bool isSuccess = 
+        (header.mMapTilesCount == (MAP_LAYERS_COUNT * MAP_DIMENSIONS * MAP_DIMENSIONS)) &&
+        (header.mChunksCount == (unsigned int) MapRenderer::GetMapChunksCount()) &&
+        (header.mBlockTextureLayersLength % MAP_BLOCK_TEXTURE_AREA) == 0 &&
+        (header.mBlockTextureLayersLength <= file.get_remaining_length());
+
+    if (isSuccess)
+    {
+        mMapTiles.resize(header.mMapTilesCount);
+        mChunksMeshData.resize(header.mChunksCount);
+        isSuccess = file.read(mMapTiles.data(), mMapTiles.size() * Sizeof_BlockInfo);
+    }
+
+    for (CityMeshData& currChunk: mChunksMeshData)
+    {
+        unsigned int verticesCount = 0;
+        unsigned int indicesCount = 0;
+        if (!isSuccess || !cxx::read_from_stream(file, verticesCount) || !cxx::read_from_stream(file, indicesCount))
+        {
+            isSuccess = false;
+            break;
+        }
+
+        unsigned long long chunkDataLength = 
+            (unsigned long long) verticesCount * Sizeof_CityVertex3D + 
+            (unsigned long long) indicesCount * Sizeof_DrawIndex;
+        if (chunkDataLength > file.get_remaining_length())
+        {
+            isSuccess = false;
+            break;
+        }
+
+        currChunk.mBlocksVertices.resize(verticesCount);
+        currChunk.mBlocksIndices.resize(indicesCount);
+        isSuccess = file.read(currChunk.mBlocksVertices.data(), verticesCount * Sizeof_CityVertex3D) &&
+            file.read(currChunk.mBlocksIndices.data(), indicesCount * Sizeof_DrawIndex);
+    }
+
+    if (isSuccess && header.mBlockTextureLayersLength <= file.get_remaining_length())
+    {
+        mBlockTextureLayers.resize(header.mBlockTextureLayersLength);
+        isSuccess = file.read(mBlockTextureLayers.data(), mBlockTextureLayers.size());
+    }
+    else
+    {
+        isSuccess = false;
+    }
+
+    if (!isSuccess)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Level cache for '%s' is corrupted", mapName.c_str());
+        Clear();
+        return false;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Using level cache for '%s'", mapName.c_str());
+    return true;
+}
+
+bool LevelCache::SaveToFile(const std::string& mapName, unsigned long long sourceKey, const std::vector<CityMeshData>& chunksMeshData)
+{
+    debug_assert(gGameMap.IsLoaded());
+
+    std::vector<MapBlockInfo> mapTiles;
+    gGameMap.GetMapTiles(mapTiles);
+
+    // layers are kept for gpu upload
+    if (!HasBlockTextureLayers())
+    {
+        gGameMap.mStyleData.GetBlockTextureLayers(mBlockTextureLayers);
+    }
+
+    std::string filePath = GetCacheFilePath(mapName);
+    cxx::ensure_path_exists(cxx::get_parent_directory(filePath));
+
+    // data is written to temporary file first, so interrupted write never leaves broken cache
+    std::string tempFilePath = filePath + ".tmp";
+
+    std::ofstream outputFile(tempFilePath, std::ios::out | std::ios::binary);
+    if (!outputFile.is_open())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot create level cache file '%s'", tempFilePath.c_str());
+        return false;
+    }
+
+    LevelCacheHeader header;
+    header.mSignature = LevelCacheSignature;
+    header.mVersion = LevelCacheVersion;
+    header.mSourceKey = sourceKey;
+    header.mMapTilesCount = mapTiles.size();
+    header.mChunksCount = chunksMeshData.size();
+    header.mBlockTextureLayersLength = mBlockTextureLayers.size();
+
+    outputFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outputFile.write(reinterpret_cast<const char*>(mapTiles.data()), mapTiles.size() * Sizeof_BlockInfo);
+    for (const CityMeshData& currChunk: chunksMeshData)
+    {
+        unsigned int verticesCount = currChunk.mBlocksVertices.size();
+        unsigned int indicesCount = currChunk.mBlocksIndices.size();
+        outputFile.write(reinterpret_cast<const char*>(&verticesCount), sizeof(verticesCount));
+        outputFile.write(reinterpret_cast<const char*>(&indicesCount), sizeof(indicesCount));
+        outputFile.write(reinterpret_cast<const char*>(currChunk.mBlocksVertices.data()), verticesCount * Sizeof_CityVertex3D);
+        outputFile.write(reinterpret_cast<const char*>(currChunk.mBlocksIndices.data()), indicesCount * Sizeof_DrawIndex);
+    }
+    outputFile.write(reinterpret_cast<const char*>(mBlockTextureLayers.data()), mBlockTextureLayers.size());
+    outputFile.close();
+
+    if (!outputFile)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot write level cache file '%s'", tempFilePath.c_str());
+        std::remove(tempFilePath.c_str());
+        return false;
+    }
+
+    // rename does not replace existing file on all platforms
+    std::remove(filePath.c_str());
+    if (std::rename(tempFilePath.c_str(), filePath.c_str()) != 0)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot write level cache file '%s'", filePath.c_str());
+        std::remove(tempFilePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void LevelCache::Clear()
+{
+    mMapTiles.clear();
+    mMapTiles.shrink_to_fit();
+    mChunksMeshData.clear();
+    mChunksMeshData.shrink_to_fit();
+    mBlockTextureLayers.clear();
+    mBlockTextureLayers.shrink_to_fit();
+}
+
+bool LevelCache::HasMapTiles() const
+{
+    return mMapTiles.size() == (MAP_LAYERS_COUNT * MAP_DIMENSIONS * MAP_DIMENSIONS);
+}
+
+bool LevelCache::HasBlockTextureLayers() const
+{
+    return !mBlockTextureLayers.empty();
+}
+
+bool LevelCache::ComputeSourceKey(const std::string& mapName, unsigned long long& sourceKey) const
+{
+    std::string styleName;
+    if (!gGameMap.GetMapStyleFileName(mapName, styleName))
+        return false;
+
+    MappedFile mapFile;
+    MappedFile styleFile;
+    if (!gFiles.OpenMappedFile(mapName, mapFile) || !gFiles.OpenMappedFile(styleName, styleFile))
+        return false;
+
+    // binary layout of cached structures depends on build
+    const unsigned int layoutInfo[] =
+    {
+        LevelCacheVersion,
+        (unsigned int) gCvarGameVersion.mValue,
+        Sizeof_BlockInfo,
+        Sizeof_CityVertex3D,
+        Sizeof_DrawIndex,
+    };
+
+    sourceKey = ComputeDataHash(layoutInfo, sizeof(layoutInfo));
+    sourceKey = ComputeDataHash(mapFile.mData, mapFile.mDataLength, sourceKey);
+    sourceKey = ComputeDataHash(styleFile.mData, styleFile.mDataLength, sourceKey);
+    return true;
+}
+
+std::string LevelCache::GetCacheFilePath(const std::string& mapName) const
+{
+    std::string cacheName = cxx::get_name_without_extension(mapName);
+    if (gFiles.mWorkingDirectoryPath.empty())
+        return cxx::va("cache/%s.lvc", cacheName.c_str());
+
+    return cxx::va("%s/cache/%s.lvc", gFiles.mWorkingDirectoryPath.c_str(), cacheName.c_str());
+}
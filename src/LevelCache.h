@@ -0,0 +1,44 @@
+#pragma once
+
+#include "GameMapHelpers.h"
+
+// On-disk cache of decoded level data
+// Stores decompressed map grid, city mesh chunks and block textures in directly uploadable layout,
+// so repeated starts of same map skip map decompression, mesh generation and texture conversion
+class LevelCache final: public cxx::noncopyable
+{
+public:
+    // readonly
+    std::vector<MapBlockInfo> mMapTiles; // z, y, x
+    std::vector<CityMeshData> mChunksMeshData;
+    std::vector<unsigned char> mBlockTextureLayers; // palette indices of all block textures, layer by layer
+
+public:
+    // Hash source map and style files along with cached data layout, it is expensive so compute it once per load
+    // @param mapName: Map file name
+    // @param sourceKey: Output key
+    bool ComputeSourceKey(const std::string& mapName, unsigned long long& sourceKey) const;
+
+    // Load cached data for map, cache is rejected if source files or game version were changed
+    // @param mapName: Map file name
+    // @param sourceKey: Key of current source files, see ComputeSourceKey
+    // @returns false if there is no valid cache
+    bool LoadFromFile(const std::string& mapName, unsigned long long sourceKey);
+
+    // Write currently loaded level data to cache
+    // @param mapName: Map file name
+    // @param sourceKey: Key of current source files, see ComputeSourceKey
+    // @param chunksMeshData: Built city mesh chunks
+    bool SaveToFile(const std::string& mapName, unsigned long long sourceKey, const std::vector<CityMeshData>& chunksMeshData);
+
+    // Free cached data once it is consumed
+    void Clear();
+
+    bool HasMapTiles() const;
+    bool HasBlockTextureLayers() const;
+
+private:
+    std::string GetCacheFilePath(const std::string& mapName) const;
+};
+
+extern LevelCache gLevelCache;
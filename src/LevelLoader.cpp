@@ -0,0 +1,191 @@
+#include "stdafx.h"
+#include "LevelLoader.h"
+#include "GameMapManager.h"
+#include "AudioManager.h"
+#include "RenderingManager.h"
+#include "SpriteManager.h"
+#include "LevelCache.h"
+#include "cvars.h"
+
+CvarBoolean gCvarGameAsyncLevelLoading("g_asyncLevelLoading", true, "Load level data on background thread", CvarFlags_Archive);
+CvarBoolean gCvarGameLevelCache("g_levelCache", true, "Cache decoded level data on disk for faster startup", CvarFlags_Archive);
+
+LevelLoader gLevelLoader;
+
+LevelLoader::~LevelLoader()
+{
+    debug_assert(!mLoadingThread.joinable());
+}
+
+bool LevelLoader::StartLoading(const std::string& mapName)
+{
+    CancelLoading();
+
+    mMapName = mapName;
+    mCancelRequested = false;
+    mBackgroundStagesDone = false;
+    mBackgroundStagesSucceeded = false;
+
+    bool asyncLoading = gCvarGameAsyncLevelLoading.mValue && !gCvarSysHeadless.mValue;
+#ifdef __EMSCRIPTEN__
+    asyncLoading = false;
+#endif
+
+    SetLoadingStage(eLevelLoadingStage_MapData);
+    if (asyncLoading)
+    {
+        mLoadingThread = std::thread(&LevelLoader::BackgroundStagesProc, this);
+        return true;
+    }
+
+    BackgroundStagesProc();
+    while (IsLoading())
+    {
+        UpdateFrame();
+    }
+    return mLoadingStage == eLevelLoadingStage_Done;
+}
+
+void LevelLoader::CancelLoading()
+{
+    mCancelRequested = true;
+    if (mLoadingThread.joinable())
+    {
+        mLoadingThread.join();
+    }
+    gLevelCache.Clear();
+    mCancelRequested = false;
+    mLoadingStage = eLevelLoadingStage_Idle;
+    mNotifiedStage = eLevelLoadingStage_Idle;
+}
+
+void LevelLoader::UpdateFrame()
+{
+    // gpu resources are created on next frame after background stages, so progress gets a chance to be shown
+    if (mLoadingStage == eLevelLoadingStage_GpuResources)
+    {
+        SetLoadingStage(LoadGpuResources() ? eLevelLoadingStage_Done : eLevelLoadingStage_Failed);
+    }
+    else if (IsLoading() && mBackgroundStagesDone)
+    {
+        if (mLoadingThread.joinable())
+        {
+            mLoadingThread.join();
+        }
+        SetLoadingStage(mBackgroundStagesSucceeded ? eLevelLoadingStage_GpuResources : eLevelLoadingStage_Failed);
+    }
+    NotifyProgress();
+}
+
+void LevelLoader::SetProgressCallback(const LevelLoadingProgressCallback& progressCallback)
+{
+    mProgressCallback = progressCallback;
+    mNotifiedStage = eLevelLoadingStage_Idle;
+}
+
+eLevelLoadingStage LevelLoader::GetLoadingStage() const
+{
+    return mLoadingStage;
+}
+
+float LevelLoader::GetLoadingProgress() const
+{
+    eLevelLoadingStage loadingStage = mLoadingStage;
+    if (loadingStage == eLevelLoadingStage_Done)
+        return 1.0f;
+
+    if (!IsLoading())
+        return 0.0f;
+
+    // each stage counts equally
+    const int StagesCount = (eLevelLoadingStage_Done - eLevelLoadingStage_MapData);
+    return (float) (loadingStage - eLevelLoadingStage_MapData) / StagesCount;
+}
+
+bool LevelLoader::IsLoading() const
+{
+    eLevelLoadingStage loadingStage = mLoadingStage;
+    return (loadingStage >= eLevelLoadingStage_MapData) && (loadingStage <= eLevelLoadingStage_GpuResources);
+}
+
+void LevelLoader::BackgroundStagesProc()
+{
+    mBackgroundStagesSucceeded = LoadLevelData();
+    mBackgroundStagesDone = true;
+}
+
+bool LevelLoader::LoadLevelData()
+{
+    SetLoadingStage(eLevelLoadingStage_MapData);
+
+    // cached data includes city mesh, so it is not used in headless mode
+    unsigned long long levelCacheKey = 0;
+    bool useLevelCache = gCvarGameLevelCache.mValue && !gCvarSysHeadless.mValue &&
+        gLevelCache.ComputeSourceKey(mMapName, levelCacheKey);
+    bool hasLevelCache = useLevelCache && gLevelCache.LoadFromFile(mMapName, levelCacheKey);
+
+    if (!gGameMap.LoadFromFile(mMapName, gLevelCache.HasMapTiles() ? gLevelCache.mMapTiles.data() : nullptr))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot load map '%s'", mMapName.c_str());
+        return false;
+    }
+
+    if (mCancelRequested)
+        return false;
+
+    SetLoadingStage(eLevelLoadingStage_LevelSounds);
+    if (!gAudioManager.LoadLevelSoundArchives())
+    {
+        // ignore
+    }
+
+    if (mCancelRequested)
+        return false;
+
+    SetLoadingStage(eLevelLoadingStage_MapMesh);
+    if (!gCvarSysHeadless.mValue)
+    {
+        if (!hasLevelCache || !gRenderManager.mMapRenderer.SetMapMeshData(gLevelCache.mChunksMeshData))
+        {
+            gRenderManager.mMapRenderer.BuildMapMeshData();
+            if (useLevelCache && !mCancelRequested)
+            {
+                gLevelCache.SaveToFile(mMapName, levelCacheKey, gRenderManager.mMapRenderer.GetMapMeshData());
+            }
+        }
+    }
+    return !mCancelRequested;
+}
+
+bool LevelLoader::LoadGpuResources()
+{
+    gSpriteManager.Cleanup();
+    if (!gCvarSysHeadless.mValue)
+    {
+        gRenderManager.mMapRenderer.UploadMapMesh();
+    }
+    if (!gSpriteManager.InitLevelSprites())
+    {
+        debug_assert(false);
+    }
+    gLevelCache.Clear();
+    return true;
+}
+
+void LevelLoader::SetLoadingStage(eLevelLoadingStage loadingStage)
+{
+    mLoadingStage = loadingStage;
+}
+
+void LevelLoader::NotifyProgress()
+{
+    eLevelLoadingStage loadingStage = mLoadingStage;
+    if (loadingStage == mNotifiedStage)
+        return;
+
+    mNotifiedStage = loadingStage;
+    if (mProgressCallback)
+    {
+        mProgressCallback(loadingStage, GetLoadingProgress());
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+enum eLevelLoadingStage
+{
+    eLevelLoadingStage_Idle,
+    eLevelLoadingStage_MapData, // map and style data parsing, worker thread
+    eLevelLoadingStage_LevelSounds, // sound archives, worker thread
+    eLevelLoadingStage_MapMesh, // city mesh generation, worker thread
+    eLevelLoadingStage_GpuResources, // textures and buffers upload, main thread
+    eLevelLoadingStage_Done,
+    eLevelLoadingStage_Failed,
+    eLevelLoadingStage_COUNT
+};
+
+decl_enum_strings(eLevelLoadingStage);
+
+// Loading progress notification, always invoked on main thread
+// @param loadingStage: Current loading stage
+// @param loadingProgress: Overall progress in range [0, 1]
+using LevelLoadingProgressCallback = std::function<void(eLevelLoadingStage loadingStage, float loadingProgress)>;
+
+// Staged level loader
+// File parsing and cpu side data generation is done on background thread, gpu resources are created on main thread
+class LevelLoader final: public cxx::noncopyable
+{
+public:
+    ~LevelLoader();
+
+    // Start loading level data, previous level must be unloaded
+    // Loading is done synchronously when async loading is disabled or not supported
+    // @param mapName: Map file name
+    // @returns false on error
+    bool StartLoading(const std::string& mapName);
+
+    // Wait for background stage and reset state, loaded data is not freed
+    void CancelLoading();
+
+    // Process main thread stages, should be called each frame while loading
+    void UpdateFrame();
+
+    // Set or reset loading progress notification
+    void SetProgressCallback(const LevelLoadingProgressCallback& progressCallback);
+
+    // Get current loading state
+    eLevelLoadingStage GetLoadingStage() const;
+    float GetLoadingProgress() const;
+    bool IsLoading() const;
+
+private:
+    void BackgroundStagesProc();
+    bool LoadLevelData();
+    bool LoadGpuResources();
+    void SetLoadingStage(eLevelLoadingStage loadingStage);
+    void NotifyProgress();
+
+private:
+    std::string mMapName;
+    std::thread mLoadingThread;
+    std::atomic<eLevelLoadingStage> mLoadingStage { eLevelLoadingStage_Idle };
+    std::atomic<bool> mBackgroundStagesDone { false };
+    std::atomic<bool> mBackgroundStagesSucceeded { false };
+    std::atomic<bool> mCancelRequested { false };
+
+    LevelLoadingProgressCallback mProgressCallback;
+    eLevelLoadingStage mNotifiedStage = eLevelLoadingStage_Idle;
+};
+
+extern LevelLoader gLevelLoader;
@@ -1,16 +1,48 @@
 #include "stdafx.h"
 #include "MainMenuGamestate.h"
+#include "imgui.h"
+#include "cvars.h"
 
 void MainMenuGamestate::OnGamestateEnter()
 {
+    mLoadingStage = gLevelLoader.GetLoadingStage();
+    mLoadingProgress = gLevelLoader.GetLoadingProgress();
+    gLevelLoader.SetProgressCallback([this](eLevelLoadingStage loadingStage, float loadingProgress)
+    {
+        mLoadingStage = loadingStage;
+        mLoadingProgress = loadingProgress;
+    });
 }
 
 void MainMenuGamestate::OnGamestateLeave()
 {
+    gLevelLoader.SetProgressCallback(nullptr);
 }
 
 void MainMenuGamestate::OnGamestateFrame()
 {
+    if (gCvarSysHeadless.mValue)
+        return;
+
+    if ((mLoadingStage > eLevelLoadingStage_Idle) && (mLoadingStage < eLevelLoadingStage_Done))
+    {
+        DoLoadingProgressUI();
+    }
+}
+
+void MainMenuGamestate::DoLoadingProgressUI()
+{
+    ImGuiWindowFlags wndFlags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings | 
+        ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_AlwaysAutoResize;
+
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f, io.DisplaySize.y * 0.5f), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+    if (ImGui::Begin("##level_loading", nullptr, wndFlags))
+    {
+        ImGui::Text("%s...", cxx::enum_to_string(mLoadingStage));
+        ImGui::ProgressBar(mLoadingProgress, ImVec2(320.0f, 0.0f));
+    }
+    ImGui::End();
 }
 
 void MainMenuGamestate::OnGamestateInputEvent(KeyInputEvent& inputEvent)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GenericGamestate.h"
+#include "LevelLoader.h"
 
 class MainMenuGamestate: public GenericGamestate
 {
@@ -20,5 +21,10 @@ public:
     void OnGamestateInputEventLost() override;
 
 private:
+    void DoLoadingProgressUI();
 
+private:
+    // level loading progress, reported by level loader
+    eLevelLoadingStage mLoadingStage = eLevelLoadingStage_Idle;
+    float mLoadingProgress = 0.0f;
 };
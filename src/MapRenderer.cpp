@@ -12,6 +12,11 @@
 #include "Vehicle.h"
 #include "RenderView.h"
 #include "TrafficManager.h"
+#include "FrameProfiler.h"
+#include "JobsManager.h"
+
+// per worker scratch mesh data, grows to largest chunk built on that thread and keeps its capacity
+static thread_local CityMeshData ChunkScratchMeshData;
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -68,6 +73,7 @@ void MapRenderer::Deinit()
 void MapRenderer::RenderFrameBegin()
 {
     mRenderStats.FrameBegin();
+    RebuildInvalidatedChunks();
 
     // pre draw game objects
     for (GameObject* gameObject: gGameObjectsManager.mAllObjects)
@@ -98,6 +104,7 @@ void MapRenderer::PreDrawGameObject(GameObject* gameObject)
 
 void MapRenderer::RenderFrame(RenderView* renderview)
 {
+    PROFILE_SCOPE("Map draw");
     debug_assert(renderview);
 
     gGraphicsDevice.BindTexture(eTextureUnit_3, gSpriteManager.mPalettesTable);
@@ -110,8 +117,19 @@ void MapRenderer::RenderFrame(RenderView* renderview)
 
     mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Y, eSpritesSortMode_HeightAndDrawOrder);
 
-    // collect and render game objects sprites
-    for (GameObject* gameObject: gGameObjectsManager.mAllObjects)
+    // collect and render game objects sprites, sprite bounds may exceed object position a bit
+    const float drawExtent = gSpriteManager.mMaxSpriteDrawExtent;
+
+    cxx::aabbox2d_t drawArea = renderview->mOnScreenArea;
+    drawArea.mMin -= glm::vec2(drawExtent);
+    drawArea.mMax += glm::vec2(drawExtent);
+
+    mDrawObjectsList.clear();
+    gGameObjectsManager.QueryObjectsInRect(drawArea, GameObjectClassMask_All, mDrawObjectsList);
+    // sprites at same depth are drawn in submission order, so objects must go in same order regardless of grid cells
+    gGameObjectsManager.SortObjectsInCreationOrder(mDrawObjectsList);
+
+    for (GameObject* gameObject: mDrawObjectsList)
     {
         // attached objects must be drawn after the object to which they are attached
         if (gameObject->IsAttachedToObject())
@@ -120,8 +138,9 @@ void MapRenderer::RenderFrame(RenderView* renderview)
         DrawGameObject(renderview, gameObject);
     }
 
-    gRenderManager.mSpritesProgram.Activate();
-    gRenderManager.mSpritesProgram.UploadCameraTransformMatrices(renderview->mCamera);
+    RenderProgram& spritesProgram = gRenderManager.GetSpritesProgram();
+    spritesProgram.Activate();
+    spritesProgram.UploadCameraTransformMatrices(renderview->mCamera);
 
     RenderStates renderStates = RenderStates()
         .Disable(RenderStateFlags_FaceCulling)
@@ -130,7 +149,7 @@ void MapRenderer::RenderFrame(RenderView* renderview)
 
     mSpriteBatch.Flush();
 
-    gRenderManager.mSpritesProgram.Deactivate();
+    spritesProgram.Deactivate();
 }
 
 void MapRenderer::DrawGameObject(RenderView* renderview, GameObject* gameObject)
@@ -147,6 +166,11 @@ void MapRenderer::DrawGameObject(RenderView* renderview, GameObject* gameObject)
     // detect if gameobject is visible on screen
     if (!debugSkipDraw && gameObject->IsOnScreen(renderview->mOnScreenArea))
     {
+        if (gameObject->mDrawSpriteDeltaBits > 0)
+        {
+            gSpriteManager.GetSpriteTexture(gameObject->mObjectID, gameObject->mDrawSpriteIndex, gameObject->mRemapClut, 
+                gameObject->mDrawSpriteDeltaBits, gameObject->mDrawSprite);
+        }
         mSpriteBatch.DrawSprite(gameObject->mDrawSprite);
 
         ++mRenderStats.mSpritesDrawnCount;
@@ -174,6 +198,7 @@ void MapRenderer::DebugDraw(DebugRenderer& debugRender)
 
 void MapRenderer::DrawCityMesh(RenderView* renderview)
 {
+    PROFILE_SCOPE("City mesh draw");
     RenderStates cityMeshRenderStates;
 
     gGraphicsDevice.SetRenderStates(cityMeshRenderStates);
@@ -190,6 +215,9 @@ void MapRenderer::DrawCityMesh(RenderView* renderview)
 
         for (const MapBlocksChunk& currChunk: mMapBlocksChunks)
         {
+            if (currChunk.mIndicesCount == 0)
+                continue;
+
             if (!renderview->mCamera.mFrustum.contains(currChunk.mBounds))
                 continue;
 
@@ -204,54 +232,239 @@ void MapRenderer::DrawCityMesh(RenderView* renderview)
 
 void MapRenderer::BuildMapMesh()
 {
-    CityMeshData blocksMesh;
-    for (int batchy = 0; batchy < BlocksBatchesPerSide; ++batchy)
+    PROFILE_SCOPE("Build map mesh");
+
+    BuildMapMeshData();
+    UploadMapMesh();
+}
+
+void MapRenderer::BuildMapMeshData()
+{
+    SetupMapChunks();
+
+    // chunks are independent, so build them in parallel
+    mChunksMeshData.clear();
+    mChunksMeshData.resize(BlocksBatchCount);
+
+    std::vector<CityMeshData>& chunksMeshes = mChunksMeshData;
+    gJobsManager.ParallelFor(BlocksBatchCount, [this, &chunksMeshes](int chunkIndex)
     {
-        for (int batchx = 0; batchx < BlocksBatchesPerSide; ++batchx)
-        {
-            Rect mapArea { 
-                batchx * BlocksBatchDims - ExtraBlocksPerSide, 
-                batchy * BlocksBatchDims - ExtraBlocksPerSide,
-                BlocksBatchDims,
-                BlocksBatchDims };
-
-            unsigned int prevVerticesCount = blocksMesh.mBlocksVertices.size();
-            unsigned int prevIndicesCount = blocksMesh.mBlocksIndices.size();
-
-            MapBlocksChunk& currChunk = mMapBlocksChunks[batchy * BlocksBatchesPerSide + batchx];
-            currChunk.mBounds.mMin = glm::vec3 { mapArea.x * METERS_PER_MAP_UNIT, 0.0f, mapArea.y * METERS_PER_MAP_UNIT };
-            currChunk.mBounds.mMax = glm::vec3 { 
-                (mapArea.x + mapArea.w) * METERS_PER_MAP_UNIT, MAP_LAYERS_COUNT * METERS_PER_MAP_UNIT, 
-                (mapArea.y + mapArea.h) * METERS_PER_MAP_UNIT};
-
-            currChunk.mVerticesStart = prevVerticesCount;
-            currChunk.mIndicesStart = prevIndicesCount;
-            
-            // append new geometry
-            GameMapHelpers::BuildMapMesh(gGameMap, mapArea, blocksMesh);
-            
-            currChunk.mVerticesCount = blocksMesh.mBlocksVertices.size() - prevVerticesCount;
-            currChunk.mIndicesCount = blocksMesh.mBlocksIndices.size() - prevIndicesCount;
-        }
+        // build into scratch and then copy exact sized geometry, chunks are mostly far below worst case
+        CityMeshData& scratchMesh = ChunkScratchMeshData;
+        scratchMesh.Clear();
+        GameMapHelpers::BuildMapMesh(gGameMap, mMapBlocksChunks[chunkIndex].mMapArea, scratchMesh);
+
+        chunksMeshes[chunkIndex].mBlocksVertices.assign(scratchMesh.mBlocksVertices.begin(), scratchMesh.mBlocksVertices.end());
+        chunksMeshes[chunkIndex].mBlocksIndices.assign(scratchMesh.mBlocksIndices.begin(), scratchMesh.mBlocksIndices.end());
+    });
+}
+
+bool MapRenderer::SetMapMeshData(std::vector<CityMeshData>& chunksMeshData)
+{
+    if (chunksMeshData.size() != BlocksBatchCount)
+        return false;
+
+    SetupMapChunks();
+
+    mChunksMeshData.clear();
+    mChunksMeshData.swap(chunksMeshData);
+    return true;
+}
+
+int MapRenderer::GetMapChunksCount()
+{
+    return BlocksBatchCount;
+}
+
+const std::vector<CityMeshData>& MapRenderer::GetMapMeshData() const
+{
+    return mChunksMeshData;
+}
+
+void MapRenderer::SetupMapChunks()
+{
+    for (int chunkIndex = 0; chunkIndex < BlocksBatchCount; ++chunkIndex)
+    {
+        int batchx = chunkIndex % BlocksBatchesPerSide;
+        int batchy = chunkIndex / BlocksBatchesPerSide;
+
+        Rect mapArea { 
+            batchx * BlocksBatchDims - ExtraBlocksPerSide, 
+            batchy * BlocksBatchDims - ExtraBlocksPerSide,
+            BlocksBatchDims,
+            BlocksBatchDims };
+
+        MapBlocksChunk& currChunk = mMapBlocksChunks[chunkIndex];
+        currChunk.mMapArea = mapArea;
+        currChunk.mBounds.mMin = glm::vec3 { mapArea.x * METERS_PER_MAP_UNIT, 0.0f, mapArea.y * METERS_PER_MAP_UNIT };
+        currChunk.mBounds.mMax = glm::vec3 { 
+            (mapArea.x + mapArea.w) * METERS_PER_MAP_UNIT, MAP_LAYERS_COUNT * METERS_PER_MAP_UNIT, 
+            (mapArea.y + mapArea.h) * METERS_PER_MAP_UNIT};
+    }
+}
+
+void MapRenderer::UploadMapMesh()
+{
+    const std::vector<CityMeshData>& chunksMeshes = mChunksMeshData;
+    if (chunksMeshes.size() != BlocksBatchCount)
+    {
+        debug_assert(false); // mesh data is not built
+        return;
+    }
+
+    // layout chunks one after another
+    unsigned int totalVerticesCount = 0;
+    unsigned int totalIndicesCount = 0;
+    for (int ichunk = 0; ichunk < BlocksBatchCount; ++ichunk)
+    {
+        MapBlocksChunk& currChunk = mMapBlocksChunks[ichunk];
+        currChunk.mVerticesStart = totalVerticesCount;
+        currChunk.mIndicesStart = totalIndicesCount;
+        currChunk.mVerticesCount = chunksMeshes[ichunk].mBlocksVertices.size();
+        currChunk.mIndicesCount = chunksMeshes[ichunk].mBlocksIndices.size();
+        currChunk.mVerticesCapacity = currChunk.mVerticesCount;
+        currChunk.mIndicesCapacity = currChunk.mIndicesCount;
+        currChunk.mIsInvalidated = false;
+
+        totalVerticesCount += currChunk.mVerticesCount;
+        totalIndicesCount += currChunk.mIndicesCount;
     }
 
+    mCityMeshVerticesUsed = totalVerticesCount;
+    mCityMeshIndicesUsed = totalIndicesCount;
+    mCityMeshVerticesWasted = 0;
+    mHasInvalidatedChunks = false;
+
     // upload map geometry to video memory
-    int totalVertexDataBytes = blocksMesh.mBlocksVertices.size() * Sizeof_CityVertex3D;
-    int totalIndexDataBytes = blocksMesh.mBlocksIndices.size() * Sizeof_DrawIndex;
+    int totalVertexDataBytes = totalVerticesCount * Sizeof_CityVertex3D;
+    int totalIndexDataBytes = totalIndicesCount * Sizeof_DrawIndex;
 
+    // chunks may be updated later so buffers are dynamic
     // upload vertex data
-    mCityMeshBufferV->Setup(eBufferUsage_Static, totalVertexDataBytes, nullptr);
-    if (void* pdata = mCityMeshBufferV->Lock(BufferAccess_Write))
+    mCityMeshBufferV->Setup(eBufferUsage_Dynamic, totalVertexDataBytes, nullptr);
+    if (CityVertex3D* pdata = mCityMeshBufferV->LockData<CityVertex3D>(BufferAccess_Write))
     {
-        memcpy(pdata, blocksMesh.mBlocksVertices.data(), totalVertexDataBytes);
+        for (int ichunk = 0; ichunk < BlocksBatchCount; ++ichunk)
+        {
+            const MapBlocksChunk& currChunk = mMapBlocksChunks[ichunk];
+            if (currChunk.mVerticesCount == 0)
+                continue;
+
+            memcpy(pdata + currChunk.mVerticesStart, chunksMeshes[ichunk].mBlocksVertices.data(), currChunk.mVerticesCount * Sizeof_CityVertex3D);
+        }
         mCityMeshBufferV->Unlock();
     }
 
-    // upload index data
-    mCityMeshBufferI->Setup(eBufferUsage_Static, totalIndexDataBytes, nullptr);
-    if (void* pdata = mCityMeshBufferI->Lock(BufferAccess_Write))
+    // upload index data, chunk geometry is built from scratch so indices must be shifted to its location
+    mCityMeshBufferI->Setup(eBufferUsage_Dynamic, totalIndexDataBytes, nullptr);
+    if (DrawIndex* pdata = mCityMeshBufferI->LockData<DrawIndex>(BufferAccess_Write))
     {
-        memcpy(pdata, blocksMesh.mBlocksIndices.data(), totalIndexDataBytes);
+        for (int ichunk = 0; ichunk < BlocksBatchCount; ++ichunk)
+        {
+            const MapBlocksChunk& currChunk = mMapBlocksChunks[ichunk];
+            const CityMeshData& chunkMesh = chunksMeshes[ichunk];
+            for (unsigned int iindex = 0; iindex < currChunk.mIndicesCount; ++iindex)
+            {
+                pdata[currChunk.mIndicesStart + iindex] = chunkMesh.mBlocksIndices[iindex] + currChunk.mVerticesStart;
+            }
+        }
         mCityMeshBufferI->Unlock();
     }
+
+    mChunksMeshData.clear();
+}
+
+void MapRenderer::InvalidateMapMesh(const Rect& mapArea)
+{
+    // find all chunks touched by area
+    int batchMinx = (mapArea.x + ExtraBlocksPerSide) / BlocksBatchDims;
+    int batchMiny = (mapArea.y + ExtraBlocksPerSide) / BlocksBatchDims;
+    int batchMaxx = (mapArea.x + mapArea.w - 1 + ExtraBlocksPerSide) / BlocksBatchDims;
+    int batchMaxy = (mapArea.y + mapArea.h - 1 + ExtraBlocksPerSide) / BlocksBatchDims;
+
+    batchMinx = glm::clamp(batchMinx, 0, BlocksBatchesPerSide - 1);
+    batchMiny = glm::clamp(batchMiny, 0, BlocksBatchesPerSide - 1);
+    batchMaxx = glm::clamp(batchMaxx, 0, BlocksBatchesPerSide - 1);
+    batchMaxy = glm::clamp(batchMaxy, 0, BlocksBatchesPerSide - 1);
+
+    for (int batchy = batchMiny; batchy <= batchMaxy; ++batchy)
+    {
+        for (int batchx = batchMinx; batchx <= batchMaxx; ++batchx)
+        {
+            mMapBlocksChunks[batchy * BlocksBatchesPerSide + batchx].mIsInvalidated = true;
+            mHasInvalidatedChunks = true;
+        }
+    }
+}
+
+void MapRenderer::RebuildInvalidatedChunks()
+{
+    if (!mHasInvalidatedChunks)
+        return;
+
+    PROFILE_SCOPE("Rebuild map chunks");
+
+    mHasInvalidatedChunks = false;
+
+    for (MapBlocksChunk& currChunk: mMapBlocksChunks)
+    {
+        if (!currChunk.mIsInvalidated)
+            continue;
+
+        currChunk.mIsInvalidated = false;
+
+        // new geometry usually has about same size as previous one
+        mChunkMeshData.Clear();
+        mChunkMeshData.mBlocksVertices.reserve(std::max<unsigned int>(currChunk.mVerticesCapacity, ChunkVerticesReserve));
+        mChunkMeshData.mBlocksIndices.reserve(std::max<unsigned int>(currChunk.mIndicesCapacity, ChunkIndicesReserve));
+        GameMapHelpers::BuildMapMesh(gGameMap, currChunk.mMapArea, mChunkMeshData);
+
+        unsigned int verticesCount = mChunkMeshData.mBlocksVertices.size();
+        unsigned int indicesCount = mChunkMeshData.mBlocksIndices.size();
+
+        // move chunk to the end of buffers if it does not fit anymore
+        if (verticesCount > currChunk.mVerticesCapacity || indicesCount > currChunk.mIndicesCapacity)
+        {
+            mCityMeshVerticesWasted += currChunk.mVerticesCapacity;
+
+            currChunk.mVerticesStart = mCityMeshVerticesUsed;
+            currChunk.mIndicesStart = mCityMeshIndicesUsed;
+            currChunk.mVerticesCapacity = verticesCount;
+            currChunk.mIndicesCapacity = indicesCount;
+
+            mCityMeshVerticesUsed += verticesCount;
+            mCityMeshIndicesUsed += indicesCount;
+
+            if (!mCityMeshBufferV->Resize(mCityMeshVerticesUsed * Sizeof_CityVertex3D) ||
+                !mCityMeshBufferI->Resize(mCityMeshIndicesUsed * Sizeof_DrawIndex))
+            {
+                debug_assert(false);
+            }
+        }
+
+        currChunk.mVerticesCount = verticesCount;
+        currChunk.mIndicesCount = indicesCount;
+        if (verticesCount == 0 || indicesCount == 0)
+            continue;
+
+        // chunk geometry was built from scratch, so indices must be shifted to its location
+        for (DrawIndex& currIndex: mChunkMeshData.mBlocksIndices)
+        {
+            currIndex += currChunk.mVerticesStart;
+        }
+
+        mCityMeshBufferV->SubData(currChunk.mVerticesStart * Sizeof_CityVertex3D, 
+            verticesCount * Sizeof_CityVertex3D, mChunkMeshData.mBlocksVertices.data());
+
+        mCityMeshBufferI->SubData(currChunk.mIndicesStart * Sizeof_DrawIndex, 
+            indicesCount * Sizeof_DrawIndex, mChunkMeshData.mBlocksIndices.data());
+
+        ++mRenderStats.mBlockChunksRebuiltCount;
+    }
+
+    // too much unused space after many relocations, compact whole mesh
+    if (mCityMeshVerticesWasted > (mCityMeshVerticesUsed / 2))
+    {
+        BuildMapMesh();
+    }
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ public:
 public:
     int mBlockChunksDrawnCount = 0;  // per frame
     int mSpritesDrawnCount = 0; // per frame
+    int mBlockChunksRebuiltCount = 0; // total
 
     unsigned int mRenderFramesCounter = 0; // gets incremented on every frame
 };
@@ -36,7 +37,29 @@ public:
     void RenderFrameEnd();
     void BuildMapMesh();
 
+    // Map mesh building is split into cpu and gpu parts, so that chunks geometry can be generated on worker thread
+    // while level is being loaded, mesh data must be uploaded on main thread afterwards
+    void BuildMapMeshData();
+    void UploadMapMesh();
+
+    // Use previously built mesh data instead of building it, data gets moved
+    // @param chunksMeshData: Mesh data of all chunks
+    // @returns false if chunks layout does not match
+    bool SetMapMeshData(std::vector<CityMeshData>& chunksMeshData);
+
+    // Get number of city mesh chunks, same for all maps
+    static int GetMapChunksCount();
+
+    // Get built but not yet uploaded mesh data of all chunks
+    const std::vector<CityMeshData>& GetMapMeshData() const;
+
+    // Mark city mesh chunks within map area as outdated, they will be rebuilt on next render frame
+    // @param mapArea: Changed map blocks area
+    void InvalidateMapMesh(const Rect& mapArea);
+
 private:
+    void SetupMapChunks();
+    void RebuildInvalidatedChunks();
     void DrawCityMesh(RenderView* renderview);
     void DrawGameObject(RenderView* renderview, GameObject* gameObject);
     void PreDrawGameObject(GameObject* gameObject);
@@ -48,18 +71,33 @@ private:
         ExtraBlocksPerSide = 4,
         BlocksBatchesPerSide = ((MAP_DIMENSIONS + (ExtraBlocksPerSide * 2)) + BlocksBatchDims - 1) / BlocksBatchDims,
         BlocksBatchCount = BlocksBatchesPerSide * BlocksBatchesPerSide,
+        // initial mesh data capacity of single rebuilt chunk, about four visible faces per blocks column
+        ChunkVerticesReserve = BlocksBatchDims * BlocksBatchDims * 4 * 4,
+        ChunkIndicesReserve = BlocksBatchDims * BlocksBatchDims * 4 * 6,
     };
     struct MapBlocksChunk
     {
         cxx::aabbox_t mBounds; // for culling
+        Rect mMapArea;
         // index/vertex data offset in vbo
-        unsigned int mIndicesStart = 0, mIndicesCount = 0;
-        unsigned int mVerticesStart = 0, mVerticesCount = 0;
+        unsigned int mIndicesStart = 0, mIndicesCount = 0, mIndicesCapacity = 0;
+        unsigned int mVerticesStart = 0, mVerticesCount = 0, mVerticesCapacity = 0;
+        bool mIsInvalidated = false;
     };
     MapBlocksChunk mMapBlocksChunks[BlocksBatchCount];
 
     GpuBuffer* mCityMeshBufferV;
     GpuBuffer* mCityMeshBufferI;
 
+    // used space in city mesh buffers, rebuilt chunks that does not fit their old location are moved to the end
+    unsigned int mCityMeshVerticesUsed = 0;
+    unsigned int mCityMeshIndicesUsed = 0;
+    unsigned int mCityMeshVerticesWasted = 0;
+    bool mHasInvalidatedChunks = false;
+
+    CityMeshData mChunkMeshData; // temporary mesh data of single chunk
+    std::vector<CityMeshData> mChunksMeshData; // built but not yet uploaded mesh data of all chunks
+
     SpriteBatch mSpriteBatch;
+    std::vector<GameObject*> mDrawObjectsList; // temporary list of potentially visible objects
 };
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CommonTypes.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define PALETTE_BLIT_SSE2
+    #include <emmintrin.h>
+#endif
+
+// Row kernels that convert palette indexed pixels to texture format of specific pixel size
+// Palette entry 0 is transparent color
+template<int TBytesPerPixel>
+struct PaletteRowBlit;
+
+// color indices are stored as is
+template<>
+struct PaletteRowBlit<1>
+{
+    static inline void BlitRow(unsigned char* destPixels, const unsigned char* srcIndices, int pixelsCount, const Palette256& palette)
+    {
+        ::memcpy(destPixels, srcIndices, pixelsCount);
+    }
+};
+
+// rgb color
+template<>
+struct PaletteRowBlit<3>
+{
+    static inline void BlitRow(unsigned char* destPixels, const unsigned char* srcIndices, int pixelsCount, const Palette256& palette)
+    {
+        for (int ipixel = 0; ipixel < pixelsCount; ++ipixel)
+        {
+            const Color32& color = palette.mColors[srcIndices[ipixel]];
+            destPixels[0] = color.mR;
+            destPixels[1] = color.mG;
+            destPixels[2] = color.mB;
+            destPixels += 3;
+        }
+    }
+};
+
+// rgba color, alpha is zero for transparent entry and opaque otherwise
+template<>
+struct PaletteRowBlit<4>
+{
+    static inline void BlitRow(unsigned char* destPixels, const unsigned char* srcIndices, int pixelsCount, const Palette256& palette)
+    {
+        int ipixel = 0;
+#ifdef PALETTE_BLIT_SSE2
+        // there is no gather instruction in sse2, so colors are fetched one by one and masked four at once
+        const __m128i zeroBits = _mm_setzero_si128();
+        const __m128i colorBits = _mm_set1_epi32(0x00FFFFFF);
+        const __m128i alphaBits = _mm_set1_epi32((int) 0xFF000000);
+        for (; ipixel + 4 <= pixelsCount; ipixel += 4)
+        {
+            const unsigned char* indices = srcIndices + ipixel;
+
+            int packedIndices;
+            ::memcpy(&packedIndices, indices, sizeof(packedIndices));
+            __m128i indicesBits = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packedIndices), zeroBits), zeroBits);
+            __m128i opaqueBits = _mm_andnot_si128(_mm_cmpeq_epi32(indicesBits, zeroBits), alphaBits);
+            __m128i colors = _mm_set_epi32(
+                (int) palette.mColors[indices[3]].mRGBA, 
+                (int) palette.mColors[indices[2]].mRGBA, 
+                (int) palette.mColors[indices[1]].mRGBA, 
+                (int) palette.mColors[indices[0]].mRGBA);
+            colors = _mm_or_si128(_mm_and_si128(colors, colorBits), opaqueBits);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destPixels + ipixel * 4), colors);
+        }
+#endif
+        for (; ipixel < pixelsCount; ++ipixel)
+        {
+            unsigned char palentry = srcIndices[ipixel];
+            unsigned int rgba = (palette.mColors[palentry].mRGBA & 0x00FFFFFFU) | ((palentry == 0) ? 0U : 0xFF000000U);
+            ::memcpy(destPixels + ipixel * 4, &rgba, sizeof(rgba));
+        }
+    }
+};
+
+// Convert palette indexed pixels rectangle to texture format of specific pixel size
+// @param destPixels: Destination pixels, first pixel of rectangle
+// @param destPitch: Destination row length in bytes
+// @param srcIndices: Source color indices, first pixel of rectangle
+// @param srcPitch: Source row length in bytes
+// @param sizex, sizey: Rectangle dimensions
+// @param palette: Source palette
+template<int TBytesPerPixel>
+inline void PaletteBlitRect(unsigned char* destPixels, int destPitch, const unsigned char* srcIndices, int srcPitch, int sizex, int sizey, const Palette256& palette)
+{
+    for (int iy = 0; iy < sizey; ++iy)
+    {
+        PaletteRowBlit<TBytesPerPixel>::BlitRow(destPixels, srcIndices, sizex, palette);
+        destPixels += destPitch;
+        srcIndices += srcPitch;
+    }
+}
+
+// Convert palette indexed pixels rectangle, kernel is selected by bytes per pixel once per rectangle
+// @returns false on unsupported pixel size
+inline bool PaletteBlitRect(int bytesPerPixel, unsigned char* destPixels, int destPitch, const unsigned char* srcIndices, int srcPitch, int sizex, int sizey, const Palette256& palette)
+{
+    switch (bytesPerPixel)
+    {
+        case 1: PaletteBlitRect<1>(destPixels, destPitch, srcIndices, srcPitch, sizex, sizey, palette); return true;
+        case 3: PaletteBlitRect<3>(destPixels, destPitch, srcIndices, srcPitch, sizex, sizey, palette); return true;
+        case 4: PaletteBlitRect<4>(destPixels, destPitch, srcIndices, srcPitch, sizex, sizey, palette); return true;
+        default: break;
+    }
+    return false;
+}
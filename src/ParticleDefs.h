@@ -2,7 +2,7 @@
 
 #include "GraphicsDefs.h"
 
-// defines single particle draw vertex
+// defines single particle draw instance, it gets expanded to billboard in shader
 struct ParticleVertex
 {
 public:
@@ -24,7 +24,7 @@ public:
 
 const unsigned int Sizeof_ParticleVertex = sizeof(ParticleVertex);
 
-// defines draw vertex format of city mesh
+// defines draw instance format of particles
 struct ParticleVertex_Format: public VertexFormat
 {
 public:
@@ -43,6 +43,7 @@ public:
     inline void Setup()
     {
         this->mDataStride = Sizeof_ParticleVertex;
+        this->mInstanced = true;
         this->SetAttribute(eVertexAttribute_Position0, eVertexAttributeFormat_4F, offsetof(TVertexType, mPositionSize));
         this->SetAttribute(eVertexAttribute_Color0, eVertexAttributeFormat_4UB, offsetof(TVertexType, mColor));
         this->SetAttributeNormalized(eVertexAttribute_Color0);
@@ -56,17 +57,13 @@ enum eParticleState
     eParticleState_Dead,
 };
 
-// defines single particle state
+// defines single particle state, alive particles are stored in ParticlesArray
 struct Particle
 {
 public:
     Particle() = default;
     void Clear()
     {
-        mStartPosition.x = 0.0f; 
-        mStartPosition.y = 0.0f; 
-        mStartPosition.z = 0.0f;
-
         mPosition.x = 0.0f; 
         mPosition.y = 0.0f; 
         mPosition.z = 0.0f;
@@ -82,7 +79,6 @@ public:
         mState = eParticleState_Alive;
     }
 public:
-    glm::vec3 mStartPosition;
     glm::vec3 mPosition;
     glm::vec3 mVelocity;
     float mSize = 1.0f;
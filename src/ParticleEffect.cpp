@@ -2,13 +2,7 @@
 #include "ParticleEffect.h"
 #include "TimeManager.h"
 #include "DebugRenderer.h"
-#include "CarnageGame.h"
-#include "ParticleRenderdata.h"
-
-ParticleEffect::~ParticleEffect()
-{
-    debug_assert(mRenderdata == nullptr);
-}
+#include "ParticleEffectsManager.h"
 
 void ParticleEffect::UpdateFrame()
 {
@@ -40,12 +34,7 @@ void ParticleEffect::UpdateFrame()
         }
     }
 
-    if ((mAliveParticlesCount > 0) && mRenderdata)
-    {
-        mRenderdata->Invalidate();
-    }
-
-    if ((mAliveParticlesCount == 0) && (mEffectState == eParticleEffectState_Stopping))
+    if ((mParticles.mCount == 0) && (mEffectState == eParticleEffectState_Stopping))
     {
         mEffectState = eParticleEffectState_Done;
     }
@@ -106,7 +95,7 @@ void ParticleEffect::StopEffect()
 {
     if (mEffectState == eParticleEffectState_Active)
     {
-        mEffectState = (mAliveParticlesCount == 0) ? eParticleEffectState_Done : eParticleEffectState_Stopping;
+        mEffectState = (mParticles.mCount == 0) ? eParticleEffectState_Done : eParticleEffectState_Stopping;
     }
 }
 
@@ -121,29 +110,27 @@ void ParticleEffect::ClearEffect()
 
 bool ParticleEffect::PutParticle(const glm::vec3& position)
 {
-    if (mAliveParticlesCount < mEffectParams.mMaxParticlesCount)
+    if (mParticles.mCount < mParticles.mCapacity)
     {
-        Particle& particle = mParticles[mAliveParticlesCount++];
+        Particle particle;
         SpawnParticle(particle);
         // fix start params
-        particle.mStartPosition = position;
         particle.mPosition = position;
-        return true;
+        return mParticles.AddParticle(particle);
     }
     return false;
 }
 
 bool ParticleEffect::PutParticle(const glm::vec3& position, const glm::vec3& velocity)
 {
-    if (mAliveParticlesCount < mEffectParams.mMaxParticlesCount)
+    if (mParticles.mCount < mParticles.mCapacity)
     {
-        Particle& particle = mParticles[mAliveParticlesCount++];
+        Particle particle;
         SpawnParticle(particle);
         // fix start params
-        particle.mStartPosition = position;
         particle.mPosition = position;
         particle.mVelocity += velocity; // accumulate
-        return true;
+        return mParticles.AddParticle(particle);
     }
     return false;
 }
@@ -160,55 +147,50 @@ bool ParticleEffect::IsEffectActive() const
 
 void ParticleEffect::ResetParticles()
 {
-    mParticles.clear();
-    if (mEffectParams.mMaxParticlesCount > 0)
-    {
-        mParticles.resize(mEffectParams.mMaxParticlesCount);
-    }
-    mAliveParticlesCount = 0;
+    mParticles.Setup(std::max(mEffectParams.mMaxParticlesCount, 0));
 }
 
-bool ParticleEffect::UpdateParticle(Particle& particle, float deltaTime)
+bool ParticleEffect::UpdateParticleState(int particleIndex, float deltaTime)
 {
-    particle.mAge += deltaTime;
-
-    if (particle.mState == eParticleState_Alive)
+    // age and position are already advanced by movement kernel
+    if (mParticles.mState[particleIndex] == eParticleState_Alive)
     {
+        float particleAge = mParticles.mAge[particleIndex];
+        float particleLifeTime = mParticles.mLifeTime[particleIndex];
+
         // check timeout
-        if (mEffectParams.mParticleDieOnTimeout && (particle.mAge > particle.mLifeTime))
+        if (mEffectParams.mParticleDieOnTimeout && (particleAge > particleLifeTime))
         {
             if (mEffectParams.IsParticleFadeoutOnDie())
             {
-                particle.mState = eParticleState_Fade;
+                SetParticleFade(particleIndex);
             }
             else return false; // particle dead
         }
 
-        // update current position based on velocity and time
-        particle.mPosition += (particle.mVelocity + mEffectParams.mParticlesGravity) * deltaTime;
-
         // update color
         if (mEffectParams.mParticleChangesColorOverTime)
         {
             int colorCount = (int) mEffectParams.mParticleColors.size();
             if (colorCount > 1)
             {
-                float progression = (particle.mAge / particle.mLifeTime); // [0,1]
+                float progression = (particleAge / particleLifeTime); // [0,1]
                 int colorIndex = glm::min((int) ((colorCount - 1) * progression + 0.5f), (colorCount - 1));
-                particle.mColor = mEffectParams.mParticleColors[colorIndex];
+                mParticles.mColor[particleIndex] = mEffectParams.mParticleColors[colorIndex];
             }
         }
 
         // check collision
         if (mEffectParams.mParticleDieOnCollision)
         {
-            float height = gGameMap.GetHeightAtPosition(particle.mPosition, false);
-            if (height > particle.mPosition.y)
+            glm::vec3 position (mParticles.mPositionX[particleIndex], mParticles.mPositionY[particleIndex], mParticles.mPositionZ[particleIndex]);
+            float height = gGameMap.GetHeightAtPosition(position, false);
+            if (height > position.y)
             {
-                particle.mPosition.y = height; // fix height
+                mParticles.mPositionY[particleIndex] = height; // fix height
                 if (mEffectParams.IsParticleFadeoutOnDie())
                 {
-                    particle.mState = eParticleState_Fade;
+                    SetParticleFade(particleIndex);
                 }
                 else return false; // particle dead
             }
@@ -216,15 +198,16 @@ bool ParticleEffect::UpdateParticle(Particle& particle, float deltaTime)
     }
 
     // update fadeout
-    if (particle.mState == eParticleState_Fade)
+    if (mParticles.mState[particleIndex] == eParticleState_Fade)
     {
         debug_assert(mEffectParams.mParticleFadeoutDuration > 0.0f);
-        int currAlpha = (int) (particle.mColor.mA - (255.0f * (deltaTime / mEffectParams.mParticleFadeoutDuration)));
+        Color32& particleColor = mParticles.mColor[particleIndex];
+        int currAlpha = (int) (particleColor.mA - (255.0f * (deltaTime / mEffectParams.mParticleFadeoutDuration)));
         if (currAlpha < 0)
         {
             currAlpha = 0;
         }
-        particle.mColor.mA = (unsigned char) currAlpha;
+        particleColor.mA = (unsigned char) currAlpha;
         if (currAlpha == 0)
             return false; // particle dead
     }
@@ -232,9 +215,16 @@ bool ParticleEffect::UpdateParticle(Particle& particle, float deltaTime)
     return true; // particle alive
 }
 
+void ParticleEffect::SetParticleFade(int particleIndex)
+{
+    // fading particles stay in place
+    mParticles.mState[particleIndex] = eParticleState_Fade;
+    mParticles.StopParticle(particleIndex);
+}
+
 void ParticleEffect::SpawnParticle(Particle& particle)
 {
-    cxx::randomizer& random = gCarnageGame.mGameRand;
+    cxx::randomizer& random = gParticleManager.mParticlesRand;
 
     particle.mAge = 0.0f;
     particle.mState = eParticleState_Alive;
@@ -252,12 +242,12 @@ void ParticleEffect::SpawnParticle(Particle& particle)
         particle.mPosition = mEmitterShapeParams.mPoint;
     }
 
-    particle.mStartPosition = particle.mPosition;
-
     // choose velocity
     particle.mVelocity.x = random.generate_float(mEffectParams.mParticleHorzVelocityRange.x, mEffectParams.mParticleHorzVelocityRange.y);
     particle.mVelocity.z = random.generate_float(mEffectParams.mParticleHorzVelocityRange.x, mEffectParams.mParticleHorzVelocityRange.y);
     particle.mVelocity.y = random.generate_float(mEffectParams.mParticleVertVelocityRange.x, mEffectParams.mParticleVertVelocityRange.y);
+    // gravity does not accumulate, so it is applied once as constant velocity
+    particle.mVelocity += mEffectParams.mParticlesGravity;
 
     // choose size
     particle.mSize = random.generate_float(mEffectParams.mParticleSizeRange.x, mEffectParams.mParticleSizeRange.y);
@@ -283,7 +273,7 @@ void ParticleEffect::SpawnParticle(Particle& particle)
 void ParticleEffect::GenerateNewParticles()
 {
     debug_assert(mEffectState == eParticleEffectState_Active);
-    if ((mEffectParams.mMaxParticlesCount == mAliveParticlesCount) ||
+    if ((mParticles.mCapacity == mParticles.mCount) ||
         (mEffectParams.mParticlesPerSecond == 0.0f))
     {
         return;
@@ -294,43 +284,32 @@ void ParticleEffect::GenerateNewParticles()
     if (particlesToGenerate == 0)
         return;
 
-    if (particlesToGenerate > (mEffectParams.mMaxParticlesCount - mAliveParticlesCount))
+    if (particlesToGenerate > (mParticles.mCapacity - mParticles.mCount))
     {
-        particlesToGenerate = (mEffectParams.mMaxParticlesCount - mAliveParticlesCount);
+        particlesToGenerate = (mParticles.mCapacity - mParticles.mCount);
     }
     mParticleTimer -= (particlesToGenerate * timePerParticle);
 
     for (int icurr = 0; icurr < particlesToGenerate; ++icurr)
     {
-        int iNextParticle = mAliveParticlesCount + icurr;
-        debug_assert(iNextParticle < mEffectParams.mMaxParticlesCount);
-        SpawnParticle(mParticles[iNextParticle]);
+        Particle particle;
+        SpawnParticle(particle);
+        mParticles.AddParticle(particle);
     }
-    mAliveParticlesCount += particlesToGenerate;
 }
 
 void ParticleEffect::UpdateAliveParticles(float deltaTime)
 {
-    for (int icurr = 0; icurr < mAliveParticlesCount; )
+    mParticles.UpdateMovement(deltaTime);
+
+    for (int icurr = 0; icurr < mParticles.mCount; )
     {
-        Particle& currParticle = mParticles[icurr];
-        if (UpdateParticle(currParticle, deltaTime))
+        if (UpdateParticleState(icurr, deltaTime))
         {
             ++icurr;
             continue;
         }
-
-        currParticle.mState = eParticleState_Dead;
-        // kill particle
-        if (icurr < (mAliveParticlesCount - 1))
-        {
-            mParticles[icurr] = mParticles[mAliveParticlesCount - 1];
-        }
-        --mAliveParticlesCount;
+        // kill particle, last alive particle takes its place
+        mParticles.RemoveParticle(icurr);
     }
 }
-
-void ParticleEffect::SetRenderdata(ParticleRenderdata* renderdata)
-{
-    mRenderdata = renderdata;
-}
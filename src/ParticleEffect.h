@@ -1,11 +1,8 @@
 #pragma once
 
-#include "ParticleDefs.h"
+#include "ParticlesArray.h"
 #include "RenderView.h"
 
-// forwards
-class ParticleRenderdata;
-
 enum eParticleEffectState
 {
     eParticleEffectState_Initial, // effect is waiting to be configured and launched
@@ -21,7 +18,6 @@ class ParticleEffect final: public cxx::noncopyable
 
 public:
     ParticleEffect() = default;
-    ~ParticleEffect();
 
     void UpdateFrame();
     void DebugDraw(DebugRenderer& debugRender);
@@ -50,21 +46,18 @@ public:
 private:
     void ResetParticles();
     // returns false if particle dead
-    bool UpdateParticle(Particle& particle, float deltaTime);
+    bool UpdateParticleState(int particleIndex, float deltaTime);
     void SpawnParticle(Particle& particle);
+    void SetParticleFade(int particleIndex);
 
     void UpdateAliveParticles(float deltaTime);
     void GenerateNewParticles();
 
-    void SetRenderdata(ParticleRenderdata* renderdata);
-
 private:
     ParticleEffectParams mEffectParams;
     ParticleEmitterShape mEmitterShapeParams;
     eParticleEffectState mEffectState = eParticleEffectState_Initial;
-    std::vector<Particle> mParticles;
+    ParticlesArray mParticles;
     float mParticleTimer = 0.0f;
     float mActivityTimer = 0.0f;
-    int mAliveParticlesCount = 0;
-    ParticleRenderdata* mRenderdata = nullptr; // renderdata is owned by particle renderer
 };
\ No newline at end of file
@@ -1,7 +1,8 @@
 #include "stdafx.h"
 #include "ParticleEffectsManager.h"
-#include "RenderingManager.h"
 #include "cvars.h"
+#include "FrameProfiler.h"
+#include "CarnageGame.h"
 
 //////////////////////////////////////////////////////////////////////////
 // cvars
@@ -21,6 +22,7 @@ ParticleEffectsManager::ParticleEffectsManager()
 
 void ParticleEffectsManager::EnterWorld()
 {
+    mParticlesRand.set_seed((unsigned int) gCarnageGame.mGameRand.generate_int());
     CreateSparksParticleEffect();
 }
 
@@ -31,6 +33,7 @@ void ParticleEffectsManager::ClearWorld()
 
 void ParticleEffectsManager::UpdateFrame()
 {
+    PROFILE_SCOPE("Particles");
     for (ParticleEffect* currEffect: mParticleEffects)
     {
         currEffect->UpdateFrame();
@@ -54,8 +57,6 @@ ParticleEffect* ParticleEffectsManager::CreateParticleEffect(const ParticleEffec
     particleEffect->SetEffectParameters(effectParams);
     particleEffect->SetEmitterShape(emitterShape);
 
-    gRenderManager.RegisterParticleEffect(particleEffect);
-
     return particleEffect;
 }
 
@@ -65,7 +66,6 @@ void ParticleEffectsManager::DestroyParticleEffect(ParticleEffect* particleEffec
 
     if (particleEffect)
     {
-        gRenderManager.UnregisterParticleEffect(particleEffect);
         cxx::erase_elements(mParticleEffects, particleEffect);
         delete particleEffect;
     }
@@ -76,7 +76,6 @@ void ParticleEffectsManager::DestroyParticleEffects()
     mSparksEffect = nullptr;
     for (ParticleEffect* currEffect: mParticleEffects)
     {
-        gRenderManager.UnregisterParticleEffect(currEffect);
         delete currEffect;
     }
     mParticleEffects.clear();
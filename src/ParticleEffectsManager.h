@@ -9,6 +9,9 @@ public:
     // readonly
     std::vector<ParticleEffect*> mParticleEffects;
 
+    // particles might be updated concurrently with gameplay, so they don't share game randomizer
+    cxx::randomizer mParticlesRand;
+
 public:
     ParticleEffectsManager();
 
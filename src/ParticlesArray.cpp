@@ -0,0 +1,165 @@
+#include "stdafx.h"
+#include "ParticlesArray.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define PARTICLES_SIMD_SSE
+    #include <xmmintrin.h>
+#endif
+
+const int ParticlesArrayAlignment = 16;
+
+ParticlesArray::~ParticlesArray()
+{
+    Deinit();
+}
+
+void ParticlesArray::Setup(int capacity)
+{
+    debug_assert(capacity >= 0);
+    if (capacity == mCapacity)
+    {
+        ClearParticles();
+        return;
+    }
+
+    Deinit();
+    if (capacity == 0)
+        return;
+
+    // padding elements never get alive but they are processed by movement kernel
+    int paddedCapacity = ((capacity + SimdWidth - 1) / SimdWidth) * SimdWidth;
+    const int FloatArraysCount = 9;
+    int floatArrayLength = paddedCapacity * (int) sizeof(float);
+    int colorArrayLength = paddedCapacity * (int) sizeof(Color32);
+    int stateArrayLength = paddedCapacity * (int) sizeof(unsigned char);
+    int storageLength = (FloatArraysCount * floatArrayLength) + colorArrayLength + stateArrayLength + ParticlesArrayAlignment;
+
+    mStorage = calloc(storageLength, 1);
+    debug_assert(mStorage);
+    if (mStorage == nullptr)
+        return;
+
+    uintptr_t storageAddress = (uintptr_t) mStorage;
+    unsigned char* arrayPointer = (unsigned char*) ((storageAddress + ParticlesArrayAlignment - 1) & ~((uintptr_t) ParticlesArrayAlignment - 1));
+    float** floatArrays[FloatArraysCount] =
+    {
+        &mPositionX, &mPositionY, &mPositionZ, &mVelocityX, &mVelocityY, &mVelocityZ, &mAge, &mLifeTime, &mSize
+    };
+    for (float** currArray: floatArrays)
+    {
+        *currArray = (float*) arrayPointer;
+        arrayPointer += floatArrayLength;
+    }
+    mColor = (Color32*) arrayPointer;
+    arrayPointer += colorArrayLength;
+    mState = arrayPointer;
+
+    mCapacity = capacity;
+    mCount = 0;
+}
+
+void ParticlesArray::Deinit()
+{
+    if (mStorage)
+    {
+        free(mStorage);
+        mStorage = nullptr;
+    }
+    mPositionX = nullptr;
+    mPositionY = nullptr;
+    mPositionZ = nullptr;
+    mVelocityX = nullptr;
+    mVelocityY = nullptr;
+    mVelocityZ = nullptr;
+    mAge = nullptr;
+    mLifeTime = nullptr;
+    mSize = nullptr;
+    mColor = nullptr;
+    mState = nullptr;
+    mCapacity = 0;
+    mCount = 0;
+}
+
+void ParticlesArray::ClearParticles()
+{
+    mCount = 0;
+}
+
+bool ParticlesArray::AddParticle(const Particle& particle)
+{
+    if (mCount == mCapacity)
+        return false;
+
+    int particleIndex = mCount++;
+    mPositionX[particleIndex] = particle.mPosition.x;
+    mPositionY[particleIndex] = particle.mPosition.y;
+    mPositionZ[particleIndex] = particle.mPosition.z;
+    mVelocityX[particleIndex] = particle.mVelocity.x;
+    mVelocityY[particleIndex] = particle.mVelocity.y;
+    mVelocityZ[particleIndex] = particle.mVelocity.z;
+    mAge[particleIndex] = particle.mAge;
+    mLifeTime[particleIndex] = particle.mLifeTime;
+    mSize[particleIndex] = particle.mSize;
+    mColor[particleIndex] = particle.mColor;
+    mState[particleIndex] = (unsigned char) particle.mState;
+    return true;
+}
+
+void ParticlesArray::RemoveParticle(int particleIndex)
+{
+    debug_assert(particleIndex < mCount);
+
+    int lastIndex = --mCount;
+    if (particleIndex == lastIndex)
+        return;
+
+    mPositionX[particleIndex] = mPositionX[lastIndex];
+    mPositionY[particleIndex] = mPositionY[lastIndex];
+    mPositionZ[particleIndex] = mPositionZ[lastIndex];
+    mVelocityX[particleIndex] = mVelocityX[lastIndex];
+    mVelocityY[particleIndex] = mVelocityY[lastIndex];
+    mVelocityZ[particleIndex] = mVelocityZ[lastIndex];
+    mAge[particleIndex] = mAge[lastIndex];
+    mLifeTime[particleIndex] = mLifeTime[lastIndex];
+    mSize[particleIndex] = mSize[lastIndex];
+    mColor[particleIndex] = mColor[lastIndex];
+    mState[particleIndex] = mState[lastIndex];
+}
+
+void ParticlesArray::UpdateMovement(float deltaTime)
+{
+    // process whole simd groups, tail goes to padding elements
+    int particlesCount = ((mCount + SimdWidth - 1) / SimdWidth) * SimdWidth;
+
+#ifdef PARTICLES_SIMD_SSE
+    const __m128 deltaTime4 = _mm_set1_ps(deltaTime);
+    for (int icurr = 0; icurr < particlesCount; icurr += SimdWidth)
+    {
+        _mm_store_ps(mAge + icurr, _mm_add_ps(_mm_load_ps(mAge + icurr), deltaTime4));
+
+        __m128 positionX = _mm_add_ps(_mm_load_ps(mPositionX + icurr), _mm_mul_ps(_mm_load_ps(mVelocityX + icurr), deltaTime4));
+        __m128 positionY = _mm_add_ps(_mm_load_ps(mPositionY + icurr), _mm_mul_ps(_mm_load_ps(mVelocityY + icurr), deltaTime4));
+        __m128 positionZ = _mm_add_ps(_mm_load_ps(mPositionZ + icurr), _mm_mul_ps(_mm_load_ps(mVelocityZ + icurr), deltaTime4));
+        _mm_store_ps(mPositionX + icurr, positionX);
+        _mm_store_ps(mPositionY + icurr, positionY);
+        _mm_store_ps(mPositionZ + icurr, positionZ);
+    }
+#else
+    for (int icurr = 0; icurr < particlesCount; ++icurr)
+    {
+        mAge[icurr] += deltaTime;
+        mPositionX[icurr] += mVelocityX[icurr] * deltaTime;
+        mPositionY[icurr] += mVelocityY[icurr] * deltaTime;
+        mPositionZ[icurr] += mVelocityZ[icurr] * deltaTime;
+    }
+#endif
+}
+
+void ParticlesArray::StopParticle(int particleIndex)
+{
+    debug_assert(particleIndex < mCount);
+
+    mVelocityX[particleIndex] = 0.0f;
+    mVelocityY[particleIndex] = 0.0f;
+    mVelocityZ[particleIndex] = 0.0f;
+}
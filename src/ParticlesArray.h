@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ParticleDefs.h"
+
+// Particles storage in structure of arrays layout
+// Each attribute array is 16 bytes aligned and padded to multiple of 4 elements, so movement kernel processes 4 particles at once
+class ParticlesArray final: public cxx::noncopyable
+{
+public:
+    static const int SimdWidth = 4;
+
+    // readonly
+    float* mPositionX = nullptr;
+    float* mPositionY = nullptr;
+    float* mPositionZ = nullptr;
+    float* mVelocityX = nullptr; // gravity is included
+    float* mVelocityY = nullptr;
+    float* mVelocityZ = nullptr;
+    float* mAge = nullptr; // current age, in seconds
+    float* mLifeTime = nullptr; // in seconds
+    float* mSize = nullptr;
+    Color32* mColor = nullptr;
+    unsigned char* mState = nullptr; // eParticleState
+
+    int mCapacity = 0;
+    int mCount = 0; // alive particles occupy range [0, mCount)
+
+public:
+    ParticlesArray() = default;
+    ~ParticlesArray();
+
+    // Allocate storage for specified number of particles, existing particles are discarded
+    // @param capacity: Max particles count
+    void Setup(int capacity);
+    void Deinit();
+
+    // Kill all particles but keep storage
+    void ClearParticles();
+
+    // Append particle to alive range
+    // @returns false if there is no free space
+    bool AddParticle(const Particle& particle);
+
+    // Kill particle by moving last alive particle in its place, so order is not preserved
+    // @param particleIndex: Alive particle index
+    void RemoveParticle(int particleIndex);
+
+    // Advance age and positions of all alive particles
+    // @param deltaTime: Time step, in seconds
+    void UpdateMovement(float deltaTime);
+
+    // Stop particle movement
+    // @param particleIndex: Alive particle index
+    void StopParticle(int particleIndex);
+
+private:
+    void* mStorage = nullptr;
+};
@@ -13,6 +13,7 @@
 #include "Collision.h"
 #include "GameObjectHelpers.h"
 #include "AudioManager.h"
+#include "FrameProfiler.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -80,6 +81,7 @@ void PhysicsManager::ClearWorld()
 
 void PhysicsManager::UpdateFrame()
 {
+    PROFILE_SCOPE("Physics");
     mSimulationTimeAccumulator += gTimeManager.mGameFrameDelta;
 
     while (mSimulationTimeAccumulator >= mSimulationStepTime)
@@ -93,6 +95,7 @@ void PhysicsManager::UpdateFrame()
 
 void PhysicsManager::ProcessSimulationStep()
 {
+    PROFILE_SCOPE("Physics step");
     const int velocityIterations = 6;
     const int positionIterations = 4;
 
@@ -110,6 +110,7 @@ void RenderProgram::UploadCameraTransformMatrices(GameCamera& gameCamera)
         SET_UNIFORM(eRenderUniform_ProjectionMatrix, gameCamera.mProjectionMatrix);
         SET_UNIFORM(eRenderUniform_ViewProjectionMatrix, gameCamera.mViewProjectionMatrix);
         SET_UNIFORM(eRenderUniform_CameraPosition, gameCamera.mPosition);
+        SET_UNIFORM(eRenderUniform_ViewportSize, glm::vec2(gameCamera.mViewportRect.w, gameCamera.mViewportRect.h));
 
         #undef SET_UNIFORM
     }
@@ -133,6 +134,7 @@ void RenderProgram::UploadCameraTransformMatrices(GameCamera2D& gameCamera)
         SET_UNIFORM(eRenderUniform_ProjectionMatrix, gameCamera.mProjectionMatrix);
         SET_UNIFORM(eRenderUniform_ViewProjectionMatrix, gameCamera.mProjectionMatrix);
         SET_UNIFORM(eRenderUniform_CameraPosition, glm::vec3(0.0f));
+        SET_UNIFORM(eRenderUniform_ViewportSize, glm::vec2(gameCamera.mViewportRect.w, gameCamera.mViewportRect.h));
 
         #undef SET_UNIFORM
     }
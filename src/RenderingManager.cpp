@@ -8,8 +8,11 @@
 #include "AiManager.h"
 #include "TrafficManager.h"
 #include "ParticleEffectsManager.h"
-#include "ParticleRenderdata.h"
 #include "CarnageGame.h"
+#include "FrameProfiler.h"
+#include "cvars.h"
+
+CvarBoolean gCvarGraphicsInstancedSprites("r_instancedSprites", true, "Render sprites using hardware instancing", CvarFlags_Archive);
 
 RenderingManager gRenderManager;
 
@@ -18,6 +21,7 @@ RenderingManager::RenderingManager()
     , mGuiTexColorProgram("shaders/gui.glsl")
     , mCityMeshProgram("shaders/city_mesh.glsl")
     , mSpritesProgram("shaders/sprites.glsl")
+    , mSpritesInstancedProgram("shaders/sprites_instanced.glsl")
     , mDebugProgram("shaders/debug.glsl")
     , mParticleProgram("shaders/particle.glsl")
 {
@@ -48,6 +52,14 @@ void RenderingManager::Deinit()
     mActiveRenderViews.clear();
     mDebugRenderer.Deinit();
     mMapRenderer.Deinit();
+    if (mQuadsIndexBuffer)
+    {
+        gGraphicsDevice.DestroyBuffer(mQuadsIndexBuffer);
+        mQuadsIndexBuffer = nullptr;
+    }
+    mQuadsIndexBufferCapacity = 0;
+    mParticlesBuffer.Deinit();
+    mParticleInstances.clear();
     gSpriteManager.Cleanup();
 
     FreeRenderPrograms();
@@ -55,9 +67,11 @@ void RenderingManager::Deinit()
 
 void RenderingManager::RenderFrame()
 {
+    PROFILE_SCOPE("Render");
     gGraphicsDevice.ClearScreen();
     gSpriteManager.RenderFrameBegin();
     mMapRenderer.RenderFrameBegin();
+    UploadParticleEffects();
 
     Rect viewportRectangle = gGraphicsDevice.mViewportRect;
     for (RenderView* currRenderview: mActiveRenderViews)
@@ -96,6 +110,7 @@ void RenderingManager::FreeRenderPrograms()
     mCityMeshProgram.Deinit();
     mGuiTexColorProgram.Deinit();
     mSpritesProgram.Deinit();
+    mSpritesInstancedProgram.Deinit();
     mParticleProgram.Deinit();
     mDebugProgram.Deinit();
 }
@@ -106,6 +121,7 @@ bool RenderingManager::InitRenderPrograms()
     mGuiTexColorProgram.Initialize();
     mCityMeshProgram.Initialize(); 
     mSpritesProgram.Initialize();
+    mSpritesInstancedProgram.Initialize();
     mParticleProgram.Initialize();
     mDebugProgram.Initialize();
 
@@ -120,10 +136,19 @@ void RenderingManager::ReloadRenderPrograms()
     mGuiTexColorProgram.Reinitialize();
     mDebugProgram.Reinitialize();
     mSpritesProgram.Reinitialize();
+    mSpritesInstancedProgram.Reinitialize();
     mParticleProgram.Reinitialize();
     mCityMeshProgram.Reinitialize();
 }
 
+RenderProgram& RenderingManager::GetSpritesProgram()
+{
+    if (gCvarGraphicsInstancedSprites.mValue && mSpritesInstancedProgram.IsProgramInited())
+        return mSpritesInstancedProgram;
+
+    return mSpritesProgram;
+}
+
 void RenderingManager::AttachRenderView(RenderView* renderview)
 {
     debug_assert(renderview);
@@ -150,55 +175,48 @@ void RenderingManager::DetachRenderView(RenderView* renderview)
     debug_assert(false);
 }
 
-void RenderingManager::RegisterParticleEffect(ParticleEffect* particleEffect)
+void RenderingManager::UploadParticleEffects()
 {
-    debug_assert(particleEffect);
-
-    if (particleEffect == nullptr)
-        return;
+    PROFILE_SCOPE("Particles upload");
 
-    if (particleEffect->mRenderdata)
+    mParticleInstances.clear();
+    for (ParticleEffect* currEffect: gParticleManager.mParticleEffects)
     {
-        debug_assert(false);
-        return;
-    }
+        if (currEffect->IsEffectInactive())
+            continue;
 
-    ParticleRenderdata* renderdata = new ParticleRenderdata;
-    particleEffect->SetRenderdata(renderdata);
-}
+        const ParticlesArray& particles = currEffect->mParticles;
+        if (particles.mCount == 0)
+            continue;
 
-void RenderingManager::UnregisterParticleEffect(ParticleEffect* particleEffect)
-{
-    debug_assert(particleEffect);
+        size_t firstInstance = mParticleInstances.size();
+        mParticleInstances.resize(firstInstance + particles.mCount);
+
+        ParticleVertex* instances = mParticleInstances.data() + firstInstance;
+        for (int icurrParticle = 0; icurrParticle < particles.mCount; ++icurrParticle)
+        {
+            ParticleVertex& particleInstance = instances[icurrParticle];
+            particleInstance.mPositionSize.x = particles.mPositionX[icurrParticle];
+            particleInstance.mPositionSize.y = particles.mPositionY[icurrParticle];
+            particleInstance.mPositionSize.z = particles.mPositionZ[icurrParticle];
+            particleInstance.mPositionSize.w = particles.mSize[icurrParticle];
+            particleInstance.mColor = particles.mColor[icurrParticle];
+        }
+    }
 
-    if (particleEffect == nullptr)
+    if (mParticleInstances.empty())
         return;
 
-    ParticleRenderdata* renderdata = particleEffect->mRenderdata;
-    if (renderdata)
-    {
-        renderdata->DestroyVertexbuffer();
-        delete renderdata;
-    }
-    particleEffect->SetRenderdata(nullptr);
+    mParticlesBuffer.SetVertices(mParticleInstances.size() * Sizeof_ParticleVertex, mParticleInstances.data());
 }
 
 void RenderingManager::RenderParticleEffects(RenderView* renderview)
 {
-    bool hasActiveParticleEffects = false;
-    // check if there is something to draw
-    for (ParticleEffect* currEffect: gParticleManager.mParticleEffects)
-    {
-        if (currEffect->IsEffectActive())
-        {
-            hasActiveParticleEffects = true;
-            break;
-        }
-    }
-
-    if (!hasActiveParticleEffects)
+    // particles of all effects are drawn at once
+    if (mParticleInstances.empty())
         return;
 
+    PROFILE_SCOPE("Particles draw");
     debug_assert(renderview);
 
     mParticleProgram.Activate();
@@ -210,74 +228,45 @@ void RenderingManager::RenderParticleEffects(RenderView* renderview)
         .Disable(RenderStateFlags_DepthWrite);
     gGraphicsDevice.SetRenderStates(renderStates);
 
-    for (ParticleEffect* currEffect: gParticleManager.mParticleEffects)
-    {
-        if (currEffect->IsEffectInactive())
-            continue;
-
-        RenderParticleEffect(renderview, currEffect);
-    }
+    ParticleVertex_Format vFormat;
+    mParticlesBuffer.Bind(vFormat);
+    gGraphicsDevice.RenderPrimitivesInstanced(ePrimitiveType_TriangleStrip, 0, 4, mParticleInstances.size());
 
     mParticleProgram.Deactivate();
 }
 
-void RenderingManager::RenderParticleEffect(RenderView* renderview, ParticleEffect* particleEffect)
+GpuBuffer* RenderingManager::GetQuadsIndexBuffer(int quadsCount)
 {
-    ParticleRenderdata* renderdata = particleEffect->mRenderdata;
-    if (renderdata == nullptr)
-    {
-        debug_assert(false); // effect is not registered - something is wrong
-        return; 
-    }
+    debug_assert(quadsCount > 0);
+    if (mQuadsIndexBuffer && quadsCount <= mQuadsIndexBufferCapacity)
+        return mQuadsIndexBuffer;
 
-    const int NumParticles = particleEffect->mAliveParticlesCount;
-    if (NumParticles == 0)
-        return;
+    const int MinQuadsCount = 4096;
+    int newCapacity = (int) cxx::get_next_pot(std::max(quadsCount, MinQuadsCount));
 
-    // update vertices
-    if (renderdata->mIsInvalidated)
+    std::vector<DrawIndex> indices(newCapacity * 6);
+    for (int iquad = 0; iquad < newCapacity; ++iquad)
     {
-        renderdata->ResetInvalidated();
-        if (!renderdata->PrepareVertexbuffer(particleEffect->mParticles.size() * Sizeof_ParticleVertex))
-        {
-            debug_assert(false);
-            return;
-        }
-
-        GpuBuffer* vertexbuffer = renderdata->mVertexBuffer;
-        debug_assert(vertexbuffer);
-        ParticleVertex* vertices = vertexbuffer->LockData<ParticleVertex>(BufferAccess_UnsynchronizedWrite | BufferAccess_InvalidateBuffer);
-        if (vertices == nullptr)
-        {
-            debug_assert(false);
-            return;
-        }
-
-        for (int icurrParticle = 0; icurrParticle < NumParticles; ++icurrParticle)
-        {
-            ParticleVertex& particleVertex = vertices[icurrParticle];
-            const Particle& srcParticle = particleEffect->mParticles[icurrParticle];
-            particleVertex.mPositionSize.x = srcParticle.mPosition.x;
-            particleVertex.mPositionSize.y = srcParticle.mPosition.y;
-            particleVertex.mPositionSize.z = srcParticle.mPosition.z;
-            particleVertex.mPositionSize.w = srcParticle.mSize;
-            particleVertex.mColor = srcParticle.mColor;
-        }
-
-        if (!vertexbuffer->Unlock())
-        {
-            debug_assert(false);
-            return;
-        }
+        DrawIndex vertexOffset = iquad * 4;
+        DrawIndex* quadIndices = &indices[iquad * 6];
+        quadIndices[0] = vertexOffset + 0;
+        quadIndices[1] = vertexOffset + 1;
+        quadIndices[2] = vertexOffset + 2;
+        quadIndices[3] = vertexOffset + 1;
+        quadIndices[4] = vertexOffset + 2;
+        quadIndices[5] = vertexOffset + 3;
     }
 
-    if (renderdata->mVertexBuffer == nullptr)
+    unsigned int dataLength = indices.size() * Sizeof_DrawIndex;
+    if (mQuadsIndexBuffer == nullptr)
+    {
+        mQuadsIndexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Indices, eBufferUsage_Static, dataLength, indices.data());
+        debug_assert(mQuadsIndexBuffer);
+    }
+    else if (!mQuadsIndexBuffer->Setup(eBufferUsage_Static, dataLength, indices.data()))
     {
         debug_assert(false);
-        return;
     }
-
-    ParticleVertex_Format vFormat;
-    gGraphicsDevice.BindVertexBuffer(renderdata->mVertexBuffer, vFormat);
-    gGraphicsDevice.RenderPrimitives(ePrimitiveType_Points, 0, NumParticles);
+    mQuadsIndexBufferCapacity = newCapacity;
+    return mQuadsIndexBuffer;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "RenderProgram.h"
 #include "MapRenderer.h"
 #include "DebugRenderer.h"
+#include "TrimeshBuffer.h"
 #include "ParticleEffect.h"
 
 class RenderView;
@@ -16,6 +17,7 @@ public:
     RenderProgram mCityMeshProgram;
     RenderProgram mGuiTexColorProgram;
     RenderProgram mSpritesProgram;
+    RenderProgram mSpritesInstancedProgram;
     RenderProgram mDebugProgram;
     RenderProgram mParticleProgram;
 
@@ -40,17 +42,23 @@ public:
 
     // Force reload all render programs
     void ReloadRenderPrograms();
+
+    // Get render program which should be used to draw sprites, instanced or regular one
+    // Sprite batch detects rendering mode by currently active program
+    RenderProgram& GetSpritesProgram();
     
     void AttachRenderView(RenderView* renderview);
     void DetachRenderView(RenderView* renderview);
 
-    // Register particle effect for rendering
-    void RegisterParticleEffect(ParticleEffect* particleEffect);
-    void UnregisterParticleEffect(ParticleEffect* particleEffect);
+    // Get static indices buffer shared between all quads renderers, indices of each quad are v+0,1,2,1,2,3
+    // Buffer grows on demand so it should not be cached
+    // @param quadsCount: Minimum number of quads that buffer must fit
+    GpuBuffer* GetQuadsIndexBuffer(int quadsCount);
 
 private:
+    // Gather particles of all active effects into single instances stream, it is shared between render views
+    void UploadParticleEffects();
     void RenderParticleEffects(RenderView* renderview);
-    void RenderParticleEffect(RenderView* renderview, ParticleEffect* particleEffect);
 
 private:
     bool InitRenderPrograms();
@@ -58,6 +66,11 @@ private:
 
 private:
     DebugRenderer mDebugRenderer;
+    GpuBuffer* mQuadsIndexBuffer = nullptr;
+    int mQuadsIndexBufferCapacity = 0; // max quads count
+
+    TrimeshBuffer mParticlesBuffer;
+    std::vector<ParticleVertex> mParticleInstances;
 };
 
 extern RenderingManager gRenderManager;
\ No newline at end of file
@@ -26,6 +26,7 @@ enum SfxFlags
     SfxFlags_None        = 0,
     SfxFlags_Loop        = BIT(0),
     SfxFlags_RandomPitch = BIT(1), // randomize pitch a bit
+    SfxFlags_HighPriority = BIT(2), // important gameplay sound, such as explosion or player weapon shot
 };
 
 decl_enum_as_flags(SfxFlags);
@@ -39,6 +40,16 @@ enum SfxEmitterFlags
 
 decl_enum_as_flags(SfxEmitterFlags);
 
+// sound priority class, more important sounds win hardware audio sources
+enum eSfxPriority
+{
+    eSfxPriority_Low, // looped ambient sounds
+    eSfxPriority_Normal,
+    eSfxPriority_High,
+    eSfxPriority_Critical, // announcer voice
+    eSfxPriority_COUNT
+};
+
 // level sound constants
 enum : SfxSampleIndex
 {
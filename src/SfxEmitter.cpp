@@ -39,6 +39,7 @@ void SfxEmitter::ReleaseEmitter(bool stopSounds)
     if (!stopSounds)
     {
         mAudioChannels.clear();
+        gAudioManager.DetachPendingSounds(this);
     }
     gAudioManager.DestroyEmitter(this);
 }
@@ -56,23 +57,38 @@ void SfxEmitter::UpdateEmitterParams(const glm::vec3& emitterPosition)
     }
 }
 
-void SfxEmitter::UpdateSounds()
+void SfxEmitter::UpdateSounds(float deltaTime)
 {
     for (SfxChannel& currChannel: mAudioChannels)
     {
-        if (currChannel.mHardwareSource == nullptr)
+        if (!currChannel.mIsActive || currChannel.mIsPaused)
             continue;
 
-        if (currChannel.mHardwareSource->IsStopped())
+        // real voice is finished once its source is stopped
+        if (currChannel.mHardwareSource && currChannel.mHardwareSource->IsStopped())
         {
             currChannel.mHardwareSource = nullptr;
+            currChannel.mIsActive = false;
             continue;
         }
+
+        currChannel.mPlaybackTime += deltaTime * currChannel.mVoicePitch;
+
+        // virtual voice is finished once its playback time is out
+        if (currChannel.mHardwareSource == nullptr && (currChannel.mSfxFlags & SfxFlags_Loop) == 0)
+        {
+            if (currChannel.mPlaybackTime >= currChannel.mSfxSample->mSampleBuffer->GetBufferDurationSeconds())
+            {
+                currChannel.mIsActive = false;
+            }
+        }
     }
 }
 
 void SfxEmitter::StopAllSounds()
 {
+    gAudioManager.CancelPendingSounds(this, -1);
+
     for (SfxChannel& currChannel: mAudioChannels)
     {
         if (currChannel.mHardwareSource)
@@ -80,6 +96,8 @@ void SfxEmitter::StopAllSounds()
             currChannel.mHardwareSource->Stop();
             currChannel.mHardwareSource = nullptr;
         }
+        currChannel.mIsActive = false;
+        currChannel.mIsPaused = false;
     }
 }
 
@@ -87,6 +105,10 @@ void SfxEmitter::PauseAllSounds()
 {
     for (SfxChannel& currChannel: mAudioChannels)
     {
+        if (!currChannel.mIsActive)
+            continue;
+
+        currChannel.mIsPaused = true;
         if (currChannel.mHardwareSource)
         {
             currChannel.mHardwareSource->Pause();
@@ -98,6 +120,10 @@ void SfxEmitter::ResumeAllSounds()
 {
     for (SfxChannel& currChannel: mAudioChannels)
     {
+        if (!currChannel.mIsPaused)
+            continue;
+
+        currChannel.mIsPaused = false;
         if (currChannel.mHardwareSource)
         {
             currChannel.mHardwareSource->Resume();
@@ -118,37 +144,74 @@ bool SfxEmitter::StartSound(int ichannel, SfxSample* sfxSample, SfxFlags sfxFlag
         mAudioChannels.resize(ichannel + 1);
     }
 
+    // sound that is waiting for its sample is replaced
+    gAudioManager.CancelPendingSounds(this, ichannel);
+
     SfxChannel& channel = mAudioChannels[ichannel];
     if (channel.mHardwareSource)
     {
         channel.mHardwareSource->Stop();
     }
-    if (channel.mHardwareSource == nullptr)
-    {
-        channel.mHardwareSource = gAudioManager.GetFreeAudioSource();
-        if (channel.mHardwareSource == nullptr)
-            return false; // out of audio sources
-    }
 
     channel.mSfxFlags = sfxFlags;
     channel.mSfxSample = sfxSample;
+    channel.mIsActive = true;
+    channel.mIsPaused = false;
+    channel.mPlaybackTime = 0.0f;
 
-    channel.mHardwareSource->Stop();
-    if (!channel.mHardwareSource->SetSampleBuffer(sfxSample->mSampleBuffer))
+    // announcer voice must be heard, looped sounds are usually ambient
+    channel.mPriority = eSfxPriority_Normal;
+    if (sfxSample->mSfxType == eSfxSampleType_Voice)
     {
-        debug_assert(false);
+        channel.mPriority = eSfxPriority_Critical;
+    }
+    else if ((sfxFlags & SfxFlags_HighPriority) > 0)
+    {
+        channel.mPriority = eSfxPriority_High;
+    }
+    else if ((sfxFlags & SfxFlags_Loop) > 0)
+    {
+        channel.mPriority = eSfxPriority_Low;
     }
 
-    float pitchValue = 1.0f;
     if ((sfxFlags & SfxFlags_RandomPitch) > 0)
     {
-        pitchValue = gAudioManager.NextRandomPitch();
+        channel.mVoicePitch = gAudioManager.NextRandomPitch();
     }
     else
     {
-        pitchValue = channel.mPitchValue;
+        channel.mVoicePitch = channel.mPitchValue;
+    }
+
+    // voice starts virtual if it is not audible enough to get hardware source
+    AudioSource* audioSource = channel.mHardwareSource;
+    channel.mHardwareSource = nullptr;
+    if (audioSource == nullptr)
+    {
+        audioSource = gAudioManager.AcquireAudioSource(this, ichannel);
+    }
+    if (audioSource)
+    {
+        AttachVoiceSource(ichannel, audioSource);
+    }
+    gAudioManager.RegisterActiveEmitter(this);
+    return true;
+}
+
+void SfxEmitter::AttachVoiceSource(int ichannel, AudioSource* audioSource)
+{
+    SfxChannel& channel = mAudioChannels[ichannel];
+    debug_assert(channel.mIsActive);
+    debug_assert(channel.mHardwareSource == nullptr);
+
+    channel.mHardwareSource = audioSource;
+    channel.mHardwareSource->Stop();
+    if (!channel.mHardwareSource->SetSampleBuffer(channel.mSfxSample->mSampleBuffer))
+    {
+        debug_assert(false);
     }
-    if (!channel.mHardwareSource->SetPitch(pitchValue) ||
+
+    if (!channel.mHardwareSource->SetPitch(channel.mVoicePitch) ||
         !channel.mHardwareSource->SetGain(channel.mGainValue * gAudioManager.mSoundsGain)) 
     {
         debug_assert(false);
@@ -159,16 +222,42 @@ bool SfxEmitter::StartSound(int ichannel, SfxSample* sfxSample, SfxFlags sfxFlag
         debug_assert(false);
     }
 
-    if (!channel.mHardwareSource->Start((sfxFlags & SfxFlags_Loop) > 0))
+    bool isLoop = (channel.mSfxFlags & SfxFlags_Loop) > 0;
+    if (!channel.mHardwareSource->Start(isLoop))
     {
         debug_assert(false);
     }
-    gAudioManager.RegisterActiveEmitter(this);
-    return true;
+
+    // continue virtual voice from where it would be
+    if (channel.mPlaybackTime > 0.0f)
+    {
+        float playbackOffset = channel.mPlaybackTime;
+        float sampleDuration = channel.mSfxSample->mSampleBuffer->GetBufferDurationSeconds();
+        if (isLoop && sampleDuration > 0.0f)
+        {
+            playbackOffset = fmodf(playbackOffset, sampleDuration);
+        }
+        if (playbackOffset < sampleDuration)
+        {
+            channel.mHardwareSource->SetPlaybackOffset(playbackOffset);
+        }
+    }
+}
+
+void SfxEmitter::DetachVoiceSource(int ichannel)
+{
+    SfxChannel& channel = mAudioChannels[ichannel];
+    if (channel.mHardwareSource)
+    {
+        channel.mHardwareSource->Stop();
+        channel.mHardwareSource = nullptr;
+    }
 }
 
 bool SfxEmitter::StopSound(int ichannel)
 {
+    gAudioManager.CancelPendingSounds(this, ichannel);
+
     if ((ichannel < 0) || (ichannel >= (int) mAudioChannels.size()))
         return false;
 
@@ -178,6 +267,8 @@ bool SfxEmitter::StopSound(int ichannel)
         channel.mHardwareSource->Stop();
         channel.mHardwareSource = nullptr;
     }
+    channel.mIsActive = false;
+    channel.mIsPaused = false;
     return true;
 }
 
@@ -186,20 +277,16 @@ bool SfxEmitter::IsPlaying(int ichannel) const
     if ((ichannel < 0) || (ichannel >= (int) mAudioChannels.size()))
         return false;
 
+    // virtual voice is still playing
     const SfxChannel& channel = mAudioChannels[ichannel];
-    if (channel.mHardwareSource)
-    {
-        return channel.mHardwareSource->IsPlaying();
-    }
-
-    return false;
+    return channel.mIsActive && !channel.mIsPaused;
 }
 
 bool SfxEmitter::IsActiveEmitter() const
 {
     for (const SfxChannel& currChannel: mAudioChannels)
     {
-        if (currChannel.mHardwareSource && currChannel.mHardwareSource)
+        if (currChannel.mIsActive)
             return true;
     }
     return false;
@@ -211,12 +298,7 @@ bool SfxEmitter::IsPaused(int ichannel) const
         return false;
 
     const SfxChannel& channel = mAudioChannels[ichannel];
-    if (channel.mHardwareSource)
-    {
-        return channel.mHardwareSource->IsPaused();
-    }
-
-    return false;
+    return channel.mIsActive && channel.mIsPaused;
 }
 
 bool SfxEmitter::PauseSound(int ichannel)
@@ -225,12 +307,16 @@ bool SfxEmitter::PauseSound(int ichannel)
         return false;
 
     SfxChannel& channel = mAudioChannels[ichannel];
+    if (!channel.mIsActive)
+        return false;
+
+    channel.mIsPaused = true;
     if (channel.mHardwareSource)
     {
         return channel.mHardwareSource->Pause();
     }
 
-    return false;
+    return true;
 }
 
 bool SfxEmitter::ResumeSound(int ichannel)
@@ -239,12 +325,16 @@ bool SfxEmitter::ResumeSound(int ichannel)
         return false;
 
     SfxChannel& channel = mAudioChannels[ichannel];
+    if (!channel.mIsPaused)
+        return false;
+
+    channel.mIsPaused = false;
     if (channel.mHardwareSource)
     {
         return channel.mHardwareSource->Resume();
     }
 
-    return false;
+    return true;
 }
 
 bool SfxEmitter::SetPitch(int ichannel, float pitchValue)
@@ -253,13 +343,18 @@ bool SfxEmitter::SetPitch(int ichannel, float pitchValue)
         return false;
 
     SfxChannel& channel = mAudioChannels[ichannel];
-    if (channel.mHardwareSource)
+    if (channel.mIsActive)
     {
-        if (channel.mPitchValue == pitchValue)
+        channel.mPitchValue = pitchValue;
+        if (channel.mVoicePitch == pitchValue)
             return true;
 
-        channel.mPitchValue = pitchValue;
-        return channel.mHardwareSource->SetPitch(pitchValue);
+        channel.mVoicePitch = pitchValue;
+        if (channel.mHardwareSource)
+        {
+            return channel.mHardwareSource->SetPitch(pitchValue);
+        }
+        return true;
     }
 
     return false;
@@ -271,13 +366,17 @@ bool SfxEmitter::SetGain(int ichannel, float gainValue)
         return false;
 
     SfxChannel& channel = mAudioChannels[ichannel];
-    if (channel.mHardwareSource)
+    if (channel.mIsActive)
     {
         if (channel.mGainValue == gainValue)
             return true;
 
         channel.mGainValue = gainValue;
-        return channel.mHardwareSource->SetGain(gainValue * gAudioManager.mSoundsGain);
+        if (channel.mHardwareSource)
+        {
+            return channel.mHardwareSource->SetGain(gainValue * gAudioManager.mSoundsGain);
+        }
+        return true;
     }
 
     return false;
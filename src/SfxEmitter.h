@@ -22,6 +22,8 @@ private:
     eSfxSampleType mSfxType;
     SfxSampleIndex mSfxIndex;
     AudioSampleBuffer* mSampleBuffer;
+    int mDataLength = 0; // bytes
+    unsigned int mLastUsedFrame = 0; // audio update frame when sample was last requested
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -36,14 +38,20 @@ private:
     //////////////////////////////////////////////////////////////////////////
 
     // virtual audio channel state
+    // active channel is a voice which is either real, when it has hardware source, or virtual
     struct SfxChannel
     {
-        AudioSource* mHardwareSource = nullptr; // channel is only active when source set
+        AudioSource* mHardwareSource = nullptr;
         SfxSample* mSfxSample = nullptr;
         SfxFlags mSfxFlags = SfxFlags_None;
+        eSfxPriority mPriority = eSfxPriority_Normal;
+        bool mIsActive = false;
+        bool mIsPaused = false;
+        float mPlaybackTime = 0.0f; // sample time since sound start, seconds
         // audio params
         float mPitchValue = 1.0f;
         float mGainValue = 1.0f;
+        float mVoicePitch = 1.0f; // actual pitch of current sound
     };
 
     //////////////////////////////////////////////////////////////////////////
@@ -60,7 +68,7 @@ public:
     void ReleaseEmitter(bool stopSounds);
 
     void UpdateEmitterParams(const glm::vec3& emitterPosition);
-    void UpdateSounds();
+    void UpdateSounds(float deltaTime);
 
     void StopAllSounds();
     void PauseAllSounds();
@@ -79,6 +87,11 @@ public:
     bool IsAutoreleaseEmitter() const;
     bool IsActiveEmitter() const;
 
+private:
+    // Move voice between hardware source and virtual state, playback position is preserved
+    void AttachVoiceSource(int ichannel, AudioSource* audioSource);
+    void DetachVoiceSource(int ichannel);
+
 private:
     std::vector<SfxChannel> mAudioChannels;
     glm::vec3 mEmitterPosition;
@@ -4,10 +4,69 @@
 #include "SpriteManager.h"
 #include "RenderView.h"
 #include "GpuTexture2D.h"
+#include "FrameProfiler.h"
+#include "GpuProgram.h"
 
 const unsigned int NumVerticesPerSprite = 4;
 const unsigned int NumIndicesPerSprite = 6;
 
+// map float value to unsigned integer preserving order
+inline unsigned int FloatToSortableBits(float value)
+{
+    if (value == 0.0f) // negative zero
+    {
+        value = 0.0f;
+    }
+    unsigned int valueBits;
+    ::memcpy(&valueBits, &value, sizeof(valueBits));
+    return (valueBits & 0x80000000U) ? ~valueBits : (valueBits | 0x80000000U);
+}
+
+// least significant digit radix sort, it is stable so sprites with equal keys keep submission order
+// @param elements: Elements to sort, result is stored here
+// @param tempElements: Scratch buffer
+template<typename TElement>
+inline void RadixSortElements(std::vector<TElement>& elements, std::vector<TElement>& tempElements)
+{
+    const int NumPasses = sizeof(elements[0].mSortKey);
+    const int NumBuckets = 256;
+
+    unsigned int histograms[NumPasses][NumBuckets] = {};
+    for (const TElement& currElement: elements)
+    {
+        for (int ipass = 0; ipass < NumPasses; ++ipass)
+        {
+            ++histograms[ipass][(currElement.mSortKey >> (ipass * 8)) & 0xFF];
+        }
+    }
+
+    unsigned int numElements = elements.size();
+    tempElements.resize(numElements);
+
+    for (int ipass = 0; ipass < NumPasses; ++ipass)
+    {
+        const int digitShift = ipass * 8;
+        unsigned int* histogram = histograms[ipass];
+        // all keys share same digit, nothing to sort
+        if (histogram[(elements[0].mSortKey >> digitShift) & 0xFF] == numElements)
+            continue;
+
+        unsigned int bucketOffset = 0;
+        for (int ibucket = 0; ibucket < NumBuckets; ++ibucket)
+        {
+            unsigned int bucketSize = histogram[ibucket];
+            histogram[ibucket] = bucketOffset;
+            bucketOffset += bucketSize;
+        }
+
+        for (const TElement& currElement: elements)
+        {
+            tempElements[histogram[(currElement.mSortKey >> digitShift) & 0xFF]++] = currElement;
+        }
+        elements.swap(tempElements);
+    }
+}
+
 bool SpriteBatch::Initialize()
 {
     mSpritesList.reserve(1024);
@@ -24,7 +83,8 @@ void SpriteBatch::Clear()
 {
     mSpritesList.clear();
     mDrawVertices.clear();
-    mDrawIndices.clear();
+    mDrawInstances.clear();
+    mSortedSprites.clear();
     mBatchesList.clear();
 }
 
@@ -40,11 +100,21 @@ void SpriteBatch::DrawSprite(const Sprite2D& sourceSprite)
 
 void SpriteBatch::Flush()
 {
+    PROFILE_SCOPE("Sprites flush");
     if (!mSpritesList.empty())
     {
         SortSprites();
-        GenerateSpritesBatches();
-        RenderSpritesBatches();
+        // rendering mode depends on currently active sprites program
+        if (gRenderManager.mSpritesInstancedProgram.IsActive())
+        {
+            GenerateSpritesInstances();
+            RenderSpritesInstances();
+        }
+        else
+        {
+            GenerateSpritesBatches();
+            RenderSpritesBatches();
+        }
     }
     Clear();
 }
@@ -56,16 +126,10 @@ void SpriteBatch::GenerateSpritesBatches()
     int totalVertexCount = numSprites * NumVerticesPerSprite; 
     debug_assert(totalVertexCount > 0);
 
-    int totalIndexCount = numSprites * NumIndicesPerSprite; 
-    debug_assert(totalIndexCount > 0);
-
     // allocate memory for mesh data
     mDrawVertices.resize(totalVertexCount);
     SpriteVertex3D* vertexData = mDrawVertices.data();
 
-    mDrawIndices.resize(totalIndexCount);
-    DrawIndex* indexData = mDrawIndices.data();
-
     // initial batch
     mBatchesList.clear();
     mBatchesList.emplace_back();
@@ -74,11 +138,13 @@ void SpriteBatch::GenerateSpritesBatches()
     currentBatch->mFirstIndex = 0;
     currentBatch->mVertexCount = 0;
     currentBatch->mIndexCount = 0;
-    currentBatch->mSpriteTexture = mSpritesList[0].mTexture;
+    currentBatch->mFirstInstance = 0;
+    currentBatch->mInstanceCount = 0;
+    currentBatch->mSpriteTexture = mSpritesList[mSortedSprites[0].mSpriteIndex].mTexture;
 
     for (int isprite = 0; isprite < numSprites; ++isprite)
     {
-        const Sprite2D& sprite = mSpritesList[isprite];
+        const Sprite2D& sprite = mSpritesList[mSortedSprites[isprite].mSpriteIndex];
         // start new batch
         if (sprite.mTexture != currentBatch->mSpriteTexture)
         {
@@ -87,6 +153,8 @@ void SpriteBatch::GenerateSpritesBatches()
             newBatch.mFirstIndex = currentBatch->mIndexCount + currentBatch->mFirstIndex;
             newBatch.mVertexCount = 0;
             newBatch.mIndexCount = 0;
+            newBatch.mFirstInstance = 0;
+            newBatch.mInstanceCount = 0;
             newBatch.mSpriteTexture = sprite.mTexture;
             mBatchesList.push_back(newBatch);
             currentBatch = &mBatchesList.back();
@@ -138,15 +206,6 @@ void SpriteBatch::GenerateSpritesBatches()
                 vertexData[vertexOffset + i].mTextureSize[1] = sprite.mTexture->mSize.y;
             }
         }
-
-        // setup indices
-        int indexOffset = isprite * NumIndicesPerSprite;
-        indexData[indexOffset + 0] = vertexOffset + 0;
-        indexData[indexOffset + 1] = vertexOffset + 1;
-        indexData[indexOffset + 2] = vertexOffset + 2;
-        indexData[indexOffset + 3] = vertexOffset + 1;
-        indexData[indexOffset + 4] = vertexOffset + 2;
-        indexData[indexOffset + 5] = vertexOffset + 3;
     }
 }
 
@@ -154,8 +213,10 @@ void SpriteBatch::RenderSpritesBatches()
 {
     SpriteVertex3D_Format vFormat;
     mTrimeshBuffer.SetVertices(Sizeof_SpriteVertex3D * mDrawVertices.size(), mDrawVertices.data());
-    mTrimeshBuffer.SetIndices(Sizeof_DrawIndex * mDrawIndices.size(), mDrawIndices.data());
-    mTrimeshBuffer.Bind(vFormat);
+
+    // quad indices are same for all sprites
+    GpuBuffer* quadsIndexBuffer = gRenderManager.GetQuadsIndexBuffer(mSpritesList.size());
+    mTrimeshBuffer.Bind(vFormat, quadsIndexBuffer);
 
     for (const DrawSpriteBatch& currBatch: mBatchesList)
     {
@@ -166,6 +227,85 @@ void SpriteBatch::RenderSpritesBatches()
     }
 }
 
+void SpriteBatch::GenerateSpritesInstances()
+{
+    int numSprites = mSpritesList.size();
+    debug_assert(numSprites > 0);
+
+    mDrawInstances.resize(numSprites);
+    SpriteInstance* instanceData = mDrawInstances.data();
+
+    // initial batch
+    mBatchesList.clear();
+    mBatchesList.emplace_back();
+    DrawSpriteBatch* currentBatch = &mBatchesList.back();
+    currentBatch->mFirstVertex = 0;
+    currentBatch->mFirstIndex = 0;
+    currentBatch->mVertexCount = 0;
+    currentBatch->mIndexCount = 0;
+    currentBatch->mFirstInstance = 0;
+    currentBatch->mInstanceCount = 0;
+    currentBatch->mSpriteTexture = mSpritesList[mSortedSprites[0].mSpriteIndex].mTexture;
+
+    auto ToNormalizedShort = [](float value) -> unsigned short
+    {
+        return static_cast<unsigned short>(glm::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    };
+
+    for (int isprite = 0; isprite < numSprites; ++isprite)
+    {
+        const Sprite2D& sprite = mSpritesList[mSortedSprites[isprite].mSpriteIndex];
+        // start new batch
+        if (sprite.mTexture != currentBatch->mSpriteTexture)
+        {
+            DrawSpriteBatch newBatch {};
+            newBatch.mFirstInstance = currentBatch->mInstanceCount + currentBatch->mFirstInstance;
+            newBatch.mInstanceCount = 0;
+            newBatch.mSpriteTexture = sprite.mTexture;
+            mBatchesList.push_back(newBatch);
+            currentBatch = &mBatchesList.back();
+        }
+
+        ++currentBatch->mInstanceCount;
+
+        SpriteInstance& instance = instanceData[isprite];
+        instance.mPositionRotation.x = sprite.mPosition.x;
+        instance.mPositionRotation.y = sprite.mPosition.y;
+        instance.mPositionRotation.z = sprite.mHeight;
+        instance.mPositionRotation.w = sprite.mRotateAngle.to_radians();
+        instance.mSize = sprite.GetSpriteSize();
+        instance.mTexcoords[0] = ToNormalizedShort(sprite.mTextureRegion.mU0);
+        instance.mTexcoords[1] = ToNormalizedShort(sprite.mTextureRegion.mV0);
+        instance.mTexcoords[2] = ToNormalizedShort(sprite.mTextureRegion.mU1);
+        instance.mTexcoords[3] = ToNormalizedShort(sprite.mTextureRegion.mV1);
+        instance.mClutIndex = sprite.mPaletteIndex;
+        instance.mCenterOrigin = (sprite.mOriginMode == eSpriteOrigin_Center) ? 1 : 0;
+    }
+}
+
+void SpriteBatch::RenderSpritesInstances()
+{
+    GpuProgram* gpuProgram = gRenderManager.mSpritesInstancedProgram.mGpuProgram;
+    debug_assert(gpuProgram);
+    if (gpuProgram->IsUniformExists(eRenderUniform_SpritesDepthAxis))
+    {
+        gpuProgram->SetUniform(eRenderUniform_SpritesDepthAxis, (mDepthAxis == DepthAxis_Y) ? 0 : 1);
+    }
+
+    mTrimeshBuffer.SetVertices(Sizeof_SpriteInstance * mDrawInstances.size(), mDrawInstances.data());
+
+    SpriteInstance_Format instanceFormat;
+    for (const DrawSpriteBatch& currBatch: mBatchesList)
+    {
+        gGraphicsDevice.BindTexture(eTextureUnit_0, currBatch.mSpriteTexture);
+
+        // base instance is not available on target api, so offset attributes instead
+        instanceFormat.mBaseOffset = Sizeof_SpriteInstance * currBatch.mFirstInstance;
+        mTrimeshBuffer.Bind(instanceFormat, nullptr);
+        gGraphicsDevice.RenderPrimitivesInstanced(ePrimitiveType_TriangleStrip, 0, NumVerticesPerSprite, currBatch.mInstanceCount);
+    }
+}
+
 void SpriteBatch::BeginBatch(DepthAxis depthAxis, eSpritesSortMode sortMode)
 {
     Clear();
@@ -176,40 +316,51 @@ void SpriteBatch::BeginBatch(DepthAxis depthAxis, eSpritesSortMode sortMode)
 
 void SpriteBatch::SortSprites()
 {
-    if (mSortMode == eSpritesSortMode_None)
-        return;
+    int numSprites = mSpritesList.size();
+    mSortedSprites.resize(numSprites);
+    mSortTextures.clear();
 
-    if (mSortMode == eSpritesSortMode_Height)
+    int textureOrdinal = -1;
+    for (int isprite = 0; isprite < numSprites; ++isprite)
     {
-        static auto SortProc = [](const Sprite2D& lhs, const Sprite2D& rhs)
+        const Sprite2D& sprite = mSpritesList[isprite];
+        // textures are numbered by first appearance, so order does not depend on their addresses
+        if (textureOrdinal == -1 || mSortTextures[textureOrdinal] != sprite.mTexture)
         {
-            return lhs.mHeight < rhs.mHeight;
-        };
-        std::stable_sort(mSpritesList.begin(), mSpritesList.end(), SortProc);
-        return;
+            textureOrdinal = std::find(mSortTextures.begin(), mSortTextures.end(), sprite.mTexture) - mSortTextures.begin();
+            if (textureOrdinal == (int) mSortTextures.size())
+            {
+                mSortTextures.push_back(sprite.mTexture);
+            }
+        }
+
+        SpriteSortElement& sortElement = mSortedSprites[isprite];
+        sortElement.mSpriteIndex = isprite;
+        sortElement.mSortKey = GetSpriteSortKey(sprite, textureOrdinal, isprite);
     }
 
-    if (mSortMode == eSpritesSortMode_DrawOrder)
-    {
-        static auto SortProc = [](const Sprite2D& lhs, const Sprite2D& rhs)
-        {
-            return lhs.mDrawOrder < rhs.mDrawOrder;
-        };
-        std::stable_sort(mSpritesList.begin(), mSpritesList.end(), SortProc);
+    if (mSortMode == eSpritesSortMode_None || numSprites < 2)
         return;
-    }
 
-    if (mSortMode == eSpritesSortMode_HeightAndDrawOrder)
+    RadixSortElements(mSortedSprites, mSortTemp);
+}
+
+unsigned long long SpriteBatch::GetSpriteSortKey(const Sprite2D& sprite, int textureOrdinal, int spriteIndex) const
+{
+    unsigned long long heightBits = 0;
+    unsigned long long drawOrderBits = 0;
+    if (mSortMode == eSpritesSortMode_Height || mSortMode == eSpritesSortMode_HeightAndDrawOrder)
     {
-        static auto SortProc = [](const Sprite2D& lhs, const Sprite2D& rhs)
-        {
-            if (lhs.mHeight != rhs.mHeight)
-            {
-                return (lhs.mHeight < rhs.mHeight);
-            }
-            return (lhs.mDrawOrder < rhs.mDrawOrder);
-        };  
-        std::stable_sort(mSpritesList.begin(), mSpritesList.end(), SortProc);
-        return;
+        heightBits = FloatToSortableBits(sprite.mHeight);
+    }
+    if (mSortMode == eSpritesSortMode_DrawOrder || mSortMode == eSpritesSortMode_HeightAndDrawOrder)
+    {
+        debug_assert(sprite.mDrawOrder >= 0 && sprite.mDrawOrder <= 0xFF);
+        drawOrderBits = sprite.mDrawOrder & 0xFF;
     }
+    // texture goes next, sprites at same depth get merged into single batch,
+    // submission index goes last, so sprites at same depth and texture keep their order
+    unsigned long long textureBits = std::min(textureOrdinal, 0xFF);
+    unsigned long long submissionBits = std::min(spriteIndex, 0xFFFF);
+    return (heightBits << 32) | (drawOrderBits << 24) | (textureBits << 16) | submissionBits;
 }
@@ -15,6 +15,8 @@ enum eSpritesSortMode
 // defines renderer class for 2d sprites
 class SpriteBatch final: public cxx::noncopyable
 {
+    friend class GameBenchmark;
+
 public:
 
     enum DepthAxis { DepthAxis_Y, DepthAxis_Z };
@@ -38,7 +40,12 @@ public:
 private:
     void GenerateSpritesBatches();
     void RenderSpritesBatches();
+    void GenerateSpritesInstances();
+    void RenderSpritesInstances();
     void SortSprites();
+    // @param textureOrdinal: Texture number in order of first appearance within batch
+    // @param spriteIndex: Sprite submission index
+    unsigned long long GetSpriteSortKey(const Sprite2D& sprite, int textureOrdinal, int spriteIndex) const;
 
 private:
     // single batch of drawing sprites
@@ -48,14 +55,27 @@ private:
         unsigned int mFirstIndex;
         unsigned int mVertexCount;
         unsigned int mIndexCount;
+        unsigned int mFirstInstance;
+        unsigned int mInstanceCount;
         GpuTexture2D* mSpriteTexture;
     };
+    // sprite sort key packed as height, draw order, texture ordinal and submission index
+    struct SpriteSortElement
+    {
+        unsigned long long mSortKey;
+        unsigned int mSpriteIndex;
+    };
     // all sprites stored as is until they needs to be flushed
     std::vector<Sprite2D> mSpritesList;
 
-    // draw data buffers
+    // sprites are not moved while sorting, only indices
+    std::vector<SpriteSortElement> mSortedSprites;
+    std::vector<SpriteSortElement> mSortTemp;
+    std::vector<GpuTexture2D*> mSortTextures; // distinct textures in order of first appearance
+
+    // draw data buffers, indices are taken from shared quads buffer
     std::vector<SpriteVertex3D> mDrawVertices;
-    std::vector<DrawIndex> mDrawIndices;
+    std::vector<SpriteInstance> mDrawInstances; // used in instanced rendering mode
 
     std::vector<DrawSpriteBatch> mBatchesList;
     TrimeshBuffer mTrimeshBuffer;
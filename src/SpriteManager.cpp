@@ -7,18 +7,49 @@
 #include "stb_rect_pack.h"
 #include "GameCheatsWindow.h"
 #include "MemoryManager.h"
+#include "LevelCache.h"
+#include "cvars.h"
+#include "FrameProfiler.h"
 
 const int ObjectsTextureSizeX = 2048;
 const int ObjectsTextureSizeY = 1024;
 const int SpritesSpacing = 4;
 
+// sprites with deltas are stored within same texture as default sprites, below them,
+// that area is split into pages and each page holds sprites of single size class
+const int DeltaSpritesAreaSizeY = 1024;
+const int DeltaSpritesPageSize = 256;
+const int DeltaSpritesPagesPerRow = ObjectsTextureSizeX / DeltaSpritesPageSize;
+const int DeltaSpritesPagesCount = DeltaSpritesPagesPerRow * (DeltaSpritesAreaSizeY / DeltaSpritesPageSize);
+const int DeltaSpritesSizeGranularity = 16;
+const int MaxCachedSpriteVariants = 4; // per object sprite, least recently used variant gets replaced
+
+CvarInt gCvarGraphicsSpritesCacheBudget("r_spritesCacheBudget", 4096, "Memory budget for cached sprites with deltas, in kilobytes", CvarFlags_Archive);
+
 SpriteManager gSpriteManager;
 
+// build key for free sprite texture slots lookup
+inline unsigned int GetSpriteSlotKey(const Point& dimensions)
+{
+    debug_assert(dimensions.x < 65536 && dimensions.y < 65536);
+    return (dimensions.x << 16) | dimensions.y;
+}
+
 bool SpriteManager::InitLevelSprites()
 {
     Cleanup();
     debug_assert(gGameMap.mStyleData.IsLoaded());
 
+    if (gCvarSysHeadless.mValue)
+    {
+        // gameplay code only needs sprites layout, gpu resources are not created
+        InitBlocksIndicesTable();
+        InitBlocksAnimations();
+        InitExplosionFrames();
+        InitMaxSpriteDrawExtent();
+        return InitObjectsSpritesheet();
+    }
+
     if (!InitBlocksTexture())
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot create blocks texture");
@@ -40,13 +71,20 @@ bool SpriteManager::InitLevelSprites()
     InitPalettesTable();
     InitBlocksAnimations();
     InitExplosionFrames();
+    InitMaxSpriteDrawExtent();
     return true;
 }
 
 void SpriteManager::Cleanup()
 {
     FlushSpritesCache();
+    {
+        std::lock_guard<std::mutex> flushLock (mFlushObjectsMutex);
+        mFlushObjectsList.clear();
+    }
     DestroySpriteTextures();
+    mFreeSpriteSlots.clear();
+    mCacheStats.mSpritesheetPagesCount = 0;
     FreeExplosionFrames();
     mIndicesTableChanged = false;
     if (mBlocksTextureArray)
@@ -99,23 +137,30 @@ bool SpriteManager::InitObjectsSpritesheet()
     debug_assert(ObjectsTextureSizeX > 0);
     debug_assert(ObjectsTextureSizeY > 0);
 
-    mObjectsSpritesheet.mSpritesheetTexture = gGraphicsDevice.CreateTexture2D(eTextureFormat_R8UI, ObjectsTextureSizeX, ObjectsTextureSizeY, nullptr);
-    debug_assert(mObjectsSpritesheet.mSpritesheetTexture);
+    bool isHeadless = gCvarSysHeadless.mValue;
+    if (!isHeadless)
+    {
+        mObjectsSpritesheet.mSpritesheetTexture = gGraphicsDevice.CreateTexture2D(eTextureFormat_R8UI, ObjectsTextureSizeX, ObjectsTextureSizeY + DeltaSpritesAreaSizeY, nullptr);
+        debug_assert(mObjectsSpritesheet.mSpritesheetTexture);
 
-    if (mObjectsSpritesheet.mSpritesheetTexture == nullptr)
-        return false;
+        if (mObjectsSpritesheet.mSpritesheetTexture == nullptr)
+            return false;
+    }
 
     mObjectsSpritesheet.mEntries.resize(totalSprites);
 
     // allocate temporary bitmap
     PixelsArray spritesBitmap;
-    if (!spritesBitmap.Create(eTextureFormat_R8UI, ObjectsTextureSizeX, ObjectsTextureSizeY, gMemoryManager.mFrameHeapAllocator))
+    if (!isHeadless)
     {
-        debug_assert(false);
-        return false;
-    }
+        if (!spritesBitmap.Create(eTextureFormat_R8UI, ObjectsTextureSizeX, ObjectsTextureSizeY + DeltaSpritesAreaSizeY, gMemoryManager.mFrameHeapAllocator))
+        {
+            debug_assert(false);
+            return false;
+        }
 
-    spritesBitmap.FillWithColor(0);
+        spritesBitmap.FillWithColor(0);
+    }
 
     // detect total layers count
     std::vector<stbrp_node> stbrp_nodes(ObjectsTextureSizeX);
@@ -132,7 +177,7 @@ bool SpriteManager::InitObjectsSpritesheet()
     }
 
     float tcx = 1.0f / ObjectsTextureSizeX;
-    float tcy = 1.0f / ObjectsTextureSizeY;
+    float tcy = 1.0f / (ObjectsTextureSizeY + DeltaSpritesAreaSizeY);
 
     // pack sprites
     bool all_done = false;
@@ -149,7 +194,7 @@ bool SpriteManager::InitObjectsSpritesheet()
                 continue;
 
             ++numPacked;
-            if (!cityStyle.GetSpriteTexture(curr_rc.id, &spritesBitmap, curr_rc.x, curr_rc.y))
+            if (!isHeadless && !cityStyle.GetSpriteTexture(curr_rc.id, &spritesBitmap, curr_rc.x, curr_rc.y))
             {
                 debug_assert(false);
                 return false;
@@ -173,7 +218,7 @@ bool SpriteManager::InitObjectsSpritesheet()
         }
 
         // upload to texture
-        if (!mObjectsSpritesheet.mSpritesheetTexture->Upload(spritesBitmap.mData))
+        if (!isHeadless && !mObjectsSpritesheet.mSpritesheetTexture->Upload(spritesBitmap.mData))
         {
             debug_assert(false);
         }
@@ -194,37 +239,24 @@ bool SpriteManager::InitBlocksTexture()
         return true;
     }
 
-    // allocate temporary bitmap
-    PixelsArray blockBitmap;
-    if (!blockBitmap.Create(eTextureFormat_R8, MAP_BLOCK_TEXTURE_DIMS, MAP_BLOCK_TEXTURE_DIMS, gMemoryManager.mFrameHeapAllocator))
+    // all layers are uploaded at once, level cache may already have them converted
+    std::vector<unsigned char> blockTextureLayers;
+    const std::vector<unsigned char>* layersData = &gLevelCache.mBlockTextureLayers;
+    if (!gLevelCache.HasBlockTextureLayers() || 
+        (gLevelCache.mBlockTextureLayers.size() != (size_t) totalTextures * MAP_BLOCK_TEXTURE_AREA))
     {
-        debug_assert(false);
-        return false;
+        cityStyle.GetBlockTextureLayers(blockTextureLayers);
+        layersData = &blockTextureLayers;
     }
+    debug_assert(layersData->size() == (size_t) totalTextures * MAP_BLOCK_TEXTURE_AREA);
 
-    mBlocksTextureArray = gGraphicsDevice.CreateTextureArray2D(eTextureFormat_R8UI, blockBitmap.mSizex, blockBitmap.mSizey, totalTextures, nullptr);
+    mBlocksTextureArray = gGraphicsDevice.CreateTextureArray2D(eTextureFormat_R8UI, MAP_BLOCK_TEXTURE_DIMS, MAP_BLOCK_TEXTURE_DIMS, totalTextures, nullptr);
     debug_assert(mBlocksTextureArray);
-    
-    int currentLayerIndex = 0;
-    for (int iblockType = 0; iblockType < eBlockType_COUNT; ++iblockType)
-    {
-        int numTextures = cityStyle.GetBlockTexturesCount((eBlockType) iblockType);
-        for (int itexture = 0; itexture < numTextures; ++itexture)
-        {
-            if (!cityStyle.GetBlockTexture((eBlockType) iblockType, itexture, &blockBitmap, 0, 0, 0))
-            {
-                gConsole.LogMessage(eLogMessage_Warning, "Cannot read block texture: %d %d", iblockType, itexture);
-                return false;
-            }
 
-            // upload bitmap to gpu
-            if (!mBlocksTextureArray->Upload(currentLayerIndex, 1, blockBitmap.mData))
-            {
-                debug_assert(false);
-            }
-            
-            ++currentLayerIndex;
-        }
+    // upload bitmaps to gpu
+    if (!mBlocksTextureArray->Upload(0, totalTextures, layersData->data()))
+    {
+        debug_assert(false);
     }
     return true;
 }
@@ -250,6 +282,9 @@ bool SpriteManager::InitBlocksIndicesTable()
         mBlocksIndices[i] = i;
     }
 
+    if (gCvarSysHeadless.mValue)
+        return true;
+
     int textureWidth = cxx::get_next_pot(mBlocksIndices.size());
     mBlocksIndicesTable = gGraphicsDevice.CreateTexture2D(eTextureFormat_R16UI, textureWidth, 1, nullptr);
     debug_assert(mBlocksIndicesTable);
@@ -284,18 +319,21 @@ void SpriteManager::InitPalettesTable()
 
 void SpriteManager::RenderFrameBegin()
 {
-
+    ++mRenderFrameIndex;
+    FlushPendingObjectsSprites();
 }
 
 void SpriteManager::RenderFrameEnd()
 {
-    if (mIndicesTableChanged)
+    if (mIndicesTableChanged && mBlocksIndicesTable)
     {
         // upload indices table
         debug_assert(mBlocksIndicesTable);
         mIndicesTableChanged = false;
         mBlocksIndicesTable->Upload(0, 0, 0, mBlocksIndices.size(), 1, mBlocksIndices.data());
     }
+
+    EnforceSpritesCacheBudget();
 }
 
 void SpriteManager::InitBlocksAnimations()
@@ -325,6 +363,8 @@ void SpriteManager::UpdateBlocksAnimations(float deltaTime)
     if (!gGameCheatsWindow.mEnableBlocksAnimation)
         return;
 
+    PROFILE_SCOPE("Blocks animations");
+
     for (BlockAnimation& currAnim: mBlocksAnimations)
     {
         if (!currAnim.UpdateFrame(deltaTime))
@@ -494,35 +534,218 @@ void SpriteManager::FlushSpritesCache()
     // move all textures to pool
     for (SpriteCacheElement& currElement: mSpritesCache)
     {
-        mFreeSpriteTextures.push_back(currElement.mTexture);
+        FreeSpriteTextureSlot(currElement.mTextureSlot);
     }
 
     mSpritesCache.clear();
+    mSpritesCacheLookup.clear();
+    mObjectSpritesLookup.clear();
+    mCacheStats.mCachedSpritesCount = 0;
+    mCacheStats.mCachedSpritesBytes = 0;
 }
 
 void SpriteManager::FlushSpritesCache(GameObjectID objectID)
 {
-    for (auto icurrent = mSpritesCache.begin(); icurrent != mSpritesCache.end(); )
+    // sprites with deltas are not cached in headless mode
+    if (gCvarSysHeadless.mValue)
+        return;
+
+    std::lock_guard<std::mutex> flushLock (mFlushObjectsMutex);
+    mFlushObjectsList.push_back(objectID);
+}
+
+void SpriteManager::FlushPendingObjectsSprites()
+{
+    std::lock_guard<std::mutex> flushLock (mFlushObjectsMutex);
+    for (GameObjectID currObjectID: mFlushObjectsList)
     {
-        if (icurrent->mObjectID == objectID)
+        FlushObjectSprites(currObjectID);
+    }
+    mFlushObjectsList.clear();
+}
+
+void SpriteManager::FlushObjectSprites(GameObjectID objectID)
+{
+    auto objectElements = mObjectSpritesLookup.equal_range(objectID);
+    for (auto icurrent = objectElements.first; icurrent != objectElements.second; ++icurrent)
+    {
+        SpritesCacheIterator cacheElement = icurrent->second;
+        mSpritesCacheLookup.erase(cacheElement->mCacheKey);
+
+        --mCacheStats.mCachedSpritesCount;
+        mCacheStats.mCachedSpritesBytes -= GetSpriteTextureSlotBytes(cacheElement->mTextureSlot);
+
+        // move texture to pool
+        FreeSpriteTextureSlot(cacheElement->mTextureSlot);
+        mSpritesCache.erase(cacheElement);
+    }
+    mObjectSpritesLookup.erase(objectElements.first, objectElements.second);
+}
+
+void SpriteManager::DestroySpriteTextures()
+{
+    // spritesheet pages are kept
+    for (auto& currBucket: mFreeSpriteSlots)
+    {
+        std::vector<SpriteTextureSlot>& slots = currBucket.second;
+        for (auto icurrent = slots.begin(); icurrent != slots.end(); )
         {
-            // move texture to pool
-            mFreeSpriteTextures.push_back(icurrent->mTexture);
+            if (icurrent->mTexture == mObjectsSpritesheet.mSpritesheetTexture)
+            {
+                ++icurrent;
+                continue;
+            }
+            gGraphicsDevice.DestroyTexture(icurrent->mTexture);
+            icurrent = slots.erase(icurrent);
+        }
+    }
+    mCacheStats.mFreeTexturesCount = 0;
+    mCacheStats.mFreeTexturesBytes = 0;
+}
 
-            icurrent = mSpritesCache.erase(icurrent);
+void SpriteManager::EnforceSpritesCacheBudget()
+{
+    int budgetBytes = std::max(gCvarGraphicsSpritesCacheBudget.mValue, 0) * 1024;
+
+    // unused textures go first
+    if ((mCacheStats.mCachedSpritesBytes + mCacheStats.mFreeTexturesBytes) > budgetBytes)
+    {
+        DestroySpriteTextures();
+    }
+
+    // least recently used go first
+    for (auto icacheElement = mSpritesCache.end();
+        (icacheElement != mSpritesCache.begin()) && (mCacheStats.mCachedSpritesBytes > budgetBytes); )
+    {
+        --icacheElement;
+
+        // sprites used in current frame are kept, otherwise cache will be thrashing
+        if (icacheElement->mLastUsedFrame == mRenderFrameIndex)
+            break;
+
+        // sprites within spritesheet pages do not take memory beyond budget
+        if (icacheElement->mTextureSlot.mTexture == mObjectsSpritesheet.mSpritesheetTexture)
             continue;
+
+        // remove lookup entries
+        mSpritesCacheLookup.erase(icacheElement->mCacheKey);
+        auto objectElements = mObjectSpritesLookup.equal_range(icacheElement->mCacheKey.mObjectID);
+        for (auto icurrent = objectElements.first; icurrent != objectElements.second; ++icurrent)
+        {
+            if (icurrent->second == icacheElement)
+            {
+                mObjectSpritesLookup.erase(icurrent);
+                break;
+            }
         }
-        ++icurrent;
+
+        SpriteTextureSlot textureSlot = icacheElement->mTextureSlot;
+        icacheElement = mSpritesCache.erase(icacheElement);
+
+        --mCacheStats.mCachedSpritesCount;
+        mCacheStats.mCachedSpritesBytes -= GetSpriteTextureSlotBytes(textureSlot);
+        ++mCacheStats.mCacheEvictions;
+
+        gGraphicsDevice.DestroyTexture(textureSlot.mTexture);
     }
 }
 
-void SpriteManager::DestroySpriteTextures()
+int SpriteManager::GetSpriteTextureSlotBytes(const SpriteTextureSlot& textureSlot) const
 {
-    for (GpuTexture2D* currTexture: mFreeSpriteTextures)
+    if (textureSlot.mTexture == mObjectsSpritesheet.mSpritesheetTexture)
+        return 0;
+
+    return textureSlot.mSize.x * textureSlot.mSize.y;
+}
+
+bool SpriteManager::AllocSpriteTextureSlot(const Point& spriteSize, SpriteTextureSlot& textureSlot)
+{
+    // sprites of similar size share same slots
+    Point slotSize;
+    slotSize.x = cxx::align_up(spriteSize.x + SpritesSpacing, DeltaSpritesSizeGranularity);
+    slotSize.y = cxx::align_up(spriteSize.y + SpritesSpacing, DeltaSpritesSizeGranularity);
+
+    std::vector<SpriteTextureSlot>& freeSlots = mFreeSpriteSlots[GetSpriteSlotKey(slotSize)];
+    if (freeSlots.empty() && mObjectsSpritesheet.mSpritesheetTexture && 
+        (slotSize.x <= DeltaSpritesPageSize) && (slotSize.y <= DeltaSpritesPageSize) &&
+        (mCacheStats.mSpritesheetPagesCount < DeltaSpritesPagesCount))
+    {
+        // split new page into slots
+        int pageIndex = mCacheStats.mSpritesheetPagesCount++;
+
+        Point pagePosition;
+        pagePosition.x = (pageIndex % DeltaSpritesPagesPerRow) * DeltaSpritesPageSize;
+        pagePosition.y = (pageIndex / DeltaSpritesPagesPerRow) * DeltaSpritesPageSize + ObjectsTextureSizeY;
+
+        // first slot goes last, so it will be taken first
+        for (int iy = (DeltaSpritesPageSize / slotSize.y) - 1; iy >= 0; --iy)
+        for (int ix = (DeltaSpritesPageSize / slotSize.x) - 1; ix >= 0; --ix)
+        {
+            SpriteTextureSlot pageSlot;
+            pageSlot.mTexture = mObjectsSpritesheet.mSpritesheetTexture;
+            pageSlot.mPosition.x = pagePosition.x + ix * slotSize.x;
+            pageSlot.mPosition.y = pagePosition.y + iy * slotSize.y;
+            pageSlot.mSize = slotSize;
+            freeSlots.push_back(pageSlot);
+        }
+    }
+
+    if (!freeSlots.empty())
+    {
+        textureSlot = freeSlots.back();
+        freeSlots.pop_back();
+
+        if (textureSlot.mTexture != mObjectsSpritesheet.mSpritesheetTexture)
+        {
+            --mCacheStats.mFreeTexturesCount;
+            mCacheStats.mFreeTexturesBytes -= (slotSize.x * slotSize.y);
+        }
+        return true;
+    }
+
+    // spritesheet is out of space, fallback to standalone texture
+    textureSlot.mTexture = gGraphicsDevice.CreateTexture2D(eTextureFormat_R8UI, 
+        cxx::get_next_pot(slotSize.x), 
+        cxx::get_next_pot(slotSize.y), nullptr);
+    textureSlot.mPosition.x = 0;
+    textureSlot.mPosition.y = 0;
+    textureSlot.mSize = slotSize;
+    return textureSlot.mTexture != nullptr;
+}
+
+void SpriteManager::FreeSpriteTextureSlot(const SpriteTextureSlot& textureSlot)
+{
+    debug_assert(textureSlot.mTexture);
+
+    mFreeSpriteSlots[GetSpriteSlotKey(textureSlot.mSize)].push_back(textureSlot);
+
+    if (textureSlot.mTexture != mObjectsSpritesheet.mSpritesheetTexture)
+    {
+        ++mCacheStats.mFreeTexturesCount;
+        mCacheStats.mFreeTexturesBytes += (textureSlot.mSize.x * textureSlot.mSize.y);
+    }
+}
+
+bool SpriteManager::UploadSpriteTextureSlot(const SpriteTextureSlot& textureSlot, int spriteIndex, SpriteDeltaBits deltaBits)
+{
+    // whole slot is uploaded, so sprite spacing area gets cleared
+    PixelsArray pixels;
+    if (!pixels.Create(eTextureFormat_R8UI, textureSlot.mSize.x, textureSlot.mSize.y, gMemoryManager.mFrameHeapAllocator))
     {
-        gGraphicsDevice.DestroyTexture(currTexture);
+        debug_assert(false);
+        return false;
     }
-    mFreeSpriteTextures.clear();
+    pixels.FillWithColor(0);
+
+    // combine source image with deltas
+    if (!gGameMap.mStyleData.GetSpriteTexture(spriteIndex, deltaBits, &pixels, 0, 0))
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    return textureSlot.mTexture->Upload(0, textureSlot.mPosition.x, textureSlot.mPosition.y, 
+        textureSlot.mSize.x, textureSlot.mSize.y, pixels.mData);
 }
 
 void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int remap, SpriteDeltaBits deltaBits, Sprite2D& sourceSprite)
@@ -549,85 +772,108 @@ void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int
         return;
     }
 
+    if (gCvarSysHeadless.mValue)
+    {
+        // nothing to draw, keep sprite dimensions only
+        sourceSprite.mTextureRegion = mObjectsSpritesheet.mEntries[spriteIndex];
+        return;
+    }
+
+    SpriteCacheKey cacheKey;
+    cacheKey.mObjectID = objectID;
+    cacheKey.mSpriteIndex = spriteIndex;
+    cacheKey.mRemap = remap;
+    cacheKey.mDeltaBits = deltaBits;
+
     // find sprite with deltas within cache
-    for (SpriteCacheElement& currElement: mSpritesCache)
+    auto icacheLookup = mSpritesCacheLookup.find(cacheKey);
+    if (icacheLookup != mSpritesCacheLookup.end())
     {
-        if (currElement.mObjectID == objectID && currElement.mSpriteIndex == spriteIndex)
-        {
-            if (currElement.mSpriteDeltaBits == deltaBits)
-            {
-                sourceSprite.mTexture = currElement.mTexture;
-                sourceSprite.mTextureRegion = currElement.mTextureRegion;
-                return;
-            }
-            currElement.mSpriteDeltaBits = deltaBits;
+        SpriteCacheElement& currElement = *icacheLookup->second;
 
-            // upload changes
-            PixelsArray pixels;
-            if (!pixels.Create(currElement.mTexture->mFormat, 
-                currElement.mTexture->mSize.x, 
-                currElement.mTexture->mSize.y, gMemoryManager.mFrameHeapAllocator))
-            {
-                debug_assert(false);
-            }
+        // mark as most recently used
+        currElement.mLastUsedFrame = mRenderFrameIndex;
+        mSpritesCache.splice(mSpritesCache.begin(), mSpritesCache, icacheLookup->second);
 
-            if (!gGameMap.mStyleData.GetSpriteTexture(spriteIndex, deltaBits, &pixels, 0, 0))
-            {
-                debug_assert(false);
-            }
-            sourceSprite.mTextureRegion = currElement.mTextureRegion;
-            sourceSprite.mTexture = currElement.mTexture;
-            sourceSprite.mTexture->Upload(pixels.mData);
-            return;
-        }
+        ++mCacheStats.mCacheHits;
+        sourceSprite.mTexture = currElement.mTextureSlot.mTexture;
+        sourceSprite.mTextureRegion = currElement.mTextureRegion;
+        return;
     }
     
     // cache miss
-    Point dimensions;
-    dimensions.x = cxx::get_next_pot(spriteStyle.mWidth);
-    dimensions.y = cxx::get_next_pot(spriteStyle.mHeight);
+    ++mCacheStats.mCacheMisses;
 
-    sourceSprite.mTexture = GetFreeSpriteTexture(dimensions, eTextureFormat_R8UI);
-    if (sourceSprite.mTexture == nullptr)
+    // object could switch between few variants of sprite, such as opened and closed doors,
+    // but number of variants per sprite is limited, least recently used one gets replaced
+    int variantsCount = 0;
+    SpritesCacheIterator ioldestVariant = mSpritesCache.end();
+    auto objectElements = mObjectSpritesLookup.equal_range(objectID);
+    for (auto icurrent = objectElements.first; icurrent != objectElements.second; ++icurrent)
     {
-        debug_assert(false);
+        if (icurrent->second->mCacheKey.mSpriteIndex != spriteIndex)
+            continue;
+
+        ++variantsCount;
+        if (ioldestVariant == mSpritesCache.end() || icurrent->second->mLastUsedFrame < ioldestVariant->mLastUsedFrame)
+        {
+            ioldestVariant = icurrent->second;
+        }
     }
 
-    PixelsArray pixels;
-    if (!pixels.Create(eTextureFormat_R8UI, dimensions.x, dimensions.y, 
-        gMemoryManager.mFrameHeapAllocator))
+    if (variantsCount >= MaxCachedSpriteVariants && ioldestVariant->mLastUsedFrame != mRenderFrameIndex)
     {
-        debug_assert(false);
-    }
+        SpriteCacheElement& currElement = *ioldestVariant;
+        mSpritesCacheLookup.erase(currElement.mCacheKey);
+        currElement.mCacheKey = cacheKey;
+        currElement.mLastUsedFrame = mRenderFrameIndex;
+        mSpritesCacheLookup.emplace(cacheKey, ioldestVariant);
+        mSpritesCache.splice(mSpritesCache.begin(), mSpritesCache, ioldestVariant);
 
-    pixels.FillWithCheckerBoard();
+        // upload changes
+        if (!UploadSpriteTextureSlot(currElement.mTextureSlot, spriteIndex, deltaBits))
+        {
+            debug_assert(false);
+        }
+        sourceSprite.mTexture = currElement.mTextureSlot.mTexture;
+        sourceSprite.mTextureRegion = currElement.mTextureRegion;
+        return;
+    }
 
-    // combine soruce image with deltas
-    if (!gGameMap.mStyleData.GetSpriteTexture(spriteIndex, deltaBits, &pixels, 0, 0))
+    SpriteTextureSlot textureSlot;
+    if (!AllocSpriteTextureSlot(Point(spriteStyle.mWidth, spriteStyle.mHeight), textureSlot))
     {
         debug_assert(false);
+        return;
     }
 
-    // upload to texture
-    sourceSprite.mTexture->Upload(pixels.mData);
+    if (!UploadSpriteTextureSlot(textureSlot, spriteIndex, deltaBits))
+    {
+        debug_assert(false);
+    }
 
     Rect srcRect;
-    srcRect.x = 0;
-    srcRect.y = 0;
+    srcRect.x = textureSlot.mPosition.x;
+    srcRect.y = textureSlot.mPosition.y;
     srcRect.w = spriteStyle.mWidth;
     srcRect.h = spriteStyle.mHeight;
 
-    sourceSprite.mTextureRegion.SetRegion(srcRect, dimensions);
+    sourceSprite.mTexture = textureSlot.mTexture;
+    sourceSprite.mTextureRegion.SetRegion(srcRect, textureSlot.mTexture->mSize);
 
     // add to sprites cache
     SpriteCacheElement spriteCacheElement;
-    spriteCacheElement.mObjectID = objectID;
-    spriteCacheElement.mSpriteIndex = spriteIndex;
-    spriteCacheElement.mSpriteDeltaBits = deltaBits;
-    spriteCacheElement.mTexture = sourceSprite.mTexture;
+    spriteCacheElement.mCacheKey = cacheKey;
+    spriteCacheElement.mTextureSlot = textureSlot;
     spriteCacheElement.mTextureRegion = sourceSprite.mTextureRegion;
+    spriteCacheElement.mLastUsedFrame = mRenderFrameIndex;
+
+    mSpritesCache.push_front(spriteCacheElement);
+    mSpritesCacheLookup.emplace(cacheKey, mSpritesCache.begin());
+    mObjectSpritesLookup.emplace(objectID, mSpritesCache.begin());
 
-    mSpritesCache.push_back(spriteCacheElement);
+    ++mCacheStats.mCachedSpritesCount;
+    mCacheStats.mCachedSpritesBytes += GetSpriteTextureSlotBytes(textureSlot);
 }
 
 void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int remap, Sprite2D& sourceSprite)
@@ -642,21 +888,15 @@ void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int
     sourceSprite.mTextureRegion = mObjectsSpritesheet.mEntries[spriteIndex];
 }
 
-GpuTexture2D* SpriteManager::GetFreeSpriteTexture(const Point& dimensions, eTextureFormat format)
+void SpriteManager::InitMaxSpriteDrawExtent()
 {
-    for (auto icurr = mFreeSpriteTextures.begin(); icurr != mFreeSpriteTextures.end(); )
+    // game objects sprites are centered at object position, so extent is half of sprite diagonal
+    int maxDiagonal2 = mExplosionFrameSize.x * mExplosionFrameSize.x + mExplosionFrameSize.y * mExplosionFrameSize.y;
+    for (const SpriteInfo& currSprite: gGameMap.mStyleData.mSprites)
     {
-        GpuTexture2D* currTexture = *icurr;
-        if (currTexture->mSize == dimensions && currTexture->mFormat == format)
-        {
-            mFreeSpriteTextures.erase(icurr);
-            return currTexture;
-        }
-        ++icurr;
+        maxDiagonal2 = std::max(maxDiagonal2, currSprite.mWidth * currSprite.mWidth + currSprite.mHeight * currSprite.mHeight);
     }
-
-    GpuTexture2D* texture = gGraphicsDevice.CreateTexture2D(format, dimensions.x, dimensions.y, nullptr);
-    return texture;
+    mMaxSpriteDrawExtent = Convert::PixelsToMeters(1) * sqrtf(maxDiagonal2 * 1.0f) * 0.5f;
 }
 
 void SpriteManager::InitExplosionFrames()
@@ -677,6 +917,15 @@ void SpriteManager::InitExplosionFrames()
     int textureSizex = sprite.mWidth * 2;
     int textureSizey = sprite.mHeight * 2;
 
+    mExplosionFrameSize.x = textureSizex;
+    mExplosionFrameSize.y = textureSizey;
+    mExplosionPaletteIndex = cityStyle.GetSpritePaletteIndex(sprite.mClut, 0);
+    if (gCvarSysHeadless.mValue)
+    {
+        mExplosionFrames.resize(framesCount, nullptr);
+        return;
+    }
+
     PixelsArray pixels;
     if (!pixels.Create(eTextureFormat_R8UI, textureSizex, textureSizey, 
         gMemoryManager.mFrameHeapAllocator))
@@ -709,15 +958,16 @@ void SpriteManager::InitExplosionFrames()
         }
         debug_assert(texture);
     }
-    
-    mExplosionPaletteIndex = cityStyle.GetSpritePaletteIndex(sprite.mClut, 0);
 }
 
 void SpriteManager::FreeExplosionFrames()
 {
     for (GpuTexture2D* currTexure: mExplosionFrames)
     {
-        gGraphicsDevice.DestroyTexture(currTexure);
+        if (currTexure)
+        {
+            gGraphicsDevice.DestroyTexture(currTexure);
+        }
     }
     mExplosionFrames.clear();
 }
@@ -729,7 +979,7 @@ bool SpriteManager::GetExplosionTexture(int frameIndex, Sprite2D& sourceSprite)
     {
         sourceSprite.mPaletteIndex = mExplosionPaletteIndex;
         sourceSprite.mTexture = mExplosionFrames[frameIndex];
-        sourceSprite.mTextureRegion.SetRegion(sourceSprite.mTexture->mSize);
+        sourceSprite.mTextureRegion.SetRegion(mExplosionFrameSize);
         return true;
     }
     return false;
@@ -3,6 +3,20 @@
 #include "GameDefs.h"
 #include "Sprite2D.h"
 
+// sprites cache statistics
+struct SpritesCacheStats
+{
+public:
+    int mCacheHits = 0; // since last reset
+    int mCacheMisses = 0;
+    int mCacheEvictions = 0;
+    int mCachedSpritesCount = 0; // current
+    int mCachedSpritesBytes = 0; // standalone textures only, spritesheet pages are permanent
+    int mFreeTexturesCount = 0; // standalone textures only
+    int mFreeTexturesBytes = 0;
+    int mSpritesheetPagesCount = 0; // spritesheet pages allocated for sprites with deltas
+};
+
 // This class implements caching mechanism for graphic resources
 
 // Since engine uses original GTA assets, cache requires styledata to be provided
@@ -22,6 +36,11 @@ public:
     // all default objects bitmaps (with no deltas applied) are stored in single 2d texture
     Spritesheet mObjectsSpritesheet;
 
+    SpritesCacheStats mCacheStats;
+
+    // max distance from game object position to its sprite bounds edge in any rotation, meters
+    float mMaxSpriteDrawExtent = 0.0f;
+
 public:
     // preload sprite textures for current level
     bool InitLevelSprites();
@@ -35,6 +54,7 @@ public:
     void UpdateBlocksAnimations(float deltaTime);
 
     // force drop cached sprites
+    // Sprites of specific object are dropped on next render frame, so it can be called from any thread
     // @param objectID: Specific object identifier
     void FlushSpritesCache();
     void FlushSpritesCache(GameObjectID objectID);
@@ -70,11 +90,31 @@ private:
     void InitBlocksAnimations();
 
     void InitExplosionFrames();
+    void InitMaxSpriteDrawExtent();
     void FreeExplosionFrames();
 
-    // find texture with required size and format or create new if nothing found
-    GpuTexture2D* GetFreeSpriteTexture(const Point& dimensions, eTextureFormat format);
+    // area of texture allocated for sprite with deltas, it's either part of objects spritesheet
+    // or standalone texture if spritesheet is out of space
+    struct SpriteTextureSlot
+    {
+    public:
+        GpuTexture2D* mTexture = nullptr;
+        Point mPosition; // offset within texture
+        Point mSize;
+    };
+
+    // find free texture slot of required size or allocate new one
+    bool AllocSpriteTextureSlot(const Point& spriteSize, SpriteTextureSlot& textureSlot);
+    void FreeSpriteTextureSlot(const SpriteTextureSlot& textureSlot);
+    bool UploadSpriteTextureSlot(const SpriteTextureSlot& textureSlot, int spriteIndex, SpriteDeltaBits deltaBits);
     void DestroySpriteTextures();
+    void FlushObjectSprites(GameObjectID objectID);
+    void FlushPendingObjectsSprites();
+
+    // evict least recently used sprites until cache fits into memory budget
+    void EnforceSpritesCacheBudget();
+    // get memory that cached sprite takes beyond permanent spritesheet
+    int GetSpriteTextureSlotBytes(const SpriteTextureSlot& textureSlot) const;
 
 private:
     // animation state for blocks sharing specific texture
@@ -88,25 +128,63 @@ private:
     std::vector<unsigned short> mBlocksIndices;
     bool mIndicesTableChanged;
 
-    // usused sprite textures
-    std::vector<GpuTexture2D*> mFreeSpriteTextures;
+    // unused sprite texture slots, grouped by size
+    std::unordered_map<unsigned int, std::vector<SpriteTextureSlot>> mFreeSpriteSlots;
 
     // explosion sprite is huge and it was originally split into four pieces, 
     // so it must be assembled in one piece again before use
     std::vector<GpuTexture2D*> mExplosionFrames;
+    Point mExplosionFrameSize;
     int mExplosionPaletteIndex = 0;
 
-    // cached sprite textures with deltas
-    struct SpriteCacheElement
+    // cached sprite identifier, each remap and deltas combination of object sprite is separate entry
+    struct SpriteCacheKey
     {
+    public:
+        inline bool operator == (const SpriteCacheKey& rhs) const
+        {
+            return mObjectID == rhs.mObjectID && mSpriteIndex == rhs.mSpriteIndex &&
+                mRemap == rhs.mRemap && mDeltaBits == rhs.mDeltaBits;
+        }
     public:
         GameObjectID mObjectID; // object identifier which this sprite belongs to
         int mSpriteIndex;
-        SpriteDeltaBits mSpriteDeltaBits; // all deltas applied to this sprite
-        GpuTexture2D* mTexture;
+        int mRemap;
+        SpriteDeltaBits mDeltaBits; // all deltas applied to this sprite
+    };
+
+    struct SpriteCacheKeyHash
+    {
+        inline size_t operator () (const SpriteCacheKey& key) const
+        {
+            size_t hashValue = key.mObjectID;
+            hashValue = hashValue * 31 + key.mSpriteIndex;
+            hashValue = hashValue * 31 + key.mRemap;
+            hashValue = hashValue * 31 + key.mDeltaBits;
+            return hashValue;
+        }
+    };
+
+    // cached sprite textures with deltas
+    struct SpriteCacheElement
+    {
+    public:
+        SpriteCacheKey mCacheKey;
+        SpriteTextureSlot mTextureSlot;
         TextureRegion mTextureRegion;
+        unsigned int mLastUsedFrame; // render frame index
     };
-    std::vector<SpriteCacheElement> mSpritesCache;
+    using SpritesCacheIterator = std::list<SpriteCacheElement>::iterator;
+
+    // most recently used sprites go first
+    std::list<SpriteCacheElement> mSpritesCache;
+    std::unordered_map<SpriteCacheKey, SpritesCacheIterator, SpriteCacheKeyHash> mSpritesCacheLookup;
+    std::unordered_multimap<GameObjectID, SpritesCacheIterator> mObjectSpritesLookup; // all cached sprites of object
+
+    // objects which sprites must be dropped on next render frame
+    std::mutex mFlushObjectsMutex;
+    std::vector<GameObjectID> mFlushObjectsList;
+    unsigned int mRenderFrameIndex = 0;
 };
 
 extern SpriteManager gSpriteManager;
\ No newline at end of file
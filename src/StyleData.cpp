@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "StyleData.h"
+#include "PaletteBlit.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -117,16 +118,15 @@ bool StyleData::LoadFromFile(const std::string& stylesName)
 {
     Cleanup();
 
-    std::ifstream file;
-    if (!gFiles.OpenBinaryFile(stylesName, file))
+    // file data is parsed directly from memory mapping
+    MappedFile mappedFile;
+    if (!gFiles.OpenMappedFile(stylesName, mappedFile))
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot open style file '%s'", stylesName.c_str());
         return false;
     }
 
-    file.seekg(0, std::ios::end);
-    std::streampos fileSize = file.tellg();
-    file.seekg(0, std::ios::beg);
+    cxx::memory_reader file(mappedFile.mData, mappedFile.mDataLength);
 
     // read header
     GTAFileHeaderG24 header;
@@ -161,9 +161,9 @@ bool StyleData::LoadFromFile(const std::string& stylesName)
     }
 
     // read the sprite numbers first
-    std::streampos currentPos = file.tellg();
+    const size_t currentPos = file.tell();
 
-    std::streamoff spriteNumbersDataOffset = clutsDataLength + 
+    long long spriteNumbersDataOffset = clutsDataLength + 
         header.anim_size + 
         header.palette_index_size + 
         header.object_info_size + 
@@ -171,15 +171,13 @@ bool StyleData::LoadFromFile(const std::string& stylesName)
         header.sprite_info_size + 
         header.sprite_graphics_size;
 
-    file.seekg(spriteNumbersDataOffset, std::ios::cur);
-
-    if (!ReadSpriteNumbers(file, header.sprite_numbers_size))
+    if (!file.skip(spriteNumbersDataOffset) || !ReadSpriteNumbers(file, header.sprite_numbers_size))
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot read sprite numbers from style file '%s'", stylesName.c_str());
         return false;
     }
 
-    file.seekg(currentPos);
+    file.seek(currentPos);
 
     if (!ReadAnimations(file, header.anim_size))
     {
@@ -223,7 +221,12 @@ bool StyleData::LoadFromFile(const std::string& stylesName)
         return false;
     }
 
-    file.close();
+    mappedFile.Close();
+
+    if (!DecodeSpriteDeltas())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Some sprite deltas cannot be decoded in style file '%s'", stylesName.c_str());
+    }
 
     if (!InitGameObjects())
     {
@@ -275,6 +278,7 @@ void StyleData::Cleanup()
     mObjects.clear();
     mSprites.clear();
     mSpriteGraphicsRaw.clear();
+    mSpriteDeltaSpans.clear();
     mLidBlocksCount = 0;
     mSideBlocksCount = 0;
     mAuxBlocksCount = 0;
@@ -387,32 +391,33 @@ bool StyleData::GetBlockTexture(eBlockType blockType, int blockIndex, PixelsArra
 
     int palindex = GetBlockTexturePaletteIndex(blockType, blockIndex, remap);
 
-    for (int iy = 0; iy < MAP_BLOCK_TEXTURE_DIMS; ++iy)
+    unsigned char* destPixels = bitmap->mData + ((destPositionY * bitmap->mSizex) + destPositionX) * bpp;
+    PaletteBlitRect(bpp, destPixels, bitmap->mSizex * bpp, srcPixels, 4 * MAP_BLOCK_TEXTURE_DIMS, 
+        MAP_BLOCK_TEXTURE_DIMS, MAP_BLOCK_TEXTURE_DIMS, mPalettes[palindex]);
+    return true;
+}
+
+void StyleData::GetBlockTextureLayers(std::vector<unsigned char>& layersData) const
+{
+    const int totalTextures = GetBlockTexturesCount();
+    layersData.resize(totalTextures * MAP_BLOCK_TEXTURE_AREA);
+
+    // see GetBlockTexture for source data representation
+    unsigned char* destPixels = layersData.data();
+    for (int blockLinearIndex = 0; blockLinearIndex < totalTextures; ++blockLinearIndex)
     {
-        for (int ix = 0; ix < MAP_BLOCK_TEXTURE_DIMS; ++ix)
-        {
-            int destOffset = (((destPositionY + iy) * bitmap->mSizex) + (ix + destPositionX)) * bpp;
-            unsigned char palentry = srcPixels[ix];
+        int blockX = blockLinearIndex % 4;
+        int blockY = blockLinearIndex / 4;
 
-            if (bpp == 1) // color index in palette
-            {
-                bitmap->mData[destOffset + 0] = palentry;
-            }
-            else // rgb(a) color
-            {
-                const Color32& color = mPalettes[palindex].mColors[palentry];
-                bitmap->mData[destOffset + 0] = color.mR;
-                bitmap->mData[destOffset + 1] = color.mG;
-                bitmap->mData[destOffset + 2] = color.mB;
-                if (bpp == 4)
-                {
-                    bitmap->mData[destOffset + 3] = (palentry == 0) ? 0x00 : 0xFF;
-                }
-            }
+        int srcOffset = (blockY * MAP_BLOCK_TEXTURE_AREA * 4) + (blockX * MAP_BLOCK_TEXTURE_DIMS);
+        const unsigned char* srcPixels = mBlockTexturesRaw.data() + srcOffset;
+        for (int iy = 0; iy < MAP_BLOCK_TEXTURE_DIMS; ++iy)
+        {
+            memcpy(destPixels, srcPixels, MAP_BLOCK_TEXTURE_DIMS);
+            destPixels += MAP_BLOCK_TEXTURE_DIMS;
+            srcPixels += 4 * MAP_BLOCK_TEXTURE_DIMS;
         }
-        srcPixels += 4 * MAP_BLOCK_TEXTURE_DIMS;
     }
-    return true;
 }
 
 int StyleData::GetBlockTexturesCount(eBlockType blockType) const
@@ -457,104 +462,53 @@ bool StyleData::GetSpriteTexture(int spriteIndex, PixelsArray* bitmap, int destP
     debug_assert(bitmap->mSizex >= destPositionX + sprite.mWidth);
     debug_assert(bitmap->mSizey >= destPositionY + sprite.mHeight);
 
-    for (int iy = 0; iy < sprite.mHeight; ++iy)
-    for (int ix = 0; ix < sprite.mWidth; ++ix)
-    {
-        int destOffset = (((destPositionY + iy) * bitmap->mSizex) + (ix + destPositionX)) * bpp;
-        int srcOffset = ((sprite.mPageOffsetY + iy) * GTA_SPRITE_PAGE_DIMS + (ix + sprite.mPageOffsetX));
-        int palindex = mPaletteIndices[sprite.mClut + mTileClutsCount];
-        int palentry = srcPixels[srcOffset];
-        if (bpp == 1) // color index in palette
-        {
-            bitmap->mData[destOffset + 0] = palentry;
-        }
-        else
-        {
-            const Color32& color = mPalettes[palindex].mColors[palentry];
-            bitmap->mData[destOffset + 0] = color.mR;
-            bitmap->mData[destOffset + 1] = color.mG;
-            bitmap->mData[destOffset + 2] = color.mB;
-            if (bpp == 4)
-            {
-                bitmap->mData[destOffset + 3] = (palentry == 0) ? 0x00 : 0xFF;
-            }
-        }
-    }
+    int palindex = mPaletteIndices[sprite.mClut + mTileClutsCount];
+
+    srcPixels += (sprite.mPageOffsetY * GTA_SPRITE_PAGE_DIMS) + sprite.mPageOffsetX;
+    unsigned char* destPixels = bitmap->mData + ((destPositionY * bitmap->mSizex) + destPositionX) * bpp;
+    PaletteBlitRect(bpp, destPixels, bitmap->mSizex * bpp, srcPixels, GTA_SPRITE_PAGE_DIMS, 
+        sprite.mWidth, sprite.mHeight, mPalettes[palindex]);
     return true;
 }
 
 bool StyleData::GetSpriteTexture(int spriteIndex, SpriteDeltaBits deltas, PixelsArray* bitmap, int destPositionX, int destPositionY)
 {
-    if (!GetSpriteTexture(spriteIndex, bitmap, destPositionY, destPositionY))
+    if (!GetSpriteTexture(spriteIndex, bitmap, destPositionX, destPositionY))
         return false;
 
-    SpriteInfo& sprite = mSprites[spriteIndex];
+    const SpriteInfo& sprite = mSprites[spriteIndex];
     if (deltas > 0 && sprite.mDeltaCount > 0)
     {
+        const Palette256& palette = mPalettes[mPaletteIndices[sprite.mClut + mTileClutsCount]];
         for (int idelta = 0; idelta < MAX_SPRITE_DELTAS && idelta < sprite.mDeltaCount; ++idelta)
         {
             if ((deltas & BIT(idelta)) == 0)
                 continue;
 
-            SpriteInfo::DeltaInfo& delta = sprite.mDeltas[idelta];
-            ApplySpriteDelta(sprite, delta, bitmap, destPositionX, destPositionY);
+            const SpriteInfo::DeltaInfo& delta = sprite.mDeltas[idelta];
+            ApplySpriteDelta(delta, palette, bitmap, destPositionX, destPositionY);
         }
     }
     return true;
 }
 
-void StyleData::ApplySpriteDelta(SpriteInfo& sprite, SpriteInfo::DeltaInfo& spriteDelta, PixelsArray* bitmap, int positionX, int positionY)
+void StyleData::ApplySpriteDelta(const SpriteInfo::DeltaInfo& spriteDelta, const Palette256& palette, PixelsArray* bitmap, int positionX, int positionY) const
 {
-    unsigned char* srcData = mSpriteGraphicsRaw.data() + spriteDelta.mOffset;
     int bpp = NumBytesPerPixel(bitmap->mFormat);
     debug_assert(bpp == 3 || bpp == 4 || bpp == 1);
 
-    const int HeaderSize = 3;
-    unsigned int dstPixelOffset = 0;
+    const int DestPitch = bitmap->mSizex * bpp;
+    unsigned char* destPixels = bitmap->mData + ((positionY * bitmap->mSizex) + positionX) * bpp;
 
-    for (unsigned short curr_pos = 0; curr_pos < spriteDelta.mSize; )
+    // spans are decoded on load, so indexed formats are just a copy per span
+    for (int ispan = 0; ispan < spriteDelta.mSpansCount; ++ispan)
     {
-        debug_assert(curr_pos + HeaderSize < spriteDelta.mSize);
-
-        unsigned short destination_offset = ((unsigned short)srcData[curr_pos + 0] | ((unsigned short) srcData[curr_pos + 1] << 8));
-        unsigned char source_length = (unsigned char) srcData[curr_pos + 2];
-        debug_assert(source_length > 0);
-        curr_pos += HeaderSize;
-        debug_assert(curr_pos + source_length <= spriteDelta.mSize);
-
-        // original offsets are specified with expectation that destination buffer have dimensions GTA_SPRITE_PAGE_DIMS x GTA_SPRITE_PAGE_DIMS
-        // therefore some additional recomputation is required
-        dstPixelOffset += destination_offset;
-        int pagex = dstPixelOffset % GTA_SPRITE_PAGE_DIMS;
-        int pagey = dstPixelOffset / GTA_SPRITE_PAGE_DIMS;
-        debug_assert(pagex < bitmap->mSizex);
-        debug_assert(pagey < bitmap->mSizey);
-        debug_assert(pagex + source_length <= bitmap->mSizex);
-        
-        int palindex = mPaletteIndices[sprite.mClut + mTileClutsCount];
-        for (int ipixel = 0; ipixel < source_length; ++ipixel)
-        {
-            int curr_pixel_offset = (pagey * bitmap->mSizex * bpp) + pagex * bpp;
-            int palentry = srcData[curr_pos + ipixel];
-            if (bpp == 1) // color index in palette
-            {
-                bitmap->mData[curr_pixel_offset + 0] = palentry;
-            }
-            else
-            {
-                const Color32& color = mPalettes[palindex].mColors[palentry];
-                bitmap->mData[curr_pixel_offset + 0] = color.mR;
-                bitmap->mData[curr_pixel_offset + 1] = color.mG;
-                bitmap->mData[curr_pixel_offset + 2] = color.mB;
-                if (bpp == 4)
-                {
-                    bitmap->mData[curr_pixel_offset + 3] = (palentry == 0) ? 0x00 : 0xFF;
-                }
-            }
-            ++pagex;
-        }
-        dstPixelOffset += source_length;
-        curr_pos += source_length;
+        const SpriteDeltaSpan& span = mSpriteDeltaSpans[spriteDelta.mFirstSpan + ispan];
+        debug_assert(positionY + span.mRow < bitmap->mSizey);
+        debug_assert(positionX + span.mX + span.mLength <= bitmap->mSizex);
+
+        PaletteBlitRect(bpp, destPixels + (span.mRow * DestPitch) + (span.mX * bpp), DestPitch, 
+            mSpriteGraphicsRaw.data() + span.mPixelsOffset, span.mLength, span.mLength, 1, palette);
     }
 }
 
@@ -610,7 +564,7 @@ int StyleData::GetVehicleSpriteIndex(eVehicleClass vehicleClass, int spriteId) c
     return GetSpriteIndex(spriteType, spriteId);
 }
 
-bool StyleData::ReadBlockTextures(std::ifstream& file)
+bool StyleData::ReadBlockTextures(cxx::memory_reader& file)
 {
     const int totalBlocks = (mSideBlocksCount + mLidBlocksCount + mAuxBlocksCount);
 
@@ -626,13 +580,14 @@ bool StyleData::ReadBlockTextures(std::ifstream& file)
     const int extraLength = (extraBlocks * MAP_BLOCK_TEXTURE_AREA);
     mBlockTexturesRaw.resize(dataLength + extraLength);
 
-    if (!file.read(reinterpret_cast<char*>(mBlockTexturesRaw.data()), mBlockTexturesRaw.size()))
+    // copied since texture data outlives file mapping
+    if (!file.read(mBlockTexturesRaw.data(), mBlockTexturesRaw.size()))
         return false;
 
     return true;
 }
 
-bool StyleData::ReadCLUTs(std::ifstream& file, int dataLength)
+bool StyleData::ReadCLUTs(cxx::memory_reader& file, int dataLength)
 {
     const int palCount = dataLength / sizeof(Palette256);
     if (palCount == 0)
@@ -648,13 +603,14 @@ bool StyleData::ReadCLUTs(std::ifstream& file, int dataLength)
     // one for each of that page's 64 palettes. Every page has 256 rows, one for each entry for each of that
     // page's 64 palettes.
 
-    char colorBuf[64 * 4];
+    const int RowLength = 64 * 4;
 
     const int pageCount = dataLength / (64 * sizeof(Palette256));
     for (int ipage = 0; ipage < pageCount; ++ipage)
     for (int ientry = 0; ientry < 256; ++ientry)
     {
-        if (!file.read(colorBuf, sizeof(colorBuf)))
+        const unsigned char* colorBuf = file.read_pointer(RowLength);
+        if (colorBuf == nullptr)
             return false;
 
         for (int ipalette = 0; ipalette < 64; ++ipalette)
@@ -670,17 +626,17 @@ bool StyleData::ReadCLUTs(std::ifstream& file, int dataLength)
     return true;
 }
 
-bool StyleData::ReadPaletteIndices(std::ifstream& file, int dataLength)
+bool StyleData::ReadPaletteIndices(cxx::memory_reader& file, int dataLength)
 {
     mPaletteIndices.resize(dataLength / sizeof(unsigned short));
     // read bunch of shorts
-    if (!file.read(reinterpret_cast<char*>(mPaletteIndices.data()), dataLength))
+    if (!file.read(mPaletteIndices.data(), dataLength))
         return false;
 
     return true;
 }
 
-bool StyleData::ReadAnimations(std::ifstream& file, int dataLength)
+bool StyleData::ReadAnimations(cxx::memory_reader& file, int dataLength)
 {
     unsigned char numAnimationBlocks = 0;
     if (!cxx::read_from_stream(file, numAnimationBlocks))
@@ -711,7 +667,7 @@ bool StyleData::ReadAnimations(std::ifstream& file, int dataLength)
     return true;
 }
 
-bool StyleData::ReadObjects(std::ifstream& file, int dataLength)
+bool StyleData::ReadObjects(cxx::memory_reader& file, int dataLength)
 {
     for (int icurrentObject = 0; dataLength > 0; ++icurrentObject)
     {
@@ -736,7 +692,7 @@ bool StyleData::ReadObjects(std::ifstream& file, int dataLength)
             int skipBytes = numInto * sizeof(unsigned short);
             dataLength -= skipBytes;
 
-            if (!file.seekg(skipBytes, std::ios::cur))
+            if (!file.skip(skipBytes))
                 return false;
         }
 
@@ -746,11 +702,11 @@ bool StyleData::ReadObjects(std::ifstream& file, int dataLength)
     return dataLength == 0;
 }
 
-bool StyleData::ReadVehicles(std::ifstream& file, int dataLength)
+bool StyleData::ReadVehicles(cxx::memory_reader& file, int dataLength)
 {
     for (int icurrent = 0; dataLength > 0; ++icurrent)
     {
-        const std::streampos startStreamPos = file.tellg();
+        const size_t startStreamPos = file.tell();
 
         VehicleInfo carInfo;
         carInfo.mRemapsBaseIndex = icurrent * MAX_CAR_REMAPS;
@@ -784,7 +740,7 @@ bool StyleData::ReadVehicles(std::ifstream& file, int dataLength)
         }
 
         // skip 8bit remaps
-        if (!file.seekg(MAX_CAR_REMAPS, std::ios::cur))
+        if (!file.skip(MAX_CAR_REMAPS))
             return false;
 
         unsigned char vtype = 0;
@@ -872,7 +828,7 @@ bool StyleData::ReadVehicles(std::ifstream& file, int dataLength)
         }
         mVehicles.push_back(carInfo);
 
-        const std::streampos endStreamPos = file.tellg();
+        const size_t endStreamPos = file.tell();
 
         const int infoLength = static_cast<int>(endStreamPos - startStreamPos);
         dataLength -= infoLength;
@@ -881,11 +837,11 @@ bool StyleData::ReadVehicles(std::ifstream& file, int dataLength)
     return dataLength == 0;
 }
 
-bool StyleData::ReadSprites(std::ifstream& file, int dataLength)
+bool StyleData::ReadSprites(cxx::memory_reader& file, int dataLength)
 {
     for (; dataLength > 0;)
     {
-        const std::streampos startStreamPos = file.tellg();
+        const size_t startStreamPos = file.tell();
 
         SpriteInfo spriteInfo;
         READ_I8(file, spriteInfo.mWidth);
@@ -908,7 +864,7 @@ bool StyleData::ReadSprites(std::ifstream& file, int dataLength)
         }
         mSprites.push_back(spriteInfo);
 
-        const std::streampos endStreamPos = file.tellg();
+        const size_t endStreamPos = file.tell();
 
         const int infoLength = static_cast<int>(endStreamPos - startStreamPos);
         dataLength -= infoLength;
@@ -917,20 +873,98 @@ bool StyleData::ReadSprites(std::ifstream& file, int dataLength)
     return dataLength == 0;
 }
 
-bool StyleData::ReadSpriteGraphics(std::ifstream& file, int dataLength)
+bool StyleData::ReadSpriteGraphics(cxx::memory_reader& file, int dataLength)
 {
     if (dataLength > 0)
     {
         mSpriteGraphicsRaw.resize(dataLength);
 
-        if (!file.read(reinterpret_cast<char*>(mSpriteGraphicsRaw.data()), dataLength))
+        // copied since sprite data outlives file mapping
+        if (!file.read(mSpriteGraphicsRaw.data(), dataLength))
             return false;
     }
 
     return true;
 }
 
-bool StyleData::ReadSpriteNumbers(std::ifstream& file, int dataLength)
+bool StyleData::DecodeSpriteDeltas()
+{
+    mSpriteDeltaSpans.clear();
+
+    const int HeaderSize = 3;
+    const int GraphicsDataLength = static_cast<int>(mSpriteGraphicsRaw.size());
+
+    int badDeltasCount = 0;
+    for (SpriteInfo& sprite: mSprites)
+    {
+        for (int idelta = 0; idelta < sprite.mDeltaCount; ++idelta)
+        {
+            SpriteInfo::DeltaInfo& spriteDelta = sprite.mDeltas[idelta];
+            spriteDelta.mFirstSpan = static_cast<int>(mSpriteDeltaSpans.size());
+            spriteDelta.mSpansCount = 0;
+
+            bool isValidDelta = (spriteDelta.mOffset >= 0) && (spriteDelta.mSize >= 0) && 
+                (spriteDelta.mOffset + spriteDelta.mSize <= GraphicsDataLength);
+
+            const unsigned char* srcData = mSpriteGraphicsRaw.data() + spriteDelta.mOffset;
+            int dstPixelOffset = 0;
+
+            for (int curr_pos = 0; isValidDelta && curr_pos < spriteDelta.mSize; )
+            {
+                if (curr_pos + HeaderSize > spriteDelta.mSize)
+                {
+                    isValidDelta = false;
+                    break;
+                }
+
+                unsigned short destination_offset = ((unsigned short)srcData[curr_pos + 0] | ((unsigned short) srcData[curr_pos + 1] << 8));
+                unsigned char source_length = srcData[curr_pos + 2];
+                curr_pos += HeaderSize;
+
+                // original offsets are specified with expectation that destination buffer have dimensions GTA_SPRITE_PAGE_DIMS x GTA_SPRITE_PAGE_DIMS
+                // therefore some additional recomputation is required
+                dstPixelOffset += destination_offset;
+                int pagex = dstPixelOffset % GTA_SPRITE_PAGE_DIMS;
+                int pagey = dstPixelOffset / GTA_SPRITE_PAGE_DIMS;
+                if (curr_pos + source_length > spriteDelta.mSize || pagey >= GTA_SPRITE_PAGE_DIMS || pagex + source_length > GTA_SPRITE_PAGE_DIMS)
+                {
+                    isValidDelta = false;
+                    break;
+                }
+
+                if (source_length > 0)
+                {
+                    SpriteDeltaSpan span;
+                    span.mRow = static_cast<unsigned char>(pagey);
+                    span.mX = static_cast<unsigned char>(pagex);
+                    span.mLength = source_length;
+                    span.mPixelsOffset = static_cast<unsigned int>(spriteDelta.mOffset + curr_pos);
+                    mSpriteDeltaSpans.push_back(span);
+                    ++spriteDelta.mSpansCount;
+                }
+                dstPixelOffset += source_length;
+                curr_pos += source_length;
+            }
+
+            // broken delta is ignored
+            if (!isValidDelta)
+            {
+                mSpriteDeltaSpans.resize(spriteDelta.mFirstSpan);
+                spriteDelta.mSpansCount = 0;
+                ++badDeltasCount;
+            }
+        }
+    }
+
+    if (badDeltasCount > 0)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Found %d broken sprite deltas", badDeltasCount);
+        return false;
+    }
+    return true;
+}
+
+bool StyleData::ReadSpriteNumbers(cxx::memory_reader& file, int dataLength)
 {
     if (dataLength > 0)
     {
@@ -6,6 +6,15 @@
 
 class PixelsArray;
 
+// decoded run of sprite delta pixels within single row, coordinates are relative to sprite origin
+struct SpriteDeltaSpan
+{
+    unsigned char mRow;
+    unsigned char mX;
+    unsigned char mLength;
+    unsigned int mPixelsOffset; // offset of color indices in sprite graphics data
+};
+
 // this class holds gta style data which get loaded from G24-files
 class StyleData final
 {
@@ -43,6 +52,10 @@ public:
     // @param destPositionX, destPositionY: Location within destination texture where block will be placed
     bool GetBlockTexture(eBlockType blockType, int blockIndex, PixelsArray* bitmap, int destPositionX, int destPositionY, int remap);
 
+    // Read all block bitmaps as palette indices, each block occupies MAP_BLOCK_TEXTURE_AREA bytes in linear index order
+    // @param layersData: Output pixels
+    void GetBlockTextureLayers(std::vector<unsigned char>& layersData) const;
+
     // Get palette index for block tile
     // @param remap: Remap index, remapping applies to lids only, 0 means no remap, 1-3 means look up tile remap index
     int GetBlockTexturePaletteIndex(eBlockType blockType, int blockIndex, int remap) const;
@@ -113,19 +126,23 @@ public:
 
 private:
     // apply single delta on sprite
-    void ApplySpriteDelta(SpriteInfo& sprite, SpriteInfo::DeltaInfo& spriteDelta, PixelsArray* pixelsArray, int positionX, int positionY);
+    void ApplySpriteDelta(const SpriteInfo::DeltaInfo& spriteDelta, const Palette256& palette, PixelsArray* bitmap, int positionX, int positionY) const;
+
+    // convert run-length encoded deltas of all sprites into spans table, must be called after sprite graphics loaded
+    // @returns false if some deltas are broken, such deltas get ignored
+    bool DecodeSpriteDeltas();
 
     // Reading style data internals
     // @param file: Source stream
-    bool ReadBlockTextures(std::ifstream& file);
-    bool ReadCLUTs(std::ifstream& file, int dataLength);
-    bool ReadPaletteIndices(std::ifstream& file, int dataLength);
-    bool ReadAnimations(std::ifstream& file, int dataLength);
-    bool ReadObjects(std::ifstream& file, int dataLength);
-    bool ReadVehicles(std::ifstream& file, int dataLength);
-    bool ReadSprites(std::ifstream& file, int dataLength);
-    bool ReadSpriteGraphics(std::ifstream& file, int dataLength);
-    bool ReadSpriteNumbers(std::ifstream& file, int dataLength);
+    bool ReadBlockTextures(cxx::memory_reader& file);
+    bool ReadCLUTs(cxx::memory_reader& file, int dataLength);
+    bool ReadPaletteIndices(cxx::memory_reader& file, int dataLength);
+    bool ReadAnimations(cxx::memory_reader& file, int dataLength);
+    bool ReadObjects(cxx::memory_reader& file, int dataLength);
+    bool ReadVehicles(cxx::memory_reader& file, int dataLength);
+    bool ReadSprites(cxx::memory_reader& file, int dataLength);
+    bool ReadSpriteGraphics(cxx::memory_reader& file, int dataLength);
+    bool ReadSpriteNumbers(cxx::memory_reader& file, int dataLength);
 
     void ReadPedestrianAnimations();
     bool ReadWeaponTypes();
@@ -162,6 +179,7 @@ private:
 
     std::vector<unsigned char> mBlockTexturesRaw;
     std::vector<unsigned char> mSpriteGraphicsRaw;
+    std::vector<SpriteDeltaSpan> mSpriteDeltaSpans;
 
     // sprites animations
     SpriteAnimData mPedestrianAnimations[ePedestrianAnim_COUNT];
@@ -9,6 +9,9 @@
 #include "AudioDevice.h"
 #include "AudioManager.h"
 #include "cvars.h"
+#include "GameBenchmark.h"
+#include "FrameProfiler.h"
+#include "JobsManager.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -30,6 +33,16 @@ CvarFloat gCvarPhysicsFramerate("g_physicsFps", 60.0f, "Physical world update fr
 // memory
 CvarBoolean gCvarMemEnableFrameHeapAllocator("mem_enableFrameHeapAllocator", true, "Enable frame heap allocator", CvarFlags_Archive | CvarFlags_Init);
 
+// system
+CvarBoolean gCvarSysHeadless("sys_headless", false, "Run without graphics, audio and gui", CvarFlags_Init);
+CvarInt gCvarSysBenchmarkTicks("sys_benchTicks", 0, "Number of fixed ticks to run in benchmark mode", CvarFlags_Init);
+CvarString gCvarSysBenchmarkOutput("sys_benchOutput", "", "Benchmark results json file", CvarFlags_Init);
+CvarInt gCvarSysBenchmarkSpritesSort("sys_benchSpritesSort", 0, "Number of sprites to sort in sprites sorting benchmark", CvarFlags_Init);
+CvarInt gCvarSysBenchmarkStyleBlit("sys_benchStyleBlit", 0, "Number of passes over style data in style blitting benchmark", CvarFlags_Init);
+
+// debug
+CvarVoid gCvarDbgDumpProfilerTrace("dbg_dumpProfilerTrace", "Dump recent frames profiler data in chrome trace format", CvarFlags_None);
+
 // audio
 CvarBoolean gCvarAudioActive("a_audioActive", true, "Enable audio system", CvarFlags_Archive | CvarFlags_Init);
 
@@ -63,31 +76,49 @@ void System::Initialize(int argc, char *argv[])
     LoadConfiguration();
     ParseStartupParams(argc, argv);
 
+    if (!gCvarSysLogFile.mValue.empty())
+    {
+        gConsole.SetLogFile(gCvarSysLogFile.mValue, gCvarSysLogFileMaxSize.mValue * 1024);
+    }
+
     if (!gMemoryManager.Initialize())
     {
         gConsole.LogMessage(eLogMessage_Error, "Cannot initialize system memory manager");
         Terminate();
     }
 
-    if (!gGraphicsDevice.Initialize())
+    if (!gJobsManager.Initialize())
     {
-        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize graphics device");
+        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize jobs manager");
         Terminate();
     }
 
-    if (!gImGuiManager.Initialize())
+    if (gCvarSysHeadless.mValue)
     {
-        gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize debug ui system");
-        // ignore failure
+        gConsole.LogMessage(eLogMessage_Info, "Running in headless mode");
     }
+    else
+    {
+        if (!gGraphicsDevice.Initialize())
+        {
+            gConsole.LogMessage(eLogMessage_Error, "Cannot initialize graphics device");
+            Terminate();
+        }
 
-    if (!gRenderManager.Initialize())
-    {
-        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize render system");
-        Terminate();
+        if (!gImGuiManager.Initialize())
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize debug ui system");
+            // ignore failure
+        }
+
+        if (!gRenderManager.Initialize())
+        {
+            gConsole.LogMessage(eLogMessage_Error, "Cannot initialize render system");
+            Terminate();
+        }
     }
 
-    if (gCvarAudioActive.mValue)
+    if (gCvarAudioActive.mValue && !gCvarSysHeadless.mValue)
     {
         if (!gAudioDevice.Initialize())
         {
@@ -101,10 +132,10 @@ void System::Initialize(int argc, char *argv[])
     }
     else
     {
-        gConsole.LogMessage(eLogMessage_Info, "Audio is disabled via config");
+        gConsole.LogMessage(eLogMessage_Info, "Audio is disabled");
     }
 
-    if (!gGuiManager.Initialize())
+    if (!gCvarSysHeadless.mValue && !gGuiManager.Initialize())
     {
         gConsole.LogMessage(eLogMessage_Error, "Cannot initialize gui system");
         Terminate();
@@ -136,14 +167,21 @@ void System::Deinit(bool isTermination)
     gTimeManager.Deinit();
     gCarnageGame.Deinit();
     gImGuiManager.Deinit();
-    gGuiManager.Deinit();
+    if (!gCvarSysHeadless.mValue)
+    {
+        gGuiManager.Deinit();
+    }
     if (gAudioDevice.IsInitialized())
     {
         gAudioManager.Deinit();
         gAudioDevice.Deinit();
     }
-    gRenderManager.Deinit();
+    if (!gCvarSysHeadless.mValue)
+    {
+        gRenderManager.Deinit();
+    }
     gGraphicsDevice.Deinit();
+    gJobsManager.Deinit();
     gMemoryManager.Deinit();
     gFiles.Deinit();
     gConsole.Deinit();
@@ -153,10 +191,40 @@ void System::Run(int argc, char *argv[])
 {
     Initialize(argc, argv);
 
-    // main loop
-
 #ifndef __EMSCRIPTEN__
 
+    if (gCvarSysBenchmarkTicks.mValue > 0)
+    {
+        if (!gGameBenchmark.RunBenchmark(gCvarSysBenchmarkTicks.mValue))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Benchmark failed");
+        }
+        Deinit(false);
+        return;
+    }
+
+    if (gCvarSysBenchmarkSpritesSort.mValue > 0)
+    {
+        if (!gGameBenchmark.RunSpritesSortBenchmark(gCvarSysBenchmarkSpritesSort.mValue))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Sprites sort benchmark failed");
+        }
+        Deinit(false);
+        return;
+    }
+
+    if (gCvarSysBenchmarkStyleBlit.mValue > 0)
+    {
+        if (!gGameBenchmark.RunStyleBlitBenchmark(gCvarSysBenchmarkStyleBlit.mValue))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Style blit benchmark failed");
+        }
+        Deinit(false);
+        return;
+    }
+
+    // main loop
+
     while (true)
     {
         bool continueExecution = ExecuteFrame();
@@ -243,6 +311,15 @@ bool System::SaveConfiguration()
 
 double System::GetSystemSeconds() const
 {
+    if (gCvarSysHeadless.mValue)
+    {
+        // glfw is not initialized in headless mode
+        static const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+        std::chrono::duration<double> currentTime = std::chrono::steady_clock::now() - StartTime;
+        return currentTime.count();
+    }
+
     double currentTime = ::glfwGetTime();
     return currentTime;
 }
@@ -252,11 +329,16 @@ bool System::ExecuteFrame()
     if (mQuitRequested)
         return false;
 
+    gConsole.ProcessPendingMessages();
     gInputs.UpdateFrame();
     gTimeManager.UpdateFrame();
+    gFrameProfiler.BeginFrame();
     gMemoryManager.FlushFrameHeapMemory();
-    gImGuiManager.UpdateFrame();
-    gGuiManager.UpdateFrame();
+    if (!gCvarSysHeadless.mValue)
+    {
+        gImGuiManager.UpdateFrame();
+        gGuiManager.UpdateFrame();
+    }
     gCarnageGame.UpdateFrame();
     if (gAudioDevice.IsInitialized())
     {
@@ -284,6 +366,17 @@ bool System::ExecuteFrame()
         };
     }
 
+    // process profiler trace dump command
+    if (gCvarDbgDumpProfilerTrace.IsModified())
+    {
+        gCvarDbgDumpProfilerTrace.ClearModified();
+        std::string savePath = gFiles.mExecutableDirectory + "/profiler_trace.json";
+        if (gFrameProfiler.DumpChromeTrace(savePath))
+        {
+            gConsole.LogMessage(eLogMessage_Info, "Profiler trace path is '%s'", savePath.c_str());
+        }
+    }
+
     // update screen params
     if (gCvarGraphicsFullscreen.IsModified() || gCvarGraphicsVSync.IsModified())
     {
@@ -293,7 +386,12 @@ bool System::ExecuteFrame()
         gGraphicsDevice.EnableVSync(gCvarGraphicsVSync.mValue);
         gCvarGraphicsVSync.ClearModified();
     }
-    gRenderManager.RenderFrame();
+
+    if (!gCvarSysHeadless.mValue)
+    {
+        gRenderManager.RenderFrame();
+    }
+    gFrameProfiler.EndFrame();
     return true;
 }
 
@@ -331,6 +429,46 @@ void System::ParseStartupParams(int argc, char *argv[])
             iarg += 2;
             continue;
         }
+        if (cxx_stricmp(argv[iarg], "-seed") == 0 && (argc > iarg + 1))
+        {
+            gCvarGameRandSeed.SetFromString(argv[iarg + 1], eCvarSetMethod_CommandLine);
+            iarg += 2;
+            continue;
+        }
+        if (cxx_stricmp(argv[iarg], "-headless") == 0)
+        {
+            gCvarSysHeadless.SetFromString("true", eCvarSetMethod_CommandLine);
+            iarg += 1;
+            continue;
+        }
+        if (cxx_stricmp(argv[iarg], "-bench") == 0 && (argc > iarg + 1))
+        {
+            gCvarSysBenchmarkTicks.SetFromString(argv[iarg + 1], eCvarSetMethod_CommandLine);
+            // benchmark always runs headless
+            gCvarSysHeadless.SetFromString("true", eCvarSetMethod_CommandLine);
+            iarg += 2;
+            continue;
+        }
+        if (cxx_stricmp(argv[iarg], "-benchsort") == 0 && (argc > iarg + 1))
+        {
+            gCvarSysBenchmarkSpritesSort.SetFromString(argv[iarg + 1], eCvarSetMethod_CommandLine);
+            gCvarSysHeadless.SetFromString("true", eCvarSetMethod_CommandLine);
+            iarg += 2;
+            continue;
+        }
+        if (cxx_stricmp(argv[iarg], "-benchblit") == 0 && (argc > iarg + 1))
+        {
+            gCvarSysBenchmarkStyleBlit.SetFromString(argv[iarg + 1], eCvarSetMethod_CommandLine);
+            gCvarSysHeadless.SetFromString("true", eCvarSetMethod_CommandLine);
+            iarg += 2;
+            continue;
+        }
+        if (cxx_stricmp(argv[iarg], "-benchout") == 0 && (argc > iarg + 1))
+        {
+            gCvarSysBenchmarkOutput.SetFromString(argv[iarg + 1], eCvarSetMethod_CommandLine);
+            iarg += 2;
+            continue;
+        }
         if (cxx_stricmp(argv[iarg], "-weather") == 0)
         {
             gCvarWeatherActive.SetFromString("true", eCvarSetMethod_CommandLine);
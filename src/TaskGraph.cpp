@@ -0,0 +1,110 @@
+#include "stdafx.h"
+#include "TaskGraph.h"
+#include "JobsManager.h"
+
+void TaskGraph::AddTask(const char* taskName, TaskResourceBits readBits, TaskResourceBits writeBits, const std::function<void()>& taskFunction)
+{
+    debug_assert(taskName);
+    debug_assert(taskFunction);
+
+    int taskIndex = mTasks.size();
+    mTasks.emplace_back();
+
+    TaskNode& taskNode = mTasks.back();
+    taskNode.mName = taskName;
+    taskNode.mReadBits = readBits;
+    taskNode.mWriteBits = writeBits;
+    taskNode.mFunction = taskFunction;
+
+    // link with previously declared conflicting tasks
+    for (int iprevTask = 0; iprevTask < taskIndex; ++iprevTask)
+    {
+        TaskNode& prevTask = mTasks[iprevTask];
+        bool isConflicting = 
+            (prevTask.mWriteBits & (readBits | writeBits)) > 0 || 
+            (writeBits & prevTask.mReadBits) > 0;
+
+        if (isConflicting)
+        {
+            prevTask.mDependents.push_back(taskIndex);
+            ++taskNode.mDependenciesCount;
+        }
+    }
+}
+
+void TaskGraph::Clear()
+{
+    mTasks.clear();
+}
+
+bool TaskGraph::IsEmpty() const
+{
+    return mTasks.empty();
+}
+
+void TaskGraph::Execute(bool forceSerial)
+{
+    int tasksCount = mTasks.size();
+    int runnersCount = std::min(gJobsManager.GetWorkersCount() + 1, tasksCount);
+    if (forceSerial || runnersCount < 2)
+    {
+        for (TaskNode& currTask: mTasks)
+        {
+            currTask.mFunction();
+        }
+        return;
+    }
+
+    std::mutex stateMutex;
+    std::condition_variable stateCondition;
+    std::vector<int> dependenciesCount (tasksCount);
+    std::deque<int> readyTasks;
+    int completedCount = 0;
+
+    for (int itask = 0; itask < tasksCount; ++itask)
+    {
+        dependenciesCount[itask] = mTasks[itask].mDependenciesCount;
+        if (dependenciesCount[itask] == 0)
+        {
+            readyTasks.push_back(itask);
+        }
+    }
+    // each runner picks ready tasks until all tasks are completed
+    gJobsManager.ParallelFor(runnersCount, [&](int runnerIndex)
+    {
+        for (;;)
+        {
+            int taskIndex = -1;
+            {
+                // sleep until some task gets ready or all tasks are completed
+                std::unique_lock<std::mutex> lock(stateMutex);
+                stateCondition.wait(lock, [&]()
+                {
+                    return completedCount == tasksCount || !readyTasks.empty();
+                });
+
+                if (completedCount == tasksCount)
+                    break;
+
+                taskIndex = readyTasks.front();
+                readyTasks.pop_front();
+            }
+
+            TaskNode& currTask = mTasks[taskIndex];
+            currTask.mFunction();
+
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                ++completedCount;
+                for (int dependentIndex: currTask.mDependents)
+                {
+                    if (--dependenciesCount[dependentIndex] == 0)
+                    {
+                        readyTasks.push_back(dependentIndex);
+                    }
+                }
+            }
+            stateCondition.notify_all();
+        }
+    });
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Resources accessed by tasks, each bit is separate resource
+using TaskResourceBits = unsigned int;
+
+// Graph of tasks with declared resource access, tasks that don't conflict are executed concurrently on worker threads
+// Tasks conflict if they access same resource and at least one of them writes it, in this case
+// declaration order defines execution order
+class TaskGraph final: public cxx::noncopyable
+{
+public:
+    // Declare new task, graph is not supposed to be modified while executing
+    // @param taskName: Task name, must be statically allocated
+    // @param readBits: Resources read by task
+    // @param writeBits: Resources modified by task
+    // @param taskFunction: Task routine
+    void AddTask(const char* taskName, TaskResourceBits readBits, TaskResourceBits writeBits, const std::function<void()>& taskFunction);
+
+    // Remove all declared tasks
+    void Clear();
+
+    // Execute all tasks respecting dependencies, blocks until all tasks are completed
+    // @param forceSerial: Run tasks one after another in declaration order on calling thread
+    void Execute(bool forceSerial);
+
+    bool IsEmpty() const;
+
+private:
+    struct TaskNode
+    {
+    public:
+        const char* mName = nullptr;
+        TaskResourceBits mReadBits = 0;
+        TaskResourceBits mWriteBits = 0;
+        std::function<void()> mFunction;
+        std::vector<int> mDependents; // tasks waiting for this task to complete
+        int mDependenciesCount = 0;
+    };
+    std::vector<TaskNode> mTasks;
+};
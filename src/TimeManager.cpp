@@ -3,6 +3,14 @@
 
 TimeManager gTimeManager;
 
+// requested duration of single short sleep, seconds
+const double ShortSleepDuration = 0.001;
+// initial and max estimate of time that os sleeps beyond requested, seconds
+const double DefaultOversleepDuration = 0.001;
+const double MaxOversleepDuration = 0.003;
+// number of frames to collect pacing stats
+const int FramePacingStatsFrames = 120;
+
 //////////////////////////////////////////////////////////////////////////
 
 inline void SetupMultimediaTimers()
@@ -41,6 +49,15 @@ bool TimeManager::Initialize()
     mMaxFrameDelta = 0.0;
     mMinFrameDelta = 0.0;
 
+    mOversleepEstimate = DefaultOversleepDuration;
+    mFramePacingStats = FramePacingStats();
+    mPacingFramesCount = 0;
+    mPacingFrameTimeSum = 0.0;
+    mPacingFrameTimeSqSum = 0.0;
+    mPacingMaxFrameTime = 0.0;
+    mPacingSleepTime = 0.0;
+    mPacingSpinTime = 0.0;
+
     // setup default frame limits
     SetMaxFramerate(120.0f);
     SetMinFramerate(20.0f);
@@ -61,18 +78,19 @@ void TimeManager::UpdateFrame()
 {
     double frameTimestamp = gSystem.GetSystemSeconds();
     double frameDelta = (frameTimestamp - mLastFrameTimestamp);
-    // limit fps 
-    while (frameDelta < mMinFrameDelta)
-    {
-        std::this_thread::sleep_for(std::chrono::seconds(0));
 
-        double subFrameTimestamp = gSystem.GetSystemSeconds();
-        double subFrameDelta = (subFrameTimestamp - frameTimestamp);
+    // estimate decays even if there were no sleeps, so after series of slow sleeps pacer gets back to sleeping
+    mOversleepEstimate *= 0.95;
 
-        frameDelta += subFrameDelta;
-        frameTimestamp = subFrameTimestamp;
+    // limit fps 
+    if (frameDelta < mMinFrameDelta)
+    {
+        frameTimestamp = WaitForFrameDeadline(mLastFrameTimestamp + mMinFrameDelta, frameTimestamp);
+        frameDelta = (frameTimestamp - mLastFrameTimestamp);
     }
 
+    CollectFramePacingStats(frameDelta);
+
     if (frameDelta > mMaxFrameDelta)
     {
         frameDelta = mMaxFrameDelta;
@@ -84,6 +102,21 @@ void TimeManager::UpdateFrame()
         frameDelta = 0.0f;
     }
 
+    AdvanceTimers(frameDelta);
+
+    mLastFrameTimestamp = frameTimestamp;
+}
+
+void TimeManager::UpdateFrameFixed(float frameDelta)
+{
+    debug_assert(frameDelta >= 0.0f);
+    AdvanceTimers(std::max(frameDelta, 0.0f));
+
+    mLastFrameTimestamp = gSystem.GetSystemSeconds();
+}
+
+void TimeManager::AdvanceTimers(double frameDelta)
+{
     // update timers
     mSystemFrameDelta = (float) frameDelta;
     mSystemTime += mSystemFrameDelta;
@@ -93,8 +126,65 @@ void TimeManager::UpdateFrame()
     
     mUiFrameDelta = (float) (mUiTimeScale * frameDelta);
     mUiTime += mUiFrameDelta;
+}
 
-    mLastFrameTimestamp = frameTimestamp;
+double TimeManager::WaitForFrameDeadline(double frameDeadline, double currentTimestamp)
+{
+    // sleep while remaining time is enough for another short sleep
+    double sleepStartTimestamp = currentTimestamp;
+    while ((frameDeadline - currentTimestamp) > (ShortSleepDuration + mOversleepEstimate))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        double timestamp = gSystem.GetSystemSeconds();
+        double oversleepDuration = std::max((timestamp - currentTimestamp) - ShortSleepDuration, 0.0);
+        currentTimestamp = timestamp;
+
+        // grow estimate immediately to avoid oversleeping, shrink slowly,
+        // it is clamped so occasional stall caused by preemption doesn't turn sleeping off
+        mOversleepEstimate = std::max(oversleepDuration, mOversleepEstimate * 0.95 + oversleepDuration * 0.05);
+        mOversleepEstimate = std::min(mOversleepEstimate, MaxOversleepDuration);
+    }
+    mPacingSleepTime += (currentTimestamp - sleepStartTimestamp);
+
+    // spin for the rest, it is usually less than millisecond
+    double spinStartTimestamp = currentTimestamp;
+    while (currentTimestamp < frameDeadline)
+    {
+        std::this_thread::yield();
+        currentTimestamp = gSystem.GetSystemSeconds();
+    }
+    mPacingSpinTime += (currentTimestamp - spinStartTimestamp);
+    return currentTimestamp;
+}
+
+void TimeManager::CollectFramePacingStats(double frameDelta)
+{
+    double frameTime = frameDelta * 1000.0;
+
+    ++mPacingFramesCount;
+    mPacingFrameTimeSum += frameTime;
+    mPacingFrameTimeSqSum += frameTime * frameTime;
+    mPacingMaxFrameTime = std::max(mPacingMaxFrameTime, frameTime);
+
+    if (mPacingFramesCount < FramePacingStatsFrames)
+        return;
+
+    double averageFrameTime = mPacingFrameTimeSum / mPacingFramesCount;
+    double frameTimeVariance = (mPacingFrameTimeSqSum / mPacingFramesCount) - (averageFrameTime * averageFrameTime);
+
+    mFramePacingStats.mAverageFrameTime = (float) averageFrameTime;
+    mFramePacingStats.mFrameTimeJitter = (float) std::sqrt(std::max(frameTimeVariance, 0.0));
+    mFramePacingStats.mMaxFrameTime = (float) mPacingMaxFrameTime;
+    mFramePacingStats.mAverageSleepTime = (float) (mPacingSleepTime * 1000.0 / mPacingFramesCount);
+    mFramePacingStats.mAverageSpinTime = (float) (mPacingSpinTime * 1000.0 / mPacingFramesCount);
+
+    mPacingFramesCount = 0;
+    mPacingFrameTimeSum = 0.0;
+    mPacingFrameTimeSqSum = 0.0;
+    mPacingMaxFrameTime = 0.0;
+    mPacingSleepTime = 0.0;
+    mPacingSpinTime = 0.0;
 }
 
 void TimeManager::SetGameTimeScale(float timeScale)
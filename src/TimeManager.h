@@ -1,5 +1,16 @@
 #pragma once
 
+// frame pacing stats over recent frames, milliseconds
+struct FramePacingStats
+{
+public:
+    float mAverageFrameTime = 0.0f;
+    float mFrameTimeJitter = 0.0f; // standard deviation of frame time
+    float mMaxFrameTime = 0.0f;
+    float mAverageSleepTime = 0.0f; // per frame
+    float mAverageSpinTime = 0.0f; // per frame
+};
+
 class TimeManager: public cxx::noncopyable
 {
 public:
@@ -18,6 +29,8 @@ public:
     float mMinFramerate = 24.0f; // gta1 game speed
     float mMaxFramerate = 120.0f;
 
+    FramePacingStats mFramePacingStats; // updated periodically
+
 public:
     // Setup manager internal resources
     bool Initialize();
@@ -25,6 +38,10 @@ public:
 
     void UpdateFrame();
 
+    // Advance timers by fixed time step, fps limitations are ignored
+    // @param frameDelta: Step duration, seconds
+    void UpdateFrameFixed(float frameDelta);
+
     // Set fps limitations
     void SetMinFramerate(float framesPerSecond);
     void SetMaxFramerate(float framesPerSecond);
@@ -33,10 +50,31 @@ public:
     void SetGameTimeScale(float timeScale);
     void SetUiTimeScale(float timeScale);
 
+private:
+    void AdvanceTimers(double frameDelta);
+
+    // Sleep for the bulk of remaining frame time and spin for the rest
+    // @param frameDeadline: Desired frame timestamp, seconds
+    // @param currentTimestamp: Current timestamp, seconds
+    // @returns Timestamp after waiting
+    double WaitForFrameDeadline(double frameDeadline, double currentTimestamp);
+    void CollectFramePacingStats(double frameDelta);
+
 private:
     double mMaxFrameDelta = 0.0f;
     double mMinFrameDelta = 0.0f;
     double mLastFrameTimestamp = 0.0f;
+
+    // os sleep precision is poor, so time slept beyond requested duration is tracked
+    double mOversleepEstimate = 0.0;
+
+    // frame pacing stats accumulated since last update
+    int mPacingFramesCount = 0;
+    double mPacingFrameTimeSum = 0.0;
+    double mPacingFrameTimeSqSum = 0.0;
+    double mPacingMaxFrameTime = 0.0;
+    double mPacingSleepTime = 0.0;
+    double mPacingSpinTime = 0.0;
 };
 
 extern TimeManager gTimeManager;
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "AiManager.h"
 #include "GameCheatsWindow.h"
 #include "AiCharacterController.h"
+#include "FrameProfiler.h"
+#include "SpriteManager.h"
 
 TrafficManager gTrafficManager;
 
@@ -16,6 +18,8 @@ TrafficManager::TrafficManager()
 
 void TrafficManager::StartupTraffic()
 {   
+    BuildSpawnCandidates();
+
     mLastGenHareKrishnasTime = gTimeManager.mGameTime;
 
     mLastGenPedsTime = 0.0f;
@@ -41,6 +45,8 @@ void TrafficManager::CleanupTraffic()
 
 void TrafficManager::UpdateFrame()
 {
+    PROFILE_SCOPE("Traffic");
+    RebuildInvalidatedSpawnChunks();
     GeneratePeds();
     GenerateCars();
 }
@@ -149,50 +155,17 @@ void TrafficManager::GenerateTrafficPeds(int pedsCount, RenderView& view)
         outerRect.h += expandSize * 2;
     }
     
-    mCandidatePosArray.clear();
-
-    for (int iy = 0; iy < outerRect.h; ++iy)
-    for (int ix = 0; ix < outerRect.w; ++ix)
-    {
-        Point pos (ix + outerRect.x, iy + outerRect.y);
-        if (innerRect.PointWithin(pos))
-            continue;
-
-        // scan candidate from top
-        for (int iz = (MAP_LAYERS_COUNT - 1); iz > 0; --iz)
-        {
-            const MapBlockInfo* mapBlock = gGameMap.GetBlockInfo(pos.x, pos.y, iz);
-
-            if (mapBlock->mGroundType == eGroundType_Air)
-                continue;
-
-            if (mapBlock->mGroundType == eGroundType_Pawement)
-            {
-                if (mapBlock->mIsRailway)
-                    continue;
-
-                CandidatePos candidatePos;
-                candidatePos.mMapX = pos.x;
-                candidatePos.mMapY = pos.y;
-                candidatePos.mMapLayer = iz;
-                mCandidatePosArray.push_back(candidatePos);
-            }
-            break;
-        }
-    }
-
-    if (mCandidatePosArray.empty())
-        return;
-
-    // shuffle candidates
-    random.shuffle(mCandidatePosArray);
+    CollectSpawnCandidates(innerRect, outerRect, false);
 
     for (; (numPedsGenerated < pedsCount) && !mCandidatePosArray.empty(); ++numPedsGenerated)
     {
         if (!random.random_chance(gGameParams.mTrafficGenPedsChance))
             continue;
 
-        CandidatePos candidate = mCandidatePosArray.back();
+        // pick random candidate
+        int candidateIndex = random.generate_int((int) mCandidatePosArray.size() - 1);
+        CandidatePos candidate = mCandidatePosArray[candidateIndex];
+        mCandidatePosArray[candidateIndex] = mCandidatePosArray.back();
         mCandidatePosArray.pop_back();
 
         if ((mLastGenHareKrishnasTime + gGameParams.mTrafficGenHareKrishnasTime) < gTimeManager.mGameTime)
@@ -209,7 +182,7 @@ void TrafficManager::GenerateTrafficPeds(int pedsCount, RenderView& view)
     }
 }
 
-int TrafficManager::GetPedsToGenerateCount(RenderView& view) const
+int TrafficManager::GetPedsToGenerateCount(RenderView& view)
 {
     int pedestriansCounter = 0;
 
@@ -221,8 +194,19 @@ int TrafficManager::GetPedsToGenerateCount(RenderView& view) const
     onScreenArea.mMin.x -= offscreenDistance;
     onScreenArea.mMin.y -= offscreenDistance;
 
-    for (Pedestrian* pedestrian: gGameObjectsManager.mPedestriansList)
+    // sprite bounds may exceed object position a bit
+    const float drawExtent = gSpriteManager.mMaxSpriteDrawExtent;
+
+    cxx::aabbox2d_t queryArea = onScreenArea;
+    queryArea.mMin -= glm::vec2(drawExtent);
+    queryArea.mMax += glm::vec2(drawExtent);
+
+    mQueryObjectsList.clear();
+    gGameObjectsManager.QueryObjectsInRect(queryArea, GameObjectClassMask_Pedestrian, mQueryObjectsList);
+
+    for (GameObject* currObject: mQueryObjectsList)
     {
+        Pedestrian* pedestrian = static_cast<Pedestrian*>(currObject);
         if (!pedestrian->IsTrafficFlag() || pedestrian->IsMarkedForDeletion() || pedestrian->IsCarPassenger())
             continue;
 
@@ -261,7 +245,7 @@ int TrafficManager::CountTrafficCars() const
     return counter;
 }
 
-int TrafficManager::GetCarsToGenerateCount(RenderView& view) const
+int TrafficManager::GetCarsToGenerateCount(RenderView& view)
 {
     int carsCounter = 0;
 
@@ -273,8 +257,19 @@ int TrafficManager::GetCarsToGenerateCount(RenderView& view) const
     onScreenArea.mMin.x -= offscreenDistance;
     onScreenArea.mMin.y -= offscreenDistance;
 
-    for (Vehicle* car: gGameObjectsManager.mVehiclesList)
+    // sprite bounds may exceed object position a bit
+    const float drawExtent = gSpriteManager.mMaxSpriteDrawExtent;
+
+    cxx::aabbox2d_t queryArea = onScreenArea;
+    queryArea.mMin -= glm::vec2(drawExtent);
+    queryArea.mMax += glm::vec2(drawExtent);
+
+    mQueryObjectsList.clear();
+    gGameObjectsManager.QueryObjectsInRect(queryArea, GameObjectClassMask_Car, mQueryObjectsList);
+
+    for (GameObject* currObject: mQueryObjectsList)
     {
+        Vehicle* car = static_cast<Vehicle*>(currObject);
         if (!car->IsTrafficFlag() || car->IsMarkedForDeletion())
             continue;
 
@@ -347,58 +342,20 @@ void TrafficManager::GenerateTrafficCars(int carsCount, RenderView& view)
         outerRect.h += expandSize * 2;
     }
     
-    mCandidatePosArray.clear();
-
-    for (int iy = 0; iy < outerRect.h; ++iy)
-    for (int ix = 0; ix < outerRect.w; ++ix)
-    {
-        Point pos (ix + outerRect.x, iy + outerRect.y);
-        if (innerRect.PointWithin(pos))
-            continue;
-
-        // scan candidate from top
-        for (int iz = (MAP_LAYERS_COUNT - 1); iz > 0; --iz)
-        {
-            const MapBlockInfo* mapBlock = gGameMap.GetBlockInfo(pos.x, pos.y, iz);
-
-            if (mapBlock->mGroundType == eGroundType_Air)
-                continue;
-
-            if (mapBlock->mGroundType == eGroundType_Road)
-            {
-                int bits = (int) (mapBlock->mDownDirection) + 
-                    (int) (mapBlock->mUpDirection) +
-                    (int) (mapBlock->mLeftDirection) + 
-                    (int) (mapBlock->mRightDirection);
-
-                if ((bits == 0 || bits > 1) || mapBlock->mIsRailway)
-                    continue;
-
-                CandidatePos candidatePos;
-                candidatePos.mMapX = pos.x;
-                candidatePos.mMapY = pos.y;
-                candidatePos.mMapLayer = iz;
-                mCandidatePosArray.push_back(candidatePos);
-            }
-            break;
-        }
-    }
-
-    if (mCandidatePosArray.empty())
-        return;
-
-    // shuffle candidates
-    random.shuffle(mCandidatePosArray);
+    CollectSpawnCandidates(innerRect, outerRect, true);
 
     for (; (numCarsGenerated < carsCount) && !mCandidatePosArray.empty(); ++numCarsGenerated)
     {
         if (!random.random_chance(gGameParams.mTrafficGenCarsChance))
             continue;
 
-        CandidatePos candidate = mCandidatePosArray.back();
+        // pick random candidate
+        int candidateIndex = random.generate_int((int) mCandidatePosArray.size() - 1);
+        CandidatePos candidate = mCandidatePosArray[candidateIndex];
+        mCandidatePosArray[candidateIndex] = mCandidatePosArray.back();
         mCandidatePosArray.pop_back();
 
-        GenerateRandomTrafficCar(candidate.mMapX, candidate.mMapLayer, candidate.mMapY);
+        GenerateRandomTrafficCar(candidate.mMapX, candidate.mMapLayer, candidate.mMapY, candidate.mTurnAngle);
     }
 }
 
@@ -437,30 +394,14 @@ void TrafficManager::RemoveOffscreenCars()
     }
 }
 
-Vehicle* TrafficManager::GenerateRandomTrafficCar(int posx, int posy, int posz)
+Vehicle* TrafficManager::GenerateRandomTrafficCar(int posx, int posy, int posz, float turnAngle)
 {
-    const MapBlockInfo* mapBlock = gGameMap.GetBlockInfo(posx, posz, posy);
-  
     glm::vec3 positions(
         Convert::MapUnitsToMeters(posx + 0.5f),
         Convert::MapUnitsToMeters(posy * 1.0f),
         Convert::MapUnitsToMeters(posz + 0.5f)
     );
 
-    float turnAngle = 0.0f;
-    if (mapBlock->mUpDirection)
-    {
-        turnAngle = -90.0f;
-    }
-    else if (mapBlock->mDownDirection)
-    {
-        turnAngle = 90.0f;
-    }
-    else if (mapBlock->mLeftDirection)
-    {
-        turnAngle = 180.0f;
-    }
-
     // generate car
     cxx::angle_t carHeading(turnAngle, cxx::angle_t::units::degrees);
     positions.y = gGameMap.GetHeightAtPosition(positions);
@@ -635,4 +576,148 @@ bool TrafficManager::TryRemoveTrafficPed(Pedestrian* pedestrian)
         
     pedestrian->MarkForDeletion();
     return true;
+}
+
+void TrafficManager::BuildSpawnCandidates()
+{
+    for (int ichunk = 0; ichunk < SpawnChunksCount; ++ichunk)
+    {
+        BuildSpawnChunk(ichunk);
+    }
+    mHasInvalidatedSpawnChunks = false;
+}
+
+void TrafficManager::InvalidateSpawnCandidates(const Rect& mapArea)
+{
+    // find all chunks touched by area
+    int chunkMinx = glm::clamp(mapArea.x, 0, MAP_DIMENSIONS - 1) / SpawnChunkDims;
+    int chunkMiny = glm::clamp(mapArea.y, 0, MAP_DIMENSIONS - 1) / SpawnChunkDims;
+    int chunkMaxx = glm::clamp(mapArea.x + mapArea.w - 1, 0, MAP_DIMENSIONS - 1) / SpawnChunkDims;
+    int chunkMaxy = glm::clamp(mapArea.y + mapArea.h - 1, 0, MAP_DIMENSIONS - 1) / SpawnChunkDims;
+
+    for (int chunky = chunkMiny; chunky <= chunkMaxy; ++chunky)
+    {
+        for (int chunkx = chunkMinx; chunkx <= chunkMaxx; ++chunkx)
+        {
+            mSpawnChunks[chunky * SpawnChunksPerSide + chunkx].mIsInvalidated = true;
+            mHasInvalidatedSpawnChunks = true;
+        }
+    }
+}
+
+void TrafficManager::RebuildInvalidatedSpawnChunks()
+{
+    if (!mHasInvalidatedSpawnChunks)
+        return;
+
+    mHasInvalidatedSpawnChunks = false;
+
+    for (int ichunk = 0; ichunk < SpawnChunksCount; ++ichunk)
+    {
+        if (mSpawnChunks[ichunk].mIsInvalidated)
+        {
+            BuildSpawnChunk(ichunk);
+        }
+    }
+}
+
+void TrafficManager::BuildSpawnChunk(int chunkIndex)
+{
+    SpawnChunk& spawnChunk = mSpawnChunks[chunkIndex];
+    spawnChunk.mPedsCandidates.clear();
+    spawnChunk.mCarsCandidates.clear();
+    spawnChunk.mIsInvalidated = false;
+
+    int chunkMinx = (chunkIndex % SpawnChunksPerSide) * SpawnChunkDims;
+    int chunkMiny = (chunkIndex / SpawnChunksPerSide) * SpawnChunkDims;
+    int chunkMaxx = std::min(chunkMinx + SpawnChunkDims, (int) MAP_DIMENSIONS);
+    int chunkMaxy = std::min(chunkMiny + SpawnChunkDims, (int) MAP_DIMENSIONS);
+
+    for (int tiley = chunkMiny; tiley < chunkMaxy; ++tiley)
+    for (int tilex = chunkMinx; tilex < chunkMaxx; ++tilex)
+    {
+        CandidatePos candidatePos;
+        candidatePos.mMapX = tilex;
+        candidatePos.mMapY = tiley;
+        candidatePos.mTurnAngle = 0.0f;
+
+        // scan pedestrian candidate from top
+        const MapBlockBits* column = gGameMap.GetBlockColumn(tilex, tiley);
+        for (int iz = (MAP_LAYERS_COUNT - 1); iz > 0; --iz)
+        {
+            const MapBlockBits mapBlock = column[iz];
+
+            if (mapBlock.GetGroundType() == eGroundType_Air)
+                continue;
+
+            if (mapBlock.GetGroundType() == eGroundType_Pawement)
+            {
+                if (mapBlock.IsRailway())
+                    continue;
+
+                candidatePos.mMapLayer = iz;
+                spawnChunk.mPedsCandidates.push_back(candidatePos);
+            }
+            break;
+        }
+
+        // scan car candidate from top
+        for (int iz = (MAP_LAYERS_COUNT - 1); iz > 0; --iz)
+        {
+            const MapBlockBits mapBlock = column[iz];
+
+            if (mapBlock.GetGroundType() == eGroundType_Air)
+                continue;
+
+            if (mapBlock.GetGroundType() == eGroundType_Road)
+            {
+                int bits = mapBlock.GetDirectionsCount();
+                if ((bits == 0 || bits > 1) || mapBlock.IsRailway())
+                    continue;
+
+                candidatePos.mMapLayer = iz;
+                candidatePos.mTurnAngle = 0.0f;
+                if (mapBlock.HasUpDirection())
+                {
+                    candidatePos.mTurnAngle = -90.0f;
+                }
+                else if (mapBlock.HasDownDirection())
+                {
+                    candidatePos.mTurnAngle = 90.0f;
+                }
+                else if (mapBlock.HasLeftDirection())
+                {
+                    candidatePos.mTurnAngle = 180.0f;
+                }
+                spawnChunk.mCarsCandidates.push_back(candidatePos);
+            }
+            break;
+        }
+    }
+}
+
+void TrafficManager::CollectSpawnCandidates(const Rect& innerRect, const Rect& outerRect, bool carsCandidates)
+{
+    mCandidatePosArray.clear();
+
+    // visit only chunks touched by outer rect
+    int chunkMinx = std::max(outerRect.x, 0) / SpawnChunkDims;
+    int chunkMiny = std::max(outerRect.y, 0) / SpawnChunkDims;
+    int chunkMaxx = std::min(outerRect.x + outerRect.w - 1, MAP_DIMENSIONS - 1) / SpawnChunkDims;
+    int chunkMaxy = std::min(outerRect.y + outerRect.h - 1, MAP_DIMENSIONS - 1) / SpawnChunkDims;
+
+    for (int chunky = chunkMiny; chunky <= chunkMaxy; ++chunky)
+    for (int chunkx = chunkMinx; chunkx <= chunkMaxx; ++chunkx)
+    {
+        const SpawnChunk& spawnChunk = mSpawnChunks[chunky * SpawnChunksPerSide + chunkx];
+        const std::vector<CandidatePos>& candidates = carsCandidates ? spawnChunk.mCarsCandidates : spawnChunk.mPedsCandidates;
+        for (const CandidatePos& currCandidate: candidates)
+        {
+            Point pos (currCandidate.mMapX, currCandidate.mMapY);
+            if (!outerRect.PointWithin(pos) || innerRect.PointWithin(pos))
+                continue;
+
+            mCandidatePosArray.push_back(currCandidate);
+        }
+    }
 }
\ No newline at end of file
@@ -18,6 +18,10 @@ public:
     void UpdateFrame();
     void DebugDraw(DebugRenderer& debugRender);
 
+    // Mark spawn candidates within map area outdated, they will be rebuilt on next update
+    // @param mapArea: Changed map area
+    void InvalidateSpawnCandidates(const Rect& mapArea);
+
     int CountTrafficPedestrians() const;
     int CountTrafficCars() const;
 
@@ -26,19 +30,25 @@ private:
     void GeneratePeds();
     void GenerateTrafficPeds(int pedsCount, RenderView& view);
     void RemoveOffscreenPeds();
-    int GetPedsToGenerateCount(RenderView& view) const;
+    int GetPedsToGenerateCount(RenderView& view);
 
     // traffic cars generation
     void GenerateCars();
     void GenerateTrafficCars(int carsCount, RenderView& view);
     void RemoveOffscreenCars();
-    int GetCarsToGenerateCount(RenderView& view) const;
+    int GetCarsToGenerateCount(RenderView& view);
 
     // traffic objects generation
     Pedestrian* GenerateRandomTrafficCarDriver(Vehicle* vehicle);
     Pedestrian* GenerateRandomTrafficPedestrian(int posx, int posy, int posz);
     Pedestrian* GenerateHareKrishnas(int posx, int posy, int posz);
-    Vehicle* GenerateRandomTrafficCar(int posx, int posy, int posz);
+    Vehicle* GenerateRandomTrafficCar(int posx, int posy, int posz, float turnAngle);
+
+    // spawn candidates index
+    void BuildSpawnCandidates();
+    void BuildSpawnChunk(int chunkIndex);
+    void RebuildInvalidatedSpawnChunks();
+    void CollectSpawnCandidates(const Rect& innerRect, const Rect& outerRect, bool carsCandidates);
 
     // attempt to remove traffic pedestrian or vehicle
     bool TryRemoveTrafficPed(Pedestrian* ped);
@@ -55,8 +65,26 @@ private:
         int mMapX;
         int mMapY;
         int mMapLayer;
+        float mTurnAngle; // cars only, degrees
     };
     std::vector<CandidatePos> mCandidatePosArray;
+    std::vector<GameObject*> mQueryObjectsList; // temporary list of objects found in area
+
+    // valid spawn cells of current map grouped by map area
+    enum
+    {
+        SpawnChunkDims = 16,
+        SpawnChunksPerSide = (MAP_DIMENSIONS + SpawnChunkDims - 1) / SpawnChunkDims,
+        SpawnChunksCount = SpawnChunksPerSide * SpawnChunksPerSide,
+    };
+    struct SpawnChunk
+    {
+        std::vector<CandidatePos> mPedsCandidates;
+        std::vector<CandidatePos> mCarsCandidates;
+        bool mIsInvalidated = false;
+    };
+    SpawnChunk mSpawnChunks[SpawnChunksCount];
+    bool mHasInvalidatedSpawnChunks = false;
 };
 
 extern TrafficManager gTrafficManager;
\ No newline at end of file
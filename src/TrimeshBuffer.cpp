@@ -2,50 +2,104 @@
 #include "TrimeshBuffer.h"
 #include "GpuBuffer.h"
 
-TrimeshBuffer::~TrimeshBuffer()
-{
-    debug_assert(mIndexBuffer == nullptr);
-    debug_assert(mVertexBuffer == nullptr);
-}
+// initial size of streaming buffer, it should fit at least several uploads per frame
+const unsigned int MinStreamingBufferLength = 256 * 1024;
 
-void TrimeshBuffer::SetVertices(unsigned int dataLength, const void* dataSource)
+// append data to ring buffer without synchronization, orphan buffer storage on wrap
+static bool StreamBufferData(eBufferContent bufferContent, GpuBuffer*& gpuBuffer, unsigned int& bufferCursor, 
+    unsigned int dataLength, const void* dataSource, unsigned int& dataOffset)
 {
-    if (mVertexBuffer == nullptr)
+    debug_assert(dataLength > 0 && dataSource);
+
+    // keep offsets aligned, it is required for attributes and indices
+    dataOffset = (bufferCursor + 15U) & (~15U);
+
+    if (gpuBuffer == nullptr)
     {
-        mVertexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices, eBufferUsage_Stream, dataLength, dataSource);
-        debug_assert(mVertexBuffer);
-        return;
+        unsigned int bufferLength = std::max(MinStreamingBufferLength, cxx::get_next_pot(dataLength) * 2);
+        gpuBuffer = gGraphicsDevice.CreateBuffer(bufferContent, eBufferUsage_Stream, bufferLength, nullptr);
+        if (gpuBuffer == nullptr)
+        {
+            debug_assert(false);
+            return false;
+        }
+        dataOffset = 0;
+    }
+    else if (dataOffset + dataLength > gpuBuffer->mBufferLength)
+    {
+        // gpu might still read previous data, so allocate new storage instead of waiting
+        if (dataLength > gpuBuffer->mBufferLength)
+        {
+            unsigned int bufferLength = cxx::get_next_pot(dataLength) * 2;
+            if (!gpuBuffer->Setup(eBufferUsage_Stream, bufferLength, nullptr))
+            {
+                debug_assert(false);
+                return false;
+            }
+        }
+        else
+        {
+            gpuBuffer->Invalidate();
+        }
+        dataOffset = 0;
     }
 
-    if (!mVertexBuffer->Setup(eBufferUsage_Stream, dataLength, dataSource))
+    // region is not used by any pending draw calls
+    void* pMappedData = gpuBuffer->Lock(dataOffset, dataLength, BufferAccess_UnsynchronizedWrite | BufferAccess_InvalidateRange);
+    if (pMappedData == nullptr)
+    {
+        debug_assert(false);
+        return false;
+    }
+    ::memcpy(pMappedData, dataSource, dataLength);
+    if (!gpuBuffer->Unlock())
     {
         debug_assert(false);
     }
+    bufferCursor = dataOffset + dataLength;
+    return true;
 }
 
-void TrimeshBuffer::SetIndices(unsigned int dataLength, const void* dataSource)
+TrimeshBuffer::~TrimeshBuffer()
 {
-    if (mIndexBuffer == nullptr)
+    debug_assert(mIndexBuffer == nullptr);
+    debug_assert(mVertexBuffer == nullptr);
+}
+
+void TrimeshBuffer::SetVertices(unsigned int dataLength, const void* dataSource)
+{
+    if (!StreamBufferData(eBufferContent_Vertices, mVertexBuffer, mVerticesCursor, dataLength, dataSource, mVerticesOffset))
     {
-        mIndexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Indices, eBufferUsage_Stream, dataLength, dataSource);
-        debug_assert(mIndexBuffer);
-        return;
+        mVerticesCursor = 0;
+        mVerticesOffset = 0;
     }
+}
 
-    if (!mIndexBuffer->Setup(eBufferUsage_Stream, dataLength, dataSource))
+void TrimeshBuffer::SetIndices(unsigned int dataLength, const void* dataSource)
+{
+    if (!StreamBufferData(eBufferContent_Indices, mIndexBuffer, mIndicesCursor, dataLength, dataSource, mIndicesOffset))
     {
-        debug_assert(false);
+        mIndicesCursor = 0;
+        mIndicesOffset = 0;
     }
 }
 
 void TrimeshBuffer::Bind(const VertexFormat& vertexFormat)
+{
+    Bind(vertexFormat, mIndexBuffer);
+}
+
+void TrimeshBuffer::Bind(const VertexFormat& vertexFormat, GpuBuffer* indexBuffer)
 {
     debug_assert(mVertexBuffer);
     if (mVertexBuffer == nullptr)
         return;
 
-    gGraphicsDevice.BindVertexBuffer(mVertexBuffer, vertexFormat);
-    gGraphicsDevice.BindIndexBuffer(mIndexBuffer);
+    VertexFormat streamFormat = vertexFormat;
+    streamFormat.mBaseOffset += mVerticesOffset;
+
+    gGraphicsDevice.BindVertexBuffer(mVertexBuffer, streamFormat);
+    gGraphicsDevice.BindIndexBuffer(indexBuffer);
 }
 
 void TrimeshBuffer::Deinit()
@@ -60,4 +114,8 @@ void TrimeshBuffer::Deinit()
         gGraphicsDevice.DestroyBuffer(mVertexBuffer);
         mVertexBuffer = nullptr;
     }
-}
\ No newline at end of file
+    mVerticesCursor = 0;
+    mIndicesCursor = 0;
+    mVerticesOffset = 0;
+    mIndicesOffset = 0;
+}
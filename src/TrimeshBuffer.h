@@ -1,17 +1,37 @@
 #pragma once
 
+// Streaming vertices and indices buffers
+// Each upload gets appended to the end of ring buffer so previously submitted draw calls are not stalled,
+// buffer storage gets orphaned once it wraps around
 class TrimeshBuffer final: public cxx::noncopyable
 {
 public:
     TrimeshBuffer() = default;
     ~TrimeshBuffer();
 
+    // Append data to streaming buffer, data location is stored in mVerticesOffset/mIndicesOffset
+    // @param dataLength: Size of data in bytes
+    // @param dataSource: Source data
     void SetVertices(unsigned int dataLength, const void* dataSource);
     void SetIndices(unsigned int dataLength, const void* dataSource);
+
+    // Bind recently uploaded vertices, vertex format base offset gets adjusted to its location
+    // Note that indices offset must be added manually on draw
+    // @param vertexFormat: Vertex attributes definition
+    // @param indexBuffer: External indices buffer, optional
     void Bind(const VertexFormat& vertexFormat);
+    void Bind(const VertexFormat& vertexFormat, GpuBuffer* indexBuffer);
     void Deinit();
 
 public:
     GpuBuffer* mVertexBuffer = nullptr;
     GpuBuffer* mIndexBuffer = nullptr;
-};
\ No newline at end of file
+
+    // location of recently uploaded data within buffers, bytes
+    unsigned int mVerticesOffset = 0;
+    unsigned int mIndicesOffset = 0;
+
+private:
+    unsigned int mVerticesCursor = 0;
+    unsigned int mIndicesCursor = 0;
+};
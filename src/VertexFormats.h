@@ -113,4 +113,48 @@ public:
         this->SetAttribute(eVertexAttribute_Color0, eVertexAttributeFormat_1US, offsetof(TVertexType, mClutIndex));
         this->SetAttribute(eVertexAttribute_TextureSize, eVertexAttributeFormat_2US, offsetof(TVertexType, mTextureSize));
     }
+};
+
+// defines per instance data of sprite, quad corners are generated in vertex shader
+struct SpriteInstance
+{
+public:
+    SpriteInstance() = default;
+
+public:
+    glm::vec4 mPositionRotation; // position x, y, height and rotation angle in radians, 16 bytes
+    glm::vec2 mSize; // sprite size, 8 bytes
+    unsigned short mTexcoords[4]; // normalized texture region u0, v0, u1, v1, 8 bytes
+    unsigned short mClutIndex; // 2 bytes
+    unsigned short mCenterOrigin; // whether sprite origin is center, 2 bytes
+};
+
+const unsigned int Sizeof_SpriteInstance = sizeof(SpriteInstance);
+
+// defines instance data format of sprite
+struct SpriteInstance_Format: public VertexFormat
+{
+public:
+    SpriteInstance_Format()
+    {
+        Setup();
+    }
+    // get format definition
+    static const SpriteInstance_Format& Get() 
+    { 
+        static const SpriteInstance_Format sDefinition;
+        return sDefinition;
+    }
+    using TVertexType = SpriteInstance;
+    // initialzie definition
+    inline void Setup()
+    {
+        this->mDataStride = Sizeof_SpriteInstance;
+        this->mInstanced = true;
+        this->SetAttribute(eVertexAttribute_Position0, eVertexAttributeFormat_4F, offsetof(TVertexType, mPositionRotation));
+        this->SetAttribute(eVertexAttribute_Position1, eVertexAttributeFormat_2F, offsetof(TVertexType, mSize));
+        this->SetAttribute(eVertexAttribute_Texcoord0, eVertexAttributeFormat_4US, offsetof(TVertexType, mTexcoords));
+        this->SetAttributeNormalized(eVertexAttribute_Texcoord0);
+        this->SetAttribute(eVertexAttribute_Color0, eVertexAttributeFormat_2US, offsetof(TVertexType, mClutIndex));
+    }
 };
\ No newline at end of file
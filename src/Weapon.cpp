@@ -86,7 +86,13 @@ bool Weapon::Fire(Pedestrian* shooter)
 
         if (weaponInfo->mShotSound != -1)
         {
-            shooter->StartGameObjectSound(ePedSfxChannelIndex_Weapon, eSfxSampleType_Level, weaponInfo->mShotSound, SfxFlags_RandomPitch);
+            // own shots should never be dropped in crowded firefight
+            SfxFlags sfxFlags = SfxFlags_RandomPitch;
+            if (shooter->IsHumanPlayerCharacter())
+            {
+                sfxFlags = sfxFlags | SfxFlags_HighPriority;
+            }
+            shooter->StartGameObjectSound(ePedSfxChannelIndex_Weapon, eSfxSampleType_Level, weaponInfo->mShotSound, sfxFlags);
         }
 
         // broardcast event
@@ -3,6 +3,7 @@
 #include "ParticleEffectsManager.h"
 #include "CarnageGame.h"
 #include "cvars.h"
+#include "FrameProfiler.h"
 
 WeatherManager gWeatherManager;
 
@@ -28,6 +29,7 @@ void WeatherManager::ClearWorld()
 
 void WeatherManager::UpdateFrame()
 {
+    PROFILE_SCOPE("Weather");
     if (!IsWeatherEffectsEnabled())
         return;
 
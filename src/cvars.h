@@ -16,6 +16,8 @@ extern CvarPoint gCvarGraphicsScreenDims; // screen dimensions
 extern CvarBoolean gCvarGraphicsFullscreen; // is fullscreen mode enabled
 extern CvarBoolean gCvarGraphicsVSync; // is vertical synchronization enabled
 extern CvarBoolean gCvarGraphicsTexFiltering; // is texture filtering enabled
+extern CvarInt gCvarGraphicsSpritesCacheBudget; // cached sprites memory budget in kilobytes
+extern CvarBoolean gCvarGraphicsInstancedSprites; // is sprites instanced rendering enabled
 
 // physics
 extern CvarFloat gCvarPhysicsFramerate; // physical world update framerate
@@ -23,11 +25,23 @@ extern CvarFloat gCvarPhysicsFramerate; // physical world update framerate
 // memory
 extern CvarBoolean gCvarMemEnableFrameHeapAllocator; // enable frame heap allocator
 
+// system
+extern CvarBoolean gCvarSysHeadless; // run without graphics, audio and gui
+extern CvarInt gCvarSysBenchmarkTicks; // number of fixed ticks to run in benchmark mode
+extern CvarString gCvarSysBenchmarkOutput; // benchmark results json file
+extern CvarInt gCvarSysBenchmarkSpritesSort; // number of sprites to sort in sprites sorting benchmark
+extern CvarInt gCvarSysBenchmarkStyleBlit; // number of passes over style data in style blitting benchmark
+extern CvarInt gCvarSysWorkerThreads; // number of worker threads
+extern CvarString gCvarSysLogFile; // log file path
+extern CvarInt gCvarSysLogFileMaxSize; // log file size in kilobytes after which it gets rotated
+extern CvarInt gCvarSysLogRateLimit; // max log messages per second from worker threads for each category
+
 // audio
 extern CvarBoolean gCvarAudioActive; // enable audio system
 extern CvarEnum<eGameMusicMode> gCvarGameMusicMode; // ingame music mode
 extern CvarInt gCvarMusicVolume; // ingame music volume in range [0-7]
 extern CvarInt gCvarSoundsVolume; // ingame effects volume in range [0-7]
+extern CvarInt gCvarAudioSfxMemoryBudget; // loaded sound samples memory budget in kilobytes
 
 // game
 extern CvarString gCvarGtaDataPath; // config gta data location
@@ -36,9 +50,13 @@ extern CvarString gCvarCurrentBaseDir; // current gta data location
 extern CvarEnum<eGtaGameVersion> gCvarGameVersion; // current gta game version
 extern CvarString gCvarGameLanguage; // current game language
 extern CvarInt gCvarNumPlayers; // number of players in split screen mode
+extern CvarInt gCvarGameRandSeed; // game randomizer seed, 0 to seed from system clock
 extern CvarBoolean gCvarWeatherActive; // whether weather effects enabled
 extern CvarEnum<eWeatherEffect> gCvarWeatherEffect; // currently active weather
 extern CvarBoolean gCvarCarSparksActive; // enable car sparks effect
+extern CvarBoolean gCvarGameSerialUpdate; // update gameplay subsystems serially on main thread
+extern CvarBoolean gCvarGameAsyncLevelLoading; // load level data on background thread
+extern CvarBoolean gCvarGameLevelCache; // cache decoded level data on disk
 
 //////////////////////////////////////////////////////////////////////////
 // console commands
@@ -52,6 +70,7 @@ extern CvarVoid gCvarDbgDumpSpriteDeltas; // dump sprite deltas
 extern CvarVoid gCvarDbgDumpBlockTextures; // dump block textures
 extern CvarVoid gCvarDbgDumpSprites; // dump all sprites
 extern CvarVoid gCvarDbgDumpCarSprites; // dump car sprites
+extern CvarVoid gCvarDbgDumpProfilerTrace; // dump recent frames profiler data in chrome trace format
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -62,8 +81,19 @@ inline void CvarsRegisterGlobal()
     gConsole.RegisterVariable(&gCvarGraphicsFullscreen);
     gConsole.RegisterVariable(&gCvarGraphicsVSync);
     gConsole.RegisterVariable(&gCvarGraphicsTexFiltering);
+    gConsole.RegisterVariable(&gCvarGraphicsSpritesCacheBudget);
+    gConsole.RegisterVariable(&gCvarGraphicsInstancedSprites);
     gConsole.RegisterVariable(&gCvarPhysicsFramerate);
     gConsole.RegisterVariable(&gCvarMemEnableFrameHeapAllocator);
+    gConsole.RegisterVariable(&gCvarSysHeadless);
+    gConsole.RegisterVariable(&gCvarSysBenchmarkTicks);
+    gConsole.RegisterVariable(&gCvarSysBenchmarkOutput);
+    gConsole.RegisterVariable(&gCvarSysBenchmarkSpritesSort);
+    gConsole.RegisterVariable(&gCvarSysBenchmarkStyleBlit);
+    gConsole.RegisterVariable(&gCvarSysWorkerThreads);
+    gConsole.RegisterVariable(&gCvarSysLogFile);
+    gConsole.RegisterVariable(&gCvarSysLogFileMaxSize);
+    gConsole.RegisterVariable(&gCvarSysLogRateLimit);
     gConsole.RegisterVariable(&gCvarAudioActive);
     gConsole.RegisterVariable(&gCvarGtaDataPath);
     gConsole.RegisterVariable(&gCvarMapname);
@@ -71,13 +101,18 @@ inline void CvarsRegisterGlobal()
     gConsole.RegisterVariable(&gCvarGameVersion);
     gConsole.RegisterVariable(&gCvarGameLanguage);
     gConsole.RegisterVariable(&gCvarNumPlayers);
+    gConsole.RegisterVariable(&gCvarGameRandSeed);
     gConsole.RegisterVariable(&gCvarWeatherActive);
     gConsole.RegisterVariable(&gCvarWeatherEffect);
     gConsole.RegisterVariable(&gCvarGameMusicMode);
     gConsole.RegisterVariable(&gCvarCarSparksActive);
+    gConsole.RegisterVariable(&gCvarGameSerialUpdate);
+    gConsole.RegisterVariable(&gCvarGameAsyncLevelLoading);
+    gConsole.RegisterVariable(&gCvarGameLevelCache);
     gConsole.RegisterVariable(&gCvarMouseAiming);
     gConsole.RegisterVariable(&gCvarMusicVolume);
     gConsole.RegisterVariable(&gCvarSoundsVolume);
+    gConsole.RegisterVariable(&gCvarAudioSfxMemoryBudget);
     // commands
     gConsole.RegisterVariable(&gCvarSysQuit);
     gConsole.RegisterVariable(&gCvarSysListCvars);
@@ -85,4 +120,5 @@ inline void CvarsRegisterGlobal()
     gConsole.RegisterVariable(&gCvarDbgDumpBlockTextures);
     gConsole.RegisterVariable(&gCvarDbgDumpSprites);
     gConsole.RegisterVariable(&gCvarDbgDumpCarSprites);
+    gConsole.RegisterVariable(&gCvarDbgDumpProfilerTrace);
 }
\ No newline at end of file
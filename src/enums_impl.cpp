@@ -5,6 +5,7 @@
 #include "GameObject.h"
 #include "PedestrianInfo.h"
 #include "PhysicsDefs.h"
+#include "LevelLoader.h"
 
 impl_enum_strings(eGtaGameVersion)
 {
@@ -258,6 +259,8 @@ impl_enum_strings(eRenderUniform)
     {eRenderUniform_NormalMatrix, "normal_matrix"},
     {eRenderUniform_CameraPosition, "camera_position"},
     {eRenderUniform_EnableBiLinearFiltering, "enable_bilinear_filtering"},
+    {eRenderUniform_SpritesDepthAxis, "sprites_depth_axis"},
+    {eRenderUniform_ViewportSize, "viewport_size"},
 };
 
 impl_enum_strings(eBlendMode)
@@ -646,4 +649,15 @@ impl_enum_strings(eGameMusicMode)
     {eGameMusicMode_Disabled, "disabled"},
     {eGameMusicMode_Radio, "radio"},
     {eGameMusicMode_Constant, "constant"},
+};
+
+impl_enum_strings(eLevelLoadingStage)
+{
+    {eLevelLoadingStage_Idle, "Idle"},
+    {eLevelLoadingStage_MapData, "Loading map data"},
+    {eLevelLoadingStage_LevelSounds, "Loading sounds"},
+    {eLevelLoadingStage_MapMesh, "Building city mesh"},
+    {eLevelLoadingStage_GpuResources, "Creating textures"},
+    {eLevelLoadingStage_Done, "Done"},
+    {eLevelLoadingStage_Failed, "Failed"},
 };
\ No newline at end of file
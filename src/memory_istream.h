@@ -45,6 +45,80 @@ namespace cxx
         char* mEnd;
     };
 
+    // forward reader over memory block, data is accessed in place so it is suitable for memory mapped files
+    class memory_reader
+    {
+    public:
+        memory_reader(const void* memory_begin, size_t memory_length)
+            : mBegin(static_cast<const unsigned char*>(memory_begin))
+            , mCursor(static_cast<const unsigned char*>(memory_begin))
+            , mEnd(static_cast<const unsigned char*>(memory_begin) + memory_length)
+        {
+        }
+
+        // copy bytes at current position and advance
+        // @returns false if there is not enough data
+        bool read(void* destination, size_t length)
+        {
+            const unsigned char* source = read_pointer(length);
+            if (source == nullptr)
+                return false;
+
+            if (length > 0)
+            {
+                ::memcpy(destination, source, length);
+            }
+            return true;
+        }
+
+        // get data at current position without copying and advance
+        // @returns nullptr if there is not enough data
+        const unsigned char* read_pointer(size_t length)
+        {
+            if (length > get_remaining_length())
+                return nullptr;
+
+            const unsigned char* source = mCursor;
+            mCursor += length;
+            return source;
+        }
+
+        // move cursor relative to current position or to absolute position
+        // @returns false if position is out of range, cursor stays unchanged
+        bool skip(long long offset)
+        {
+            long long position = static_cast<long long>(tell()) + offset;
+            if (position < 0)
+                return false;
+
+            return seek(static_cast<size_t>(position));
+        }
+
+        bool seek(size_t position)
+        {
+            if (position > get_length())
+                return false;
+
+            mCursor = mBegin + position;
+            return true;
+        }
+
+        size_t tell() const { return static_cast<size_t>(mCursor - mBegin); }
+        size_t get_length() const { return static_cast<size_t>(mEnd - mBegin); }
+        size_t get_remaining_length() const { return static_cast<size_t>(mEnd - mCursor); }
+
+    private:
+        const unsigned char* mBegin;
+        const unsigned char* mCursor;
+        const unsigned char* mEnd;
+    };
+
+    template<typename TValue>
+    inline bool read_from_stream(memory_reader& reader, TValue& outputValue)
+    {
+        return reader.read(&outputValue, sizeof(outputValue));
+    }
+
     // stream helpers
     template<typename TElement>
     inline bool read_elements(std::istream& instream, TElement* elements, int elements_count)